@@ -40,6 +40,8 @@
 
 // Buffers in BMP draw function (to screen) require 5 bytes/pixel: 3 bytes
 // for each BMP pixel (R+G+B), 2 bytes for each TFT pixel (565 color).
+// On non-AVR devices there are two TFT buffers (7 bytes/pixel total), so
+// one can be converted into while the other goes out via DMA.
 // Buffers in BMP load (to canvas) require 3 bytes/pixel (R+G+B from BMP),
 // no interim 16-bit buffer as data goes straight to the canvas buffer.
 // Because buffers are flushed at the end of each scanline (to allow for
@@ -50,10 +52,187 @@
 
 #ifdef __AVR__
 #define BUFPIXELS 24 ///<  24 * 5 =  120 bytes
+#define DESTBUFS 1   ///< No DMA on AVR, one TFT working buffer is enough
 #else
-#define BUFPIXELS 200 ///< 200 * 5 = 1000 bytes
+#define BUFPIXELS 200 ///< 200 * 7 = 1400 bytes
+#define DESTBUFS 2    ///< Alternating TFT working buffers for DMA overlap
 #endif
 
+// Raw RGB565 image files (see drawRGB565()) start with an 8-byte header:
+// "R565", then width and height as 16-bit little-endian values. Pixels
+// follow as top-to-bottom rows of big-endian 565 color, with no padding.
+#define RGB565_HEADER 8 ///< Header size, and file position of first pixel
+
+// LZ4-compressed RGB565 image files (see drawLZ565()) have a 12-byte
+// header: "L565", width, height, rows per block and maximum match offset
+// (bytes), all 16-bit little-endian. Next is a table of 32-bit LE file
+// positions, one per block, so any block can be found without reading
+// those before it. Each block is then a 32-bit LE byte count followed by
+// one LZ4 block (no frame) of raw RGB565 data, as above, for its rows.
+// Matches don't reach outside the block.
+#define LZ565_HEADER 12 ///< Header size, and file position of block table
+
+// Where SPITFT hands pixel data to DMA or a bulk SPI transfer, it must
+// otherwise byte-swap 565 colors (an extra pass over every pixel) unless
+// they're passed as big-endian, so the BMP reader produces them that way.
+// Elsewhere SPITFT writes 16 bits at a time and prefers native order.
+#if defined(USE_SPI_DMA) || defined(ESP32) || defined(ARDUINO_ARCH_RP2040)
+#define TFT_BIGENDIAN true ///< Send pre-swapped 565 data to TFT
+#else
+#define TFT_BIGENDIAN false ///< Send native-order 565 data to TFT
+#endif
+
+/*!
+    @brief   Convert a run of BMP 16-bit (little-endian) pixels to 565 color.
+             Data that's 565 already is copied as-is (or just byte-swapped).
+    @param   src        Pointer to first BMP pixel (no alignment needed).
+    @param   dest       Pointer to 16-bit output buffer.
+    @param   n          Number of pixels.
+    @param   is555      If true, source is X1R5G5B5, else R5G6B5.
+    @param   bigEndian  If true, output is byte-swapped (big-endian 565,
+                        as sent over SPI).
+    @return  None (void).
+*/
+static void rgb16To565(const uint8_t *src, uint16_t *dest, uint32_t n,
+                       bool is555, bool bigEndian) {
+  uint16_t c;
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) &&                         \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  if (!is555 && !bigEndian) { // Exact match, no conversion at all
+    memcpy(dest, src, n * 2);
+    return;
+  }
+  uint32_t w; // Two pixels per word
+  for (; n >= 2; n -= 2) {
+    memcpy(&w, src, 4);
+    src += 4;
+    if (is555) // Shift R & G up a bit, replicate G's MSB into new LSB
+      w = ((w << 1) & 0xFFC0FFC0) | ((w >> 4) & 0x00200020) |
+          (w & 0x001F001F);
+    if (bigEndian)
+      w = ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF);
+    memcpy(dest, &w, 4);
+    dest += 2;
+  }
+#endif
+  for (; n; n--) { // Remainder (or all, if not handled above)
+    c = src[0] | (src[1] << 8);
+    if (is555)
+      c = ((c << 1) & 0xFFC0) | ((c >> 4) & 0x0020) | (c & 0x001F);
+    *dest++ = bigEndian ? ((c >> 8) | (c << 8)) : c;
+    src += 2;
+  }
+}
+
+/*!
+    @brief   Convert a run of BMP 32-bit (B,G,R,A byte order) pixels to
+             16-bit 565 color, applying an alpha policy. Each policy has its
+             own loop, so ignoring alpha costs no more than 24-bit data.
+    @param   src        Pointer to first BMP pixel (no alignment needed).
+    @param   dest       Pointer to 16-bit output buffer.
+    @param   n          Number of pixels.
+    @param   mode       IMAGE_ALPHA_IGNORE to use color as-is,
+                        IMAGE_ALPHA_MASK for background color where alpha
+                        is below threshold, IMAGE_ALPHA_BLEND to blend with
+                        background color by alpha.
+    @param   threshold  Minimum alpha for opaque, IMAGE_ALPHA_MASK only.
+    @param   background 565 color for transparent pixels.
+    @param   bigEndian  If true, output is byte-swapped (big-endian 565,
+                        as sent over SPI).
+    @return  None (void).
+*/
+static void bgra8888To565(const uint8_t *src, uint16_t *dest, uint32_t n,
+                          uint8_t mode, uint8_t threshold, uint16_t background,
+                          bool bigEndian) {
+  uint16_t c;
+  if (mode == IMAGE_ALPHA_IGNORE) {
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) &&                         \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint32_t w; // B G R A
+    for (; n; n--, src += 4) {
+      memcpy(&w, src, 4);
+      c = ((w >> 8) & 0xF800) | ((w >> 5) & 0x07E0) | ((w >> 3) & 0x001F);
+      *dest++ = bigEndian ? ((c >> 8) | (c << 8)) : c;
+    }
+#else
+    for (; n; n--, src += 4) {
+      c = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+      *dest++ = bigEndian ? ((c >> 8) | (c << 8)) : c;
+    }
+#endif
+    return;
+  }
+  // Background color expanded to 8 bits per channel for blending
+  uint8_t bgR = ((background >> 8) & 0xF8) | (background >> 13);
+  uint8_t bgG = ((background >> 3) & 0xFC) | ((background >> 9) & 0x03);
+  uint8_t bgB = ((background << 3) & 0xF8) | ((background >> 2) & 0x07);
+  uint8_t opaque = (mode == IMAGE_ALPHA_MASK) ? threshold : 255;
+  uint8_t a, ia;
+  uint16_t r, g, b;
+  for (; n; n--, src += 4) {
+    a = src[3];
+    if (a >= opaque) {
+      c = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+    } else if (!a || (mode == IMAGE_ALPHA_MASK)) {
+      c = background;
+    } else {
+      // Blend, x/255 as (x + 128 + ((x + 128) >> 8)) >> 8 (exact)
+      ia = 255 - a;
+      r = src[2] * a + bgR * ia + 128;
+      g = src[1] * a + bgG * ia + 128;
+      b = src[0] * a + bgB * ia + 128;
+      r = (r + (r >> 8)) >> 8;
+      g = (g + (g >> 8)) >> 8;
+      b = (b + (b >> 8)) >> 8;
+      c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+    *dest++ = bigEndian ? ((c >> 8) | (c << 8)) : c;
+  }
+}
+
+/*!
+    @brief   Convert a run of BMP 24-bit (B,G,R byte order) pixels to 16-bit
+             565 color. On 32-bit little-endian devices, four pixels are
+             loaded as three 32-bit words and converted with shifts and
+             masks alone (no per-pixel byte loads or branches).
+    @param   src        Pointer to first BMP pixel (no alignment needed).
+    @param   dest       Pointer to 16-bit output buffer.
+    @param   n          Number of pixels.
+    @param   bigEndian  If true, output is byte-swapped (big-endian 565,
+                        as sent over SPI).
+    @return  None (void).
+*/
+static void bgr888To565(const uint8_t *src, uint16_t *dest, uint32_t n,
+                        bool bigEndian) {
+  uint16_t c;
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) &&                         \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  uint32_t w[3]; // B0 G0 R0 B1 | G1 R1 B2 G2 | R2 B3 G3 R3
+  uint32_t p[2]; // Output, two pixels per word
+  for (; n >= 4; n -= 4) {
+    memcpy(w, src, 12); // Word loads where unaligned access is allowed
+    src += 12;
+    p[0] = ((w[0] >> 8) & 0xF800) | ((w[0] >> 5) & 0x07E0) |
+           ((w[0] >> 3) & 0x001F) |
+           (((w[1] & 0xF800) | ((w[1] << 3) & 0x07E0) | (w[0] >> 27)) << 16);
+    p[1] = ((w[2] << 8) & 0xF800) | ((w[1] >> 21) & 0x07E0) |
+           ((w[1] >> 19) & 0x001F) | (w[2] & 0xF8000000) |
+           ((w[2] << 3) & 0x07E00000) | ((w[2] << 5) & 0x001F0000);
+    if (bigEndian) { // Swap bytes within each halfword (REV16 on Cortex-M)
+      p[0] = ((p[0] & 0x00FF00FF) << 8) | ((p[0] >> 8) & 0x00FF00FF);
+      p[1] = ((p[1] & 0x00FF00FF) << 8) | ((p[1] >> 8) & 0x00FF00FF);
+    }
+    memcpy(dest, p, 8);
+    dest += 4;
+  }
+#endif
+  for (; n; n--) { // Remainder (or all, if not handled above)
+    c = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+    *dest++ = bigEndian ? ((c >> 8) | (c << 8)) : c;
+    src += 3;
+  }
+}
+
 // ADAFRUIT_IMAGE CLASS ****************************************************
 // This has been created as a class here rather than in Adafruit_GFX because
 // it's a new type returned specifically by the Adafruit_ImageReader class
@@ -65,7 +244,7 @@
     @return  'Empty' Adafruit_Image object.
 */
 Adafruit_Image::Adafruit_Image(void)
-    : mask(NULL), palette(NULL), format(IMAGE_NONE) {
+    : mask(NULL), palette(NULL), format(IMAGE_NONE), width4(0) {
   canvas.canvas1 = NULL;
 }
 
@@ -86,7 +265,7 @@ void Adafruit_Image::dealloc(void) {
       delete canvas.canvas1;
       canvas.canvas1 = NULL;
     }
-  } else if (format == IMAGE_8) {
+  } else if ((format == IMAGE_8) || (format == IMAGE_4)) {
     if (canvas.canvas8) {
       delete canvas.canvas8;
       canvas.canvas8 = NULL;
@@ -102,7 +281,7 @@ void Adafruit_Image::dealloc(void) {
     mask = NULL;
   }
   if (palette) {
-    delete[] palette;
+    free(palette); // Allocated by Adafruit_ImageReader with malloc()
     palette = NULL;
   }
   format = IMAGE_NONE;
@@ -118,6 +297,8 @@ int16_t Adafruit_Image::width(void) const {
       return canvas.canvas1->width();
     else if (format == IMAGE_8)
       return canvas.canvas8->width();
+    else if (format == IMAGE_4)
+      return width4;
     else if (format == IMAGE_16)
       return canvas.canvas16->width();
   }
@@ -132,7 +313,7 @@ int16_t Adafruit_Image::height(void) const {
   if (format != IMAGE_NONE) { // Image allocated?
     if (format == IMAGE_1)
       return canvas.canvas1->height();
-    else if (format == IMAGE_8)
+    else if ((format == IMAGE_8) || (format == IMAGE_4))
       return canvas.canvas8->height();
     else if (format == IMAGE_16)
       return canvas.canvas16->height();
@@ -160,7 +341,7 @@ void *Adafruit_Image::getCanvas(void) const {
   if (format != IMAGE_NONE) { // Image allocated?
     if (format == IMAGE_1)
       return (void *)canvas.canvas1;
-    else if (format == IMAGE_8)
+    else if ((format == IMAGE_8) || (format == IMAGE_4))
       return (void *)canvas.canvas8;
     else if (format == IMAGE_16)
       return (void *)canvas.canvas16;
@@ -192,10 +373,44 @@ void Adafruit_Image::draw(Adafruit_SPITFT &tft, int16_t x, int16_t y) {
     }
     tft.drawBitmap(x, y, canvas.canvas1->getBuffer(), canvas.canvas1->width(),
                    canvas.canvas1->height(), foreground, background);
-  } else if (format == IMAGE_8) {
+  } else if ((format == IMAGE_8) || (format == IMAGE_4)) {
+    // GFX has no palettized bitmap function; expand each clipped row
+    // through the palette, a buffer at a time, and write to the TFT.
+    uint16_t buf[BUFPIXELS];
+    uint8_t *src = canvas.canvas8->getBuffer();
+    int16_t stride = canvas.canvas8->width(); // Bytes per row
+    int16_t w = width(), h = height();
+    int16_t x1 = max(x, (int16_t)0), y1 = max(y, (int16_t)0);
+    int16_t x2 = min((int16_t)(x + w), tft.width());
+    int16_t y2 = min((int16_t)(y + h), tft.height());
+    if (!palette || (x1 >= x2) || (y1 >= y2))
+      return;
+    tft.startWrite();
+    tft.setAddrWindow(x1, y1, x2 - x1, y2 - y1);
+    for (int16_t row = y1; row < y2; row++) {
+      uint8_t *s = &src[(row - y) * stride];
+      for (int16_t col = x1; col < x2;) {
+        int16_t n = min((int16_t)BUFPIXELS, (int16_t)(x2 - col));
+        uint16_t c, i = col - x; // Column within image
+        for (int16_t j = 0; j < n; j++, i++) {
+          if (format == IMAGE_8)
+            c = palette[s[i]];
+          else // Left pixel in high nibble
+            c = palette[(s[i >> 1] >> ((i & 1) ? 0 : 4)) & 0x0F];
+          buf[j] = TFT_BIGENDIAN ? ((c >> 8) | (c << 8)) : c;
+        }
+        tft.writePixels(buf, n, true, TFT_BIGENDIAN);
+        col += n;
+      }
+    }
+    tft.endWrite();
   } else if (format == IMAGE_16) {
-    tft.drawRGBBitmap(x, y, canvas.canvas16->getBuffer(),
-                      canvas.canvas16->width(), canvas.canvas16->height());
+    if (mask) // Only pixels with mask bit set are drawn
+      tft.drawRGBBitmap(x, y, canvas.canvas16->getBuffer(), mask->getBuffer(),
+                        canvas.canvas16->width(), canvas.canvas16->height());
+    else
+      tft.drawRGBBitmap(x, y, canvas.canvas16->getBuffer(),
+                        canvas.canvas16->width(), canvas.canvas16->height());
   }
 }
 
@@ -214,14 +429,20 @@ void Adafruit_Image::draw(Adafruit_SPITFT &tft, int16_t x, int16_t y) {
              often be in pre-setup() declaration, but DOES need initializing
              before any of the image loading or size functions are called!
 */
-Adafruit_ImageReader::Adafruit_ImageReader(FatVolume &fs) { filesys = &fs; }
+Adafruit_ImageReader::Adafruit_ImageReader(FatVolume &fs)
+    : filesys(&fs), stats(NULL), scratch(NULL), scratchSize(0),
+      scanMADCTL(-1), scanOffset(0), alphaMode(IMAGE_ALPHA_IGNORE),
+      alphaThreshold(128), alphaColor(0x0000), runFill(0) {}
 
 /*!
     @brief   Constructor with no filesystem. Used for loading images from memory
    rather than SD card or FAT filesystem.
     @return  Adafruit_ImageReader object.
 */
-Adafruit_ImageReader::Adafruit_ImageReader(void) { filesys = NULL; };
+Adafruit_ImageReader::Adafruit_ImageReader(void)
+    : filesys(NULL), stats(NULL), scratch(NULL), scratchSize(0),
+      scanMADCTL(-1), scanOffset(0), alphaMode(IMAGE_ALPHA_IGNORE),
+      alphaThreshold(128), alphaColor(0x0000), runFill(0) {}
 
 /*!
     @brief   Destructor.
@@ -233,6 +454,109 @@ Adafruit_ImageReader::~Adafruit_ImageReader(void) {
   // filesystem is left as-is
 }
 
+/*!
+    @brief   Provide a working buffer for subsequent image-reading calls,
+             replacing the small fixed-size buffers used by default. A
+             larger buffer means fewer, larger file reads (e.g. one read
+             per scanline or per several SD sectors) and fewer display
+             writes. The buffer is caller-owned and must remain valid
+             (and not otherwise used) while images are being read.
+    @param   buf
+             Pointer to buffer, preferably 32-bit aligned, or NULL to
+             revert to the default internal buffers.
+    @param   len
+             Buffer size in bytes. When drawing to a TFT, the buffer is
+             split 3:4 between file data and two 16-bit pixel buffers
+             (3:2 and one pixel buffer on AVR and for EPD), so e.g.
+             320 * 7 bytes holds one 320-pixel 24-bit scanline. File
+             reads of 1536 bytes or more are rounded down to a multiple of
+             1536 (three 512-byte sectors, and a whole number of pixels at
+             any BMP depth). When loading to RAM, all of it is used for
+             file data.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::setBuffer(void *buf, uint32_t len) {
+  scratch = (uint8_t *)buf;
+  scratchSize = buf ? len : 0;
+}
+
+/*!
+    @brief   Let drawBMP() read normal (bottom-to-top) BMP files front to
+             back with no seeks, by temporarily reversing the vertical
+             scan direction of the display through its MADCTL (0x36)
+             register. Supported by ILI9341, ST77xx, HX8357 and similar
+             controllers. Only applies when drawBMP() manages the SPI
+             transaction (transact = true); the register is restored to
+             the given value when each image is done.
+             Reversing the scan mirrors rows across the controller's whole
+             RAM, not just the visible panel; if the panel doesn't sit
+             centered in RAM, 'offset' corrects for that.
+    @param   madctl
+             MADCTL value for the display's current rotation (as set by
+             the display library's setRotation()), or -1 to disable
+             (the default).
+    @param   offset
+             Controller RAM rows along the display's vertical axis, minus
+             the display's height, minus twice the row offset the display
+             library applies at the current rotation. 0 (the default) for
+             panels that fill the RAM or are centered in it (e.g. 128x160
+             ST7735, 1 row each side of 162); a 240x240 ST7789 in 320-row
+             RAM needs 80 at rotation 0 (no row offset) and -80 at
+             rotation 2 (offset 80).
+    @return  None (void).
+*/
+void Adafruit_ImageReader::setReverseScan(int16_t madctl, int16_t offset) {
+  scanMADCTL = madctl;
+  scanOffset = offset;
+}
+
+/*!
+    @brief   Select how the alpha channel of 32-bit BMPs is handled by
+             subsequent drawBMP() and loadBMP() calls (other depths have no
+             alpha and are unaffected).
+    @param   mode
+             IMAGE_ALPHA_IGNORE (default) draws every pixel opaque.
+             IMAGE_ALPHA_MASK thresholds alpha: loadBMP() stores the result
+             in the image's 1-bit mask (pixels are kept at full color, and
+             Adafruit_Image::draw() skips masked-out pixels), while
+             drawBMP(), which can't skip pixels within its address window,
+             draws them in the background color instead.
+             IMAGE_ALPHA_BLEND blends each pixel with the background color.
+    @param   background
+             16-bit 565 color behind transparent pixels.
+    @param   threshold
+             For IMAGE_ALPHA_MASK, minimum alpha value (0-255) at which a
+             pixel is considered opaque.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::setAlpha(ImageAlphaMode mode, uint16_t background,
+                                    uint8_t threshold) {
+  alphaMode = mode;
+  alphaColor = background;
+  alphaThreshold = threshold;
+}
+
+/*!
+    @brief   Enable or disable run-length fills when drawing to a TFT.
+             With this set, each run of identical pixels (after conversion
+             to 565) at least minRun long is sent with writeColor() instead
+             of writePixels(), so the display library's repeated-color fast
+             path can be used. This applies to every TFT draw path that
+             converts pixels: drawBMP() (RLE included), drawJPEG(),
+             drawPNG(), drawQOI(), drawGIF() and drawGIFFrame(). Not to
+             drawRGB565() or drawLZ565(), whose data goes to the display
+             as is. Good for images with large flat areas; a small cost
+             otherwise, as every pixel is compared. Runs are found within
+             each block of converted pixels, so a run may be split at a
+             block boundary.
+    @param   minRun
+             Minimum number of identical pixels to send as a fill, or 0 to
+             disable (default). Very short runs are better left to
+             writePixels(); 16 or so is a reasonable start.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::setRunFill(uint16_t minRun) { runFill = minRun; }
+
 /*!
     @brief   Loads BMP image file from SD card directly to SPITFT screen.
     @param   filename
@@ -256,7 +580,7 @@ Adafruit_ImageReader::~Adafruit_ImageReader(void) {
 ImageReturnCode Adafruit_ImageReader::drawBMP(const char *filename,
                                               Adafruit_SPITFT &tft, int16_t x,
                                               int16_t y, boolean transact) {
-  uint16_t tftbuf[BUFPIXELS]; // Temp space for buffering TFT data
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
   // Call core BMP-reading function, passing address to TFT object,
   // TFT working buffer, and X & Y position of top-left corner (image
   // will be cropped on load if necessary). Image pointer is NULL when
@@ -330,31 +654,68 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
   uint8_t planes;                            // BMP planes
   uint8_t depth;                             // BMP bit depth
   uint32_t compression = 0;                  // BMP compression mode
+  uint32_t rMask, gMask, bMask;              // BI_BITFIELDS color masks
+  boolean is555 = true;                      // 16-bit BMP is X1R5G5B5
   uint32_t colors = 0;                       // Number of colors in palette
   uint16_t *quantized = NULL;                // 16-bit 5/6/5 color palette
   uint32_t rowSize;                          // >bmpWidth if scanline padding
-  uint8_t sdbuf[3 * BUFPIXELS];              // BMP read buf (R+G+B/pixel)
-#if ((3 * BUFPIXELS) <= 255)
-  uint8_t srcidx = sizeof sdbuf; // Current position in sdbuf
-#else
-  uint16_t srcidx = sizeof sdbuf;
-#endif
+  uint8_t localbuf[3 * BUFPIXELS];           // Default BMP read buf
+  uint8_t *sdbuf = localbuf;                 // BMP read buf (R+G+B/pixel)
+  uint32_t sdbufSize = sizeof localbuf;      // Size of sdbuf in bytes
+  uint32_t destSize = BUFPIXELS;             // Size of each dest buf, pixels
+  uint32_t srcidx;                           // Current position in sdbuf
   uint32_t destidx = 0;
-  uint8_t *dest1 = NULL;     // Dest ptr for 1-bit BMPs to img
+  uint8_t *dest1 = NULL;     // Dest ptr for 1- & 8-bit BMPs to img
+  uint8_t *mask1 = NULL;     // Alpha mask ptr for 32-bit BMPs to img
+  uint32_t maskStride = 0;   // Bytes per mask row
+  uint16_t *destAlt = NULL;  // Alternate TFT buffer for non-blocking writes
   boolean flip = true;       // BMP is stored bottom-to-top
+  boolean reverse = false;   // TFT scans bottom-to-top (see setReverseScan())
+  uint8_t madctl = 0;        // MADCTL value with vertical scan reversed
   uint32_t bmpPos = 0;       // Next pixel position in file
+  uint32_t readPos = 0;      // File position of next sdbuf load
+  uint32_t bufPos = 0;       // File position of sdbuf[0]
+  uint32_t bufLen = 0;       // Valid bytes in sdbuf
+  uint32_t skip = 0;         // Initial srcidx following a load
+  uint32_t readLen;          // Bytes in next sdbuf load
+  uint32_t readOfs = 0;      // Index in sdbuf of next load (after kept data)
+  uint32_t keep = 0;         // Bytes kept in sdbuf following next load
+  uint32_t firstSector;      // Start of sector holding first pixel data
+  uint32_t rowBytes;         // Bytes per scanline within clipped area
+  boolean rowMode;           // If set, load whole scanlines to sdbuf
+  int32_t n;                 // Bytes read
+  uint32_t span;             // Pixels converted in one pass
   int loadWidth, loadHeight, // Region being loaded (clipped)
       loadX, loadY;          // "
   int row, col;              // Current pixel pos.
   uint8_t r, g, b;           // Current pixel color
   uint8_t bitIn = 0;         // Bit number for 1-bit data in
   uint8_t bitOut = 0;        // Column mask for 1-bit data out
+  uint32_t startTime = 0;    // Timing for stats (if enabled)
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
 
   // If an Adafruit_Image object is passed and currently contains anything,
   // free its contents as it's about to be overwritten with new stuff.
   if (img)
     img->dealloc();
 
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default sdbuf and (if drawing to TFT) dest buffers.
+  splitBuffer(tft ? DESTBUFS : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+  srcidx = sdbufSize; // Force initial buffer load
+  readLen = sdbufSize;
+
+#if DESTBUFS > 1
+  // drawBMP() provides DESTBUFS working buffers back-to-back; the second
+  // one is filled while the first is written out, and vice versa.
+  if (tft)
+    destAlt = &dest[destSize];
+#endif
+
   // If BMP is being drawn off the right or bottom edge of the screen,
   // nothing to do here. NOT an error, just a trivial clip operation.
   if (tft && ((x >= tft->width()) || (y >= tft->height())))
@@ -381,7 +742,8 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
     bmpHeight = readLE32();
     // If bmpHeight is negative, image is in top-down order.
     // This is not canon but has been observed in the wild.
-    if (bmpHeight < 0) {
+    // (Out-of-range values are left as-is and rejected below.)
+    if ((bmpHeight < 0) && (bmpHeight >= -0x7FFF)) {
       bmpHeight = -bmpHeight;
       flip = false;
     }
@@ -396,45 +758,102 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
       colors = readLE32(); // Number of colors in palette, or 0 for 2^depth
       (void)readLE32();    // Number of colors used (ignore)
       // File position should now be at start of palette (if present)
+      // or of color masks (either following a 40-byte header, or the
+      // first fields of later header versions)
+      if ((compression == 3) && (depth >= 16)) { // BI_BITFIELDS
+        rMask = readLE32();
+        gMask = readLE32();
+        bMask = readLE32();
+        if (depth == 32) {
+          if ((rMask == 0xFF0000) && (gMask == 0xFF00) && (bMask == 0xFF))
+            compression = 0; // BGRA, same as uncompressed 32-bit
+        } else if ((rMask == 0xF800) && (gMask == 0x07E0) &&
+                   (bMask == 0x001F)) {
+          is555 = false;   // RGB565, used as-is
+          compression = 0; // Handle same as uncompressed data
+        } else if ((rMask == 0x7C00) && (gMask == 0x03E0) &&
+                   (bMask == 0x001F)) {
+          compression = 0; // RGB555, same as default 16-bit format
+        } // Else leave compression set, format isn't handled
+      }
     }
-    if (!colors)
+    if ((depth < 16) && (!colors || (colors > (1UL << depth))))
       colors = 1 << depth;
 
-    loadWidth = bmpWidth;
-    loadHeight = bmpHeight;
-    loadX = 0;
-    loadY = 0;
-    if (tft) {
-      // Crop area to be loaded (if destination is TFT)
-      if (x < 0) {
-        loadX = -x;
-        loadWidth += x;
-        x = 0;
-      }
-      if (y < 0) {
-        loadY = -y;
-        loadHeight += y;
-        y = 0;
-      }
-      if ((x + loadWidth) > tft->width())
-        loadWidth = tft->width() - x;
-      if ((y + loadHeight) > tft->height())
-        loadHeight = tft->height() - y;
-    }
+    // Uncompressed, or RLE8/RLE4 (which are always stored bottom-to-top).
+    // GFX canvases and TFT windows are limited to 16-bit dimensions, and
+    // all of the size math below relies on that; anything outside this
+    // range (or empty) is a corrupt header, whatever the depth.
+    if ((planes == 1) && (bmpWidth > 0) && (bmpWidth <= 0x7FFF) &&
+        (bmpHeight > 0) && (bmpHeight <= 0x7FFF) &&
+        ((compression == 0) ||
+         (flip && (((compression == 1) && (depth == 8)) ||
+                   ((compression == 2) && (depth == 4)))))) {
 
-    if ((planes == 1) && (compression == 0)) { // Only uncompressed is handled
+      loadWidth = bmpWidth;
+      loadHeight = bmpHeight;
+      loadX = 0;
+      loadY = 0;
+      if (tft) {
+        // Crop area to be loaded (if destination is TFT)
+        if (x < 0) {
+          loadX = -x;
+          loadWidth += x;
+          x = 0;
+        }
+        if (y < 0) {
+          loadY = -y;
+          loadHeight += y;
+          y = 0;
+        }
+        if ((x + loadWidth) > tft->width())
+          loadWidth = tft->width() - x;
+        if ((y + loadHeight) > tft->height())
+          loadHeight = tft->height() - y;
+        if (flip && transact && (scanMADCTL >= 0) && !compression) {
+          // Have the TFT fill the window bottom-to-top, so the clipped rows
+          // are read in file order. With rows/columns exchanged (MV), the
+          // vertical axis is the column address order (MX), else MY.
+          reverse = true;
+          madctl = scanMADCTL ^ ((scanMADCTL & 0x20) ? 0x40 : 0x80);
+          loadY = bmpHeight - loadY - loadHeight; // First row in file
+          flip = false;
+        }
+      }
 
       // BMP rows are padded (if needed) to 4-byte boundary
-      rowSize = ((depth * bmpWidth + 31) / 32) * 4;
+      rowSize = ((depth * (uint32_t)bmpWidth + 31) / 32) * 4;
 
-      if ((depth == 24) || (depth == 1)) { // BGR or 1-bit bitmap format
+      // BGRA, BGR, 16-bit 565/555, 8- or 4-bit palettized or 1-bit format
+      if ((depth == 32) || (depth == 24) || (depth == 16) || (depth == 8) ||
+          (depth == 4) || (depth == 1)) {
 
         if (img) {
-          // Loading to RAM -- allocate GFX 16-bit canvas type
+          // Loading to RAM -- allocate GFX canvas type matching depth
           status = IMAGE_ERR_MALLOC; // Assume won't fit to start
-          if (depth == 24) {
+          if (depth >= 16) {
             if ((img->canvas.canvas16 = new GFXcanvas16(bmpWidth, bmpHeight))) {
               dest = img->canvas.canvas16->getBuffer();
+              if ((depth == 32) && (alphaMode == IMAGE_ALPHA_MASK)) {
+                // Alpha is thresholded into a 1-bit mask (zeroed by GFX)
+                if ((img->mask = new GFXcanvas1(bmpWidth, bmpHeight)) &&
+                    (mask1 = img->mask->getBuffer())) {
+                  maskStride = (bmpWidth + 7) / 8;
+                } else { // Not enough RAM for mask, discard canvas too
+                  delete img->canvas.canvas16;
+                  img->canvas.canvas16 = NULL;
+                  dest = NULL;
+                }
+              }
+            }
+          } else if (depth == 8) {
+            if ((img->canvas.canvas8 = new GFXcanvas8(bmpWidth, bmpHeight))) {
+              dest1 = img->canvas.canvas8->getBuffer();
+            }
+          } else if (depth == 4) { // Stays packed, 2 pixels per byte
+            if ((img->canvas.canvas8 =
+                     new GFXcanvas8((bmpWidth + 1) / 2, bmpHeight))) {
+              dest1 = img->canvas.canvas8->getBuffer();
             }
           } else {
             if ((img->canvas.canvas1 = new GFXcanvas1(bmpWidth, bmpHeight))) {
@@ -449,31 +868,78 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
 
           if ((loadWidth > 0) && (loadHeight > 0)) { // Clip top/left
             if (tft) {
-              tft->startWrite(); // Start SPI (regardless of transact)
-              tft->setAddrWindow(x, y, loadWidth, loadHeight);
+              if (reverse) { // Y axis is mirrored, and so is the window
+                tft->sendCommand(0x36, &madctl, 1);
+                y = tft->height() - y - loadHeight + scanOffset;
+              }
             } else {
               if (depth == 1) {
                 img->format = IMAGE_1; // Is a GFX 1-bit canvas type
+              } else if (depth == 8) {
+                img->format = IMAGE_8; // Is a GFX 8-bit canvas type
+              } else if (depth == 4) {
+                img->format = IMAGE_4; // GFX 8-bit canvas, packed 4-bit
+                img->width4 = bmpWidth;
               } else {
                 img->format = IMAGE_16; // Is a GFX 16-bit canvas type
               }
             }
 
-            if ((depth >= 16) ||
-                (quantized = (uint16_t *)malloc(colors * sizeof(uint16_t)))) {
+            // Palette has an entry for every possible pixel value, even
+            // if the file holds fewer colors (extras are black)
+            if ((depth >= 16) || (quantized = (uint16_t *)calloc(
+                                      1 << depth, sizeof(uint16_t)))) {
               if (depth < 16) {
-                // Load and quantize color table
+                // Load and quantize color table (follows header)
+                if (file.position() != 14 + headerSize)
+                  seekData(14 + headerSize);
                 for (uint16_t c = 0; c < colors; c++) {
-                  b = file.read();
-                  g = file.read();
-                  r = file.read();
-                  (void)file.read(); // Ignore 4th byte
+                  readData(sdbuf, 4); // B, G, R, ignore 4th byte
+                  b = sdbuf[0];
+                  g = sdbuf[1];
+                  r = sdbuf[2];
                   quantized[c] =
                       ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+                  if (tft && TFT_BIGENDIAN) // Swap once here, not per pixel
+                    quantized[c] = (quantized[c] >> 8) | (quantized[c] << 8);
                 }
               }
 
+              // Run-length encoded rows aren't at fixed positions; the
+              // whole image is decoded in one sequential pass from the
+              // start of pixel data, so seek there before the TFT is busy.
+              if (compression && (file.position() != offset))
+                seekData(offset);
+
+              if (tft) { // Palette is read, card is free until pixel data
+                tft->startWrite(); // Start SPI (regardless of transact)
+                tft->setAddrWindow(x, y, loadWidth, loadHeight);
+              }
+
+              if (stats) { // Header & palette done, pixel data starts here
+                stats->headerTime = micros() - startTime;
+                stats->readTime = 0;
+              }
+
+              // If sdbuf can hold a full (clipped) scanline plus up to a
+              // sector of lead-in, whole rows are loaded at once, in big
+              // sector-aligned blocks (allowing multi-sector SD reads).
+              // Top-to-bottom BMPs then read sequentially, several rows
+              // per block; bottom-to-top BMPs read blocks from the end of
+              // the file backwards, one seek per block rather than per
+              // row. Otherwise rows are read in sdbuf-sized chunks.
+              rowBytes = ((uint32_t)(loadX + loadWidth) * depth + 7) / 8 -
+                         ((uint32_t)loadX * depth) / 8;
+              rowMode = (sdbufSize >= rowBytes + 511);
+              firstSector = offset & ~(uint32_t)511;
+
               for (row = 0; row < loadHeight; row++) { // For each scanline...
+                if (compression) {
+                  rleBMP(tft, dest, destAlt, destSize, dest1, sdbuf, sdbufSize,
+                         quantized, depth, bmpWidth, bmpHeight, x, y, loadX,
+                         loadY, loadWidth, loadHeight, transact);
+                  break;
+                }
 #ifdef ESP8266
                 delay(1); // Keep ESP8266 happy
 #endif
@@ -487,8 +953,27 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
                   bmpPos = offset + (bmpHeight - 1 - (row + loadY)) * rowSize;
                 else // Bitmap is stored top-to-bottom
                   bmpPos = offset + (row + loadY) * rowSize;
-                if (depth == 24) {
+                if (depth == 32) {
+                  bmpPos += loadX * 4;
+                } else if (depth == 24) {
                   bmpPos += loadX * 3;
+                } else if (depth == 16) {
+                  bmpPos += loadX * 2;
+                  if (img && !is555) {
+                    // 565 is the canvas format, read straight into it.
+                    // (No clipping when loading, rows are contiguous.)
+                    if (file.position() != bmpPos)
+                      seekData(bmpPos);
+                    readData(&dest[(uint32_t)row * bmpWidth], bmpWidth * 2UL);
+                    continue;
+                  }
+                } else if (depth == 8) {
+                  bmpPos += loadX;
+                } else if (depth == 4) {
+                  bmpPos += loadX / 2;
+                  bitIn = (loadX & 1) ? 0 : 4; // Nibble shift of 1st pixel
+                  if (img)
+                    destidx = ((bmpWidth + 1) / 2) * row;
                 } else {
                   bmpPos += loadX / 8;
                   bitIn = 7 - (loadX & 7);
@@ -496,59 +981,179 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
                   if (img)
                     destidx = ((bmpWidth + 7) / 8) * row;
                 }
-                if (file.position() != bmpPos) { // Need seek?
-                  if (transact) {
-                    tft->dmaWait();
-                    tft->endWrite(); // End TFT SPI transaction
+                if (rowMode) {
+                  // Whole rows fit in sdbuf; is this one there already?
+                  if ((bmpPos >= bufPos) &&
+                      (bmpPos + rowBytes <= bufPos + bufLen)) {
+                    srcidx = bmpPos - bufPos;
+                  } else {
+                    if (!flip && bufLen && (bmpPos >= bufPos) &&
+                        (bmpPos <= bufPos + bufLen)) {
+                      // Row starts in sdbuf but runs past the end. Move
+                      // that part to the front and continue reading from
+                      // the file where the last load left off (no seek,
+                      // and reads stay sector-aligned).
+                      readOfs = bufPos + bufLen - bmpPos;
+                      memmove(sdbuf, &sdbuf[bmpPos - bufPos], readOfs);
+                      readLen = (sdbufSize - readOfs) & ~(uint32_t)511;
+                    } else if (flip && bufLen && (bmpPos < bufPos) &&
+                               (bmpPos + rowBytes >= bufPos)) {
+                      // Bottom-to-top: row ends in sdbuf. Move that part
+                      // to the back and load the block preceding it, so
+                      // each seek brings in several rows (in reverse).
+                      keep = bmpPos + rowBytes - bufPos;
+                      readLen = (sdbufSize - keep) & ~(uint32_t)511;
+                      if (readLen > bufPos - firstSector)
+                        readLen = bufPos - firstSector;
+                      memmove(&sdbuf[readLen], sdbuf, keep);
+                      readPos = bufPos - readLen;
+                      skip = bmpPos - readPos; // Row start within block
+                    } else if (flip) {
+                      // Not sequential, load a block ending with this row
+                      n = bmpPos + rowBytes + 511 - sdbufSize;
+                      readPos = (n > (int32_t)firstSector)
+                                    ? (n & ~(int32_t)511)
+                                    : firstSector;
+                      skip = bmpPos - readPos; // Row start within block
+                    } else {
+                      // Not sequential, load from the row's sector
+                      readPos = bmpPos & ~(uint32_t)511;
+                      skip = bmpPos - readPos; // Row start within block
+                    }
+                    srcidx = sdbufSize; // Force buffer reload
                   }
-                  file.seek(bmpPos);     // Seek = SD transaction
-                  srcidx = sizeof sdbuf; // Force buffer reload
+                } else if (!bufLen || ((bufPos + srcidx) != bmpPos)) {
+                  // Unless this row continues directly from the unread
+                  // data in sdbuf, start a new read at the row.
+                  readPos = bmpPos;
+                  srcidx = sdbufSize; // Force buffer reload
                 }
-                for (col = 0; col < loadWidth; col++) { // For each pixel...
-                  if (srcidx >= sizeof sdbuf) {         // Time to load more?
-                    if (tft) {                          // Drawing to TFT?
-                      if (transact) {
-                        tft->dmaWait();
-                        tft->endWrite(); // End TFT SPI transact
-                      }
-#if defined(ARDUINO_NRF52_ADAFRUIT)
-                      // NRF52840 seems to have trouble reading more than 512
-                      // bytes across certain boundaries. Workaround for now
-                      // is to break the read into smaller chunks...
-                      int32_t bytesToGo = sizeof sdbuf, bytesRead = 0,
-                              bytesThisPass;
-                      while (bytesToGo > 0) {
-                        bytesThisPass = min(bytesToGo, 512);
-                        file.read(&sdbuf[bytesRead], bytesThisPass);
-                        bytesRead += bytesThisPass;
-                        bytesToGo -= bytesThisPass;
-                      }
-#else
-                      file.read(sdbuf, sizeof sdbuf); // Load from SD
-#endif
+                for (col = 0; col < loadWidth;) { // For each pixel...
+                  if (srcidx >= sdbufSize) {       // Time to load more?
+                    if (tft && transact) {
+                      tft->dmaWait();
+                      tft->endWrite(); // End TFT SPI transaction
+                    }
+                    if (file.position() != readPos) // Need seek?
+                      seekData(readPos);            // Seek = SD transaction
+                    n = readData(&sdbuf[readOfs], readLen); // Load from SD
+                    if (n < 0)
+                      n = 0;
+                    bufPos = readPos - readOfs;
+                    bufLen = readOfs + n;
+                    if (n == (int32_t)readLen)
+                      bufLen += keep; // Retained data follows the load
+                    readPos += n;     // Next sequential load
+                    readOfs = keep = 0;
+                    readLen = sdbufSize;
+                    if (tft) { // Drawing to TFT?
                       if (transact)
-                        tft->startWrite(); // Start TFT SPI transact
+                        tft->startWrite(); // Start TFT SPI transaction
                       if (destidx) {       // If buffered TFT data
-                        // Non-blocking writes (DMA) have been temporarily
-                        // disabled until this can be rewritten with two
-                        // alternating 'dest' buffers (else the nonblocking
-                        // data out is overwritten in the dest[] write below).
-                        // tft->writePixels(dest, destidx, false); // Write it
-                        tft->writePixels(dest, destidx, true); // Write it
+                        // Pixels converted from the prior sdbuf go out now
+                        // (non-blocking if there's an alternate buffer),
+                        // overlapping conversion of the new sdbuf contents.
+                        writeDest(tft, dest, destAlt, destidx);
                         destidx = 0; // and reset dest index
                       }
-                    } else {                          // Canvas is simpler,
-                      file.read(sdbuf, sizeof sdbuf); // just load sdbuf
-                    } // (destidx never resets)
-                    srcidx = 0; // Reset bmp buf index
+                    } // (canvas destidx never resets)
+                    srcidx = skip; // Reset bmp buf index
+                    skip = 0;
                   }
-                  if (depth == 24) {
-                    // Convert each pixel from BMP to 565 format, save in dest
-                    b = sdbuf[srcidx++];
-                    g = sdbuf[srcidx++];
-                    r = sdbuf[srcidx++];
-                    dest[destidx++] =
-                        ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+                  if (tft && (destidx >= destSize)) { // dest full?
+                    // sdbuf may hold more pixels than dest (e.g. 1-bit
+                    // data, or a caller buffer rounded to whole sectors).
+                    writeDest(tft, dest, destAlt, destidx);
+                    destidx = 0;
+                  }
+                  if (depth == 32) {
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) / 4);
+                    if (tft)
+                      span = min(span, destSize - destidx);
+                    // Masked canvas keeps full color, alpha goes to mask
+                    bgra8888To565(&sdbuf[srcidx], &dest[destidx], span,
+                                  mask1 ? (uint8_t)IMAGE_ALPHA_IGNORE
+                                        : alphaMode,
+                                  alphaThreshold, alphaColor,
+                                  tft && TFT_BIGENDIAN);
+                    if (mask1) {
+                      for (uint32_t i = 0; i < span; i++) {
+                        if (sdbuf[srcidx + i * 4 + 3] >= alphaThreshold)
+                          mask1[row * maskStride + ((col + i) >> 3)] |=
+                              0x80 >> ((col + i) & 7);
+                      }
+                    }
+                    srcidx += span * 4;
+                    destidx += span;
+                    col += span;
+                  } else if (depth == 24) {
+                    // Convert as many pixels from BMP to 565 format as the
+                    // row, sdbuf and (for TFT) dest allow, save in dest
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) / 3);
+                    if (tft)
+                      span = min(span, destSize - destidx);
+                    bgr888To565(&sdbuf[srcidx], &dest[destidx], span,
+                                tft && TFT_BIGENDIAN);
+                    srcidx += span * 3;
+                    destidx += span;
+                    col += span;
+                  } else if (depth == 16) {
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) / 2);
+                    if (tft)
+                      span = min(span, destSize - destidx);
+                    rgb16To565(&sdbuf[srcidx], &dest[destidx], span, is555,
+                               tft && TFT_BIGENDIAN);
+                    srcidx += span * 2;
+                    destidx += span;
+                    col += span;
+                  } else if (depth == 8) {
+                    span = min((uint32_t)(loadWidth - col), sdbufSize - srcidx);
+                    if (tft) {
+                      // Look up each color index in palette, store in dest
+                      span = min(span, destSize - destidx);
+                      for (uint32_t i = 0; i < span; i++)
+                        dest[destidx + i] = quantized[sdbuf[srcidx + i]];
+                    } else {
+                      // Copy indices to canvas8 buffer (palette kept apart)
+                      memcpy(&dest1[destidx], &sdbuf[srcidx], span);
+                    }
+                    srcidx += span;
+                    destidx += span;
+                    col += span;
+                  } else if (depth == 4) {
+                    // Pixels available in sdbuf: two per byte, less one if
+                    // a byte's high nibble was consumed by the prior span
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) * 2 - (bitIn ? 0 : 1));
+                    if (tft)
+                      span = min(span, destSize - destidx);
+                    col += span;
+                    if (tft) {
+                      // Unpack two pixels per byte through the palette
+                      if (!bitIn) { // Finish a split byte
+                        dest[destidx++] = quantized[sdbuf[srcidx++] & 0x0F];
+                        bitIn = 4;
+                        span--;
+                      }
+                      for (; span >= 2; span -= 2) {
+                        b = sdbuf[srcidx++];
+                        dest[destidx++] = quantized[b >> 4];
+                        dest[destidx++] = quantized[b & 0x0F];
+                      }
+                      if (span) { // Odd pixel out, low nibble next time
+                        dest[destidx++] = quantized[sdbuf[srcidx] >> 4];
+                        bitIn = 0;
+                      }
+                    } else {
+                      // Copy packed bytes to canvas (rows start on a byte)
+                      span = (span + 1) / 2;
+                      memcpy(&dest1[destidx], &sdbuf[srcidx], span);
+                      srcidx += span;
+                      destidx += span;
+                    }
                   } else {
                     // Extract 1-bit color index
                     uint8_t n = (sdbuf[srcidx] >> bitIn) & 1;
@@ -573,20 +1178,22 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
                         destidx++;
                       }
                     }
+                    col++;
                   }
                 } // end pixel loop
-                if (tft) {       // Drawing to TFT?
-                  if (destidx) { // Any remainders?
-                    // See notes above re: DMA
-                    // tft->writePixels(dest, destidx, false); // Write it
-                    tft->writePixels(dest, destidx, true); // Write it
-                    destidx = 0; // and reset dest index
-                  }
-                  tft->dmaWait();
-                  tft->endWrite(); // End TFT (regardless of transact)
-                }
               } // end scanline loop
 
+              if (tft) {       // Drawing to TFT?
+                if (destidx) { // Any remainders?
+                  writeDest(tft, dest, destAlt, destidx);
+                }
+                tft->dmaWait();  // Wait for last non-blocking write
+                tft->endWrite(); // End TFT (regardless of transact)
+              }
+
+              if (stats)
+                stats->pixels = (uint32_t)loadWidth * loadHeight;
+
               if (quantized) {
                 if (tft)
                   free(quantized); // Palette no longer needed
@@ -594,6 +1201,10 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
                   img->palette = quantized; // Keep palette with img
               }
             } // end depth>24 or quantized malloc OK
+            if (reverse) {
+              madctl = scanMADCTL; // Restore normal scan direction
+              tft->sendCommand(0x36, &madctl, 1);
+            }
           } // end top/left clip
         } // end malloc check
       } // end depth check
@@ -601,9 +1212,206 @@ ImageReturnCode Adafruit_ImageReader::coreBMP(
   } // end signature
 
   file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
   return status;
 }
 
+/*!
+    @brief   Decodes RLE8 or RLE4 compressed BMP pixel data (BI_RLE8 or
+             BI_RLE4) from the current file position, reading sequentially
+             through sdbuf. Runs of one color go to the TFT as a single
+             writeColor() (or memset() into a canvas) rather than pixel by
+             pixel. Pixels skipped by delta and end-of-line codes are left
+             untouched on the TFT, and are index 0 in a loaded canvas.
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+             Caller has started the SPI transaction.
+    @param   dest
+             TFT working buffer; may be exchanged with destAlt on return.
+    @param   destAlt
+             Alternate TFT working buffer, or NULL.
+    @param   destSize
+             Size of each TFT working buffer, in pixels.
+    @param   dest1
+             Canvas buffer (8-bit, or packed 4-bit), if loading to RAM.
+    @param   sdbuf
+             File read buffer.
+    @param   sdbufSize
+             Size of sdbuf in bytes.
+    @param   palette
+             16-bit color palette (TFT only, byte order as for writePixels()).
+    @param   depth
+             8 for RLE8, 4 for RLE4.
+    @param   bmpWidth
+             Image width in pixels.
+    @param   bmpHeight
+             Image height in pixels.
+    @param   x
+             Screen position of visible area's left edge (if TFT).
+    @param   y
+             Screen position of visible area's top edge (if TFT).
+    @param   loadX
+             Left column of visible area within image.
+    @param   loadY
+             Top row of visible area within image.
+    @param   loadWidth
+             Width of visible area in pixels.
+    @param   loadHeight
+             Height of visible area in pixels.
+    @param   transact
+             If true, end TFT SPI transaction around SD reads.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::rleBMP(Adafruit_SPITFT *tft, uint16_t *&dest,
+                                  uint16_t *&destAlt, uint32_t destSize,
+                                  uint8_t *dest1, uint8_t *sdbuf,
+                                  uint32_t sdbufSize, uint16_t *palette,
+                                  uint8_t depth, int bmpWidth, int bmpHeight,
+                                  int16_t x, int16_t y, int loadX, int loadY,
+                                  int loadWidth, int loadHeight,
+                                  boolean transact) {
+  uint32_t srcidx = 0, bufLen = 0; // Position & valid bytes in sdbuf
+  uint32_t destidx = 0;            // Pixels in TFT dest buffer
+  uint32_t stride = (depth == 8) ? bmpWidth : (bmpWidth + 1) / 2;
+  int32_t col = 0, row = bmpHeight - 1; // Pen position (row 0 = top)
+  int32_t winCol = -1, winRow = -1;     // Next pixel in TFT address window
+  int32_t i, i0, i1;                    // Visible pixels within a run
+  uint32_t count;                       // Pixels in run or literal chunk
+  uint8_t left = 0;                     // Literal pixels still to read
+  boolean pad = false;                  // Literal data has a pad byte
+  boolean fill;                         // Run goes out as writeColor()
+  uint8_t a, b = 0, idx, *src, *d;
+  uint16_t c;
+  int32_t n;
+
+  // Rows only move upward, so decoding ends above the visible area
+  while (row >= loadY) {
+    if (bufLen - srcidx < 4) {
+      // Keep the unread bytes (part of a code, at most) and refill sdbuf,
+      // so the longest escape (delta, 4 bytes) is always there whole.
+      bufLen -= srcidx;
+      memmove(sdbuf, &sdbuf[srcidx], bufLen);
+      srcidx = 0;
+      if (tft && transact) {
+        tft->dmaWait();
+        tft->endWrite(); // End TFT SPI transaction
+      }
+      n = readData(&sdbuf[bufLen], sdbufSize - bufLen);
+      if (n > 0)
+        bufLen += n;
+      if (tft && transact)
+        tft->startWrite(); // Start TFT SPI transaction
+      if (srcidx >= bufLen)
+        break; // Out of data, no end-of-bitmap code
+    }
+    if (left) {
+      // Literal pixels (absolute mode), as many as are in sdbuf. A chunk
+      // cut short by the end of sdbuf is a whole number of bytes, so the
+      // next starts on a byte (RLE4 nibbles stay in step).
+      src = &sdbuf[srcidx];
+      count = min((uint32_t)left, (bufLen - srcidx) * (8 / depth));
+      left -= count;
+      srcidx += (count * depth + 7) / 8;
+    } else if (pad) { // Skip padding following literal data
+      srcidx++;
+      pad = false;
+      continue;
+    } else {
+      if (bufLen - srcidx < 2)
+        break; // Truncated file
+      src = NULL;
+      a = sdbuf[srcidx++];
+      b = sdbuf[srcidx++];
+      if (a) { // Encoded run: 'a' pixels of index b (RLE4: two, alternating)
+        count = a;
+      } else if (b == 0) { // End of line
+        col = 0;
+        row--;
+        continue;
+      } else if (b == 1) { // End of bitmap
+        break;
+      } else if (b == 2) { // Delta: move right and up
+        if (bufLen - srcidx < 2)
+          break; // Truncated file
+        col += sdbuf[srcidx++];
+        row -= sdbuf[srcidx++];
+        continue;
+      } else { // Absolute mode: b literal pixels follow, padded to 16 bits
+        left = b;
+        pad = ((b * depth + 7) / 8) & 1;
+        continue;
+      }
+    }
+
+    // Output the part of the run within the visible area (if any)
+    if ((row < loadY + loadHeight) && (col < loadX + loadWidth) &&
+        (col + (int32_t)count > loadX)) {
+      i0 = (col < loadX) ? loadX - col : 0;
+      i1 = min((int32_t)count, loadX + loadWidth - col);
+      if (tft) {
+        // Long single-color runs are sent as a repeated color
+        fill = !src && ((depth == 8) || ((b >> 4) == (b & 0x0F))) &&
+               (i1 - i0 >= 16);
+        if (fill || (row != winRow) || (col + i0 != winCol)) {
+          if (destidx) { // Pixels queued ahead of this run go out first
+            writeDest(tft, dest, destAlt, destidx);
+            destidx = 0;
+          }
+          tft->dmaWait();
+          if ((row != winRow) || (col + i0 != winCol)) {
+            // Following a delta, end-of-line or clipped pixels. Window
+            // spans the rest of the visible row, so runs can follow.
+            tft->setAddrWindow(x + col + i0 - loadX, y + row - loadY,
+                               loadX + loadWidth - col - i0, 1);
+            winRow = row;
+          }
+        }
+        winCol = col + i1;
+        if (fill) {
+          c = palette[b & ((depth == 8) ? 0xFF : 0x0F)];
+          if (TFT_BIGENDIAN) // Palette is pre-swapped for writePixels()
+            c = (c >> 8) | (c << 8);
+          tft->writeColor(c, i1 - i0);
+        } else {
+          for (i = i0; i < i1; i++) {
+            if (destidx >= destSize) {
+              writeDest(tft, dest, destAlt, destidx);
+              destidx = 0;
+            }
+            if (depth == 8)
+              idx = src ? src[i] : b;
+            else // First pixel in high nibble
+              idx = ((src ? src[i >> 1] : b) >> ((i & 1) ? 0 : 4)) & 0x0F;
+            dest[destidx++] = palette[idx];
+          }
+        }
+      } else {
+        d = &dest1[(uint32_t)row * stride];
+        if (depth == 8) {
+          if (src)
+            memcpy(&d[col + i0], &src[i0], i1 - i0);
+          else
+            memset(&d[col + i0], b, i1 - i0);
+        } else {
+          for (i = i0; i < i1; i++) { // Canvas is packed 4-bit too
+            idx = ((src ? src[i >> 1] : b) >> ((i & 1) ? 0 : 4)) & 0x0F;
+            n = col + i;
+            if (n & 1)
+              d[n >> 1] = (d[n >> 1] & 0xF0) | idx;
+            else
+              d[n >> 1] = (d[n >> 1] & 0x0F) | (idx << 4);
+          }
+        }
+      }
+    }
+    col += count;
+  }
+
+  if (destidx) // Any remainders?
+    writeDest(tft, dest, destAlt, destidx);
+}
+
 /*!
     @brief   Query pixel dimensions of BMP image file on SD card.
     @param   filename
@@ -686,6 +1494,3845 @@ ImageReturnCode Adafruit_ImageReader::bmpDimensions(const uint8_t *bmp,
 
 // UTILITY FUNCTIONS *******************************************************
 
+/*!
+    @brief   Draws a raw RGB565 image file (as made by the bmp2rgb565 tool
+             in extras/) from SD card to SPITFT screen. As the file holds
+             pixels in the order and byte format the display expects,
+             there's no conversion: data goes from the file straight to
+             writePixels(), through two buffers that alternate between
+             file reads and (non-blocking, DMA where supported) display
+             writes. When the image isn't clipped horizontally, reads
+             span multiple rows and are sector-aligned.
+    @param   filename
+             Name of image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false' (which also lets file reads overlap display
+             writes).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::drawRGB565(const char *filename,
+                                                 Adafruit_SPITFT &tft,
+                                                 int16_t x, int16_t y,
+                                                 boolean transact) {
+  ImageReturnCode status;
+  uint16_t localbuf[BUFPIXELS * 2]; // Default pixel buffers
+  uint16_t *buf[2] = {localbuf, &localbuf[BUFPIXELS]};
+  uint32_t bufSize = BUFPIXELS * 2; // Bytes in each buffer
+  int32_t imgWidth, imgHeight;      // Image size in pixels
+  int32_t loadWidth, loadHeight,    // Region being loaded (clipped)
+      loadX, loadY;                 // "
+  uint32_t spans, spanBytes;        // Contiguous file data
+  uint32_t pos, left, n;            // File position & read size
+  uint8_t cur = 0;                  // Buffer being read into
+  uint32_t startTime = 0, t;        // Timing for stats
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  // If the caller provided a working buffer (see setBuffer()), it's
+  // split evenly into the two pixel buffers.
+  if (scratch && (scratchSize >= 32)) {
+    uint8_t *p = (uint8_t *)(((uintptr_t)scratch + 3) & ~(uintptr_t)3);
+    bufSize = ((scratchSize - (p - scratch)) / 2) & ~(uint32_t)3;
+    buf[0] = (uint16_t *)p;
+    buf[1] = (uint16_t *)&p[bufSize];
+  }
+
+  // Drawn off the right or bottom edge, nothing to do
+  if ((x >= tft.width()) || (y >= tft.height()))
+    return IMAGE_SUCCESS;
+
+  if ((status = openRGB565(filename, "R565", &imgWidth,
+                             &imgHeight)) != IMAGE_SUCCESS)
+    return status;
+
+  // Crop area to be loaded
+  loadWidth = imgWidth;
+  loadHeight = imgHeight;
+  loadX = 0;
+  loadY = 0;
+  if (x < 0) {
+    loadX = -x;
+    loadWidth += x;
+    x = 0;
+  }
+  if (y < 0) {
+    loadY = -y;
+    loadHeight += y;
+    y = 0;
+  }
+  if ((x + loadWidth) > tft.width())
+    loadWidth = tft.width() - x;
+  if ((y + loadHeight) > tft.height())
+    loadHeight = tft.height() - y;
+
+  if ((loadWidth > 0) && (loadHeight > 0)) {
+    if (stats)
+      stats->headerTime = micros() - startTime;
+    // Unless clipped horizontally, visible rows are one contiguous span
+    if (loadWidth == imgWidth) {
+      spans = 1;
+      spanBytes = loadWidth * loadHeight * 2;
+    } else {
+      spans = loadHeight;
+      spanBytes = loadWidth * 2;
+    }
+    tft.startWrite(); // Start SPI (regardless of transact)
+    tft.setAddrWindow(x, y, loadWidth, loadHeight);
+    for (uint32_t s = 0; s < spans; s++) {
+      pos = RGB565_HEADER + ((loadY + s) * imgWidth + loadX) * 2;
+      for (left = spanBytes; left; left -= n) {
+        n = bufSize;
+        if (n >= 1024) // Large buffer, end reads on a sector boundary
+          n -= (pos + n) & 511;
+        if (n > left)
+          n = left;
+        if (transact) {
+          tft.dmaWait();
+          tft.endWrite(); // End TFT SPI transaction
+        }
+        if (file.position() != pos) // Need seek?
+          seekData(pos);
+        if (readData(buf[cur], n) != (int)n) { // Truncated file
+          status = IMAGE_ERR_FORMAT;
+          spans = 0;
+          break;
+        }
+        if (transact)
+          tft.startWrite(); // Start TFT SPI transaction
+        t = stats ? micros() : 0;
+        tft.dmaWait(); // Other buffer has gone out, next read can use it
+        tft.writePixels(buf[cur], n / 2, false, true); // Big-endian
+        if (stats)
+          stats->writeTime += micros() - t;
+        cur ^= 1;
+        pos += n;
+      }
+    }
+    if (transact && (status != IMAGE_SUCCESS))
+      tft.startWrite(); // (Read failed with transaction ended)
+    tft.dmaWait();  // Wait for last non-blocking write
+    tft.endWrite(); // End TFT (regardless of transact)
+    if (stats)
+      stats->pixels = (uint32_t)loadWidth * loadHeight;
+  }
+
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+}
+
+/*!
+    @brief   Loads a raw RGB565 image file (see drawRGB565()) from SD card
+             into RAM, as a GFXcanvas16 (IMAGE_16) Adafruit_Image. Pixel
+             data is read straight into the canvas in a single read.
+    @param   filename
+             Name of image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadRGB565(const char *filename,
+                                                 Adafruit_Image &img) {
+  ImageReturnCode status;
+  int32_t imgWidth, imgHeight;
+  uint32_t startTime = 0;
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  img.dealloc();
+  if ((status = openRGB565(filename, "R565", &imgWidth,
+                             &imgHeight)) != IMAGE_SUCCESS)
+    return status;
+  if (stats)
+    stats->headerTime = micros() - startTime;
+
+  status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+  if ((img.canvas.canvas16 = new GFXcanvas16(imgWidth, imgHeight))) {
+    uint16_t *dest = img.canvas.canvas16->getBuffer();
+    uint32_t n = (uint32_t)imgWidth * imgHeight;
+    if (dest && (readData(dest, n * 2) == (int)(n * 2))) {
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      // File is big-endian, canvas is native order
+      for (uint32_t i = 0; i < n; i++)
+        dest[i] = (dest[i] >> 8) | (dest[i] << 8);
+#endif
+      img.format = IMAGE_16;
+      status = IMAGE_SUCCESS;
+      if (stats)
+        stats->pixels = n;
+    } else {
+      if (dest) // Allocated OK, file is short
+        status = IMAGE_ERR_FORMAT;
+      delete img.canvas.canvas16;
+      img.canvas.canvas16 = NULL;
+    }
+  }
+
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+}
+
+/*!
+    @brief   Query pixel dimensions of raw RGB565 image file on SD card.
+    @param   filename
+             Name of image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::rgb565Dimensions(const char *filename,
+                                                       int32_t *width,
+                                                       int32_t *height) {
+  int32_t w, h;
+  ImageReturnCode status = openRGB565(filename, "R565", &w, &h);
+  if (status == IMAGE_SUCCESS) {
+    file.close();
+    if (width)
+      *width = w;
+    if (height)
+      *height = h;
+  }
+  return status;
+}
+
+/*!
+    @brief   Draws an LZ4-compressed RGB565 image file (as made by the
+             bmp2rgb565 tool in extras/, with the -z option) from SD card
+             to SPITFT screen. Decompressing costs a little CPU time, but
+             on SD cards in SPI mode (where reading is the bottleneck) the
+             smaller file is usually faster to draw than a BMP or raw
+             RGB565 file. Blocks entirely above or below the screen are
+             skipped, not read.
+    @param   filename
+             Name of image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure). IMAGE_ERR_MALLOC if the
+             file's match offsets need a larger working buffer (see
+             setBuffer()) than is available.
+*/
+ImageReturnCode Adafruit_ImageReader::drawLZ565(const char *filename,
+                                                Adafruit_SPITFT &tft,
+                                                int16_t x, int16_t y,
+                                                boolean transact) {
+  return coreLZ565(filename, &tft, x, y, NULL, transact);
+}
+
+/*!
+    @brief   Loads an LZ4-compressed RGB565 image file (see drawLZ565())
+             from SD card into RAM, as a GFXcanvas16 (IMAGE_16)
+             Adafruit_Image. Data is decompressed straight into the canvas.
+    @param   filename
+             Name of image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadLZ565(const char *filename,
+                                                Adafruit_Image &img) {
+  return coreLZ565(filename, NULL, 0, 0, &img, false);
+}
+
+/*!
+    @brief   Query pixel dimensions of LZ4-compressed RGB565 image file on
+             SD card.
+    @param   filename
+             Name of image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::lz565Dimensions(const char *filename,
+                                                      int32_t *width,
+                                                      int32_t *height) {
+  int32_t w, h;
+  ImageReturnCode status = openRGB565(filename, "L565", &w, &h);
+  if (status == IMAGE_SUCCESS) {
+    file.close();
+    if (width)
+      *width = w;
+    if (height)
+      *height = h;
+  }
+  return status;
+}
+
+/*!
+    @brief   LZ4 RGB565 reading function common to the draw function (to
+             TFT) and load function (to canvas in RAM). When loading, data
+             is decompressed in place in the canvas. When drawing, it goes
+             to a ring buffer holding the most recent output (which LZ4
+             matches copy from); each half of the ring is written to the
+             TFT (non-blocking) as soon as it fills, while the other half
+             is being decompressed into. Working memory is the same as
+             drawBMP(), or the buffer passed to setBuffer().
+    @param   filename
+             Name of image file to load.
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+    @param   x
+             Horizontal offset in pixels (if loading to screen).
+    @param   y
+             Vertical offset in pixels (if loading to screen).
+    @param   img
+             Pointer to Adafruit_Image object, if loading to RAM (or NULL
+             if loading to screen).
+    @param   transact
+             Use SPI transactions; 'true' is needed only if loading to screen
+             and it's on the same SPI bus as the SD card.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::coreLZ565(const char *filename,
+                                                Adafruit_SPITFT *tft,
+                                                int16_t x, int16_t y,
+                                                Adafruit_Image *img,
+                                                boolean transact) {
+  ImageReturnCode status;
+  // Same working memory as drawBMP(), 32-bit aligned for pixel writes
+  uint32_t localbuf[(BUFPIXELS * (3 + 2 * DESTBUFS) + 3) / 4];
+  uint8_t *work = (uint8_t *)localbuf; // Working buffer
+  uint32_t workSize = sizeof localbuf; // Size of working buffer in bytes
+  uint8_t *ring;             // Decompressed data (ring buffer if TFT)
+  uint32_t ringMask;         // Ring buffer size - 1
+  uint32_t half;             // Ring buffer size / 2 (TFT writes at each)
+  uint8_t *in;               // File read buffer
+  uint32_t inSize;           // Size of file read buffer in bytes
+  uint32_t ip = 0, il = 0;   // Position & valid bytes in read buffer
+  int32_t imgWidth, imgHeight; // Image size in pixels
+  int32_t loadWidth, loadHeight, // Region being loaded (clipped)
+      loadX = 0, loadY = 0;      // "
+  uint16_t blockRows, window; // Rows per block, max. match offset
+  uint32_t firstBlock, lastBlock; // Range of blocks to decompress
+  uint32_t readPos, readEnd;  // File position of first & past last block
+  uint32_t base;              // First pixel (in image) of first block
+  uint32_t total;             // Decompressed bytes in all blocks
+  uint32_t blockBytes;        // Decompressed bytes per (full) block
+  uint32_t g = 0;             // Decompressed bytes so far (all blocks)
+  uint32_t blockStart = 0;    // Value of g at start of current block
+  uint32_t blockEnd = 0;      // Value of g at end of current block
+  uint32_t flushed = 0;       // Value of g at last TFT write
+  uint32_t left = 0;          // Compressed bytes left in block
+  uint32_t lit = 0, match = 0; // Literal & match lengths
+  uint32_t off = 0;           // Match offset
+  uint8_t sizeBytes = 0;      // Bytes read of block's compressed size
+  boolean matchExt = false;   // Match length continues past token
+  uint8_t state = 0;          // Decoder state (see below)
+  uint32_t n, i;
+  uint8_t b;
+  uint32_t startTime = 0, t;  // Timing for stats
+
+  // Decoder states, in order of bytes in the file
+  enum {
+    LZ_SIZE,     // Block's compressed size (4 bytes)
+    LZ_TOKEN,    // Sequence start: literal & match length nibbles
+    LZ_LITLEN,   // Literal length continued
+    LZ_LIT,      // Literal bytes
+    LZ_ENDLIT,   // After literals: match follows, or end of block
+    LZ_OFFLO,    // Match offset, low byte
+    LZ_OFFHI,    // Match offset, high byte
+    LZ_MATCHLEN, // Match length continued
+    LZ_COPY      // Copying match (no input)
+  };
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  if (img)
+    img->dealloc();
+
+  // If the caller provided a working buffer (see setBuffer()), use it
+  if (scratch && (scratchSize >= 32)) {
+    work = (uint8_t *)(((uintptr_t)scratch + 3) & ~(uintptr_t)3);
+    workSize = (scratchSize - (work - scratch)) & ~(uint32_t)3;
+  }
+
+  // Drawn off the right or bottom edge, nothing to do
+  if (tft && ((x >= tft->width()) || (y >= tft->height())))
+    return IMAGE_SUCCESS;
+
+  if ((status = openRGB565(filename, "L565", &imgWidth, &imgHeight)) !=
+      IMAGE_SUCCESS)
+    return status;
+  blockRows = readLE16();
+  window = readLE16();
+  if (blockRows > imgHeight) // Single block either way, same block table
+    blockRows = imgHeight;
+
+  loadWidth = imgWidth;
+  loadHeight = imgHeight;
+  if (tft) {
+    // Crop area to be loaded (if destination is TFT)
+    if (x < 0) {
+      loadX = -x;
+      loadWidth += x;
+      x = 0;
+    }
+    if (y < 0) {
+      loadY = -y;
+      loadHeight += y;
+      y = 0;
+    }
+    if ((x + loadWidth) > tft->width())
+      loadWidth = tft->width() - x;
+    if ((y + loadHeight) > tft->height())
+      loadHeight = tft->height() - y;
+  }
+
+  // Image (and so any block) must have a 32-bit decompressed size; the
+  // block and total byte counts below are unsigned 32-bit math.
+  if (!blockRows || ((uint32_t)imgWidth * imgHeight > 0x7FFFFFFF)) {
+    status = IMAGE_ERR_FORMAT;
+  } else if ((loadWidth > 0) && (loadHeight > 0)) {
+    if (tft) {
+      // Largest power-of-two ring that fits in 3/4 of the working memory,
+      // the rest is for file reads. It must cover the longest match.
+      for (n = 16; n * 2 <= workSize * 3 / 4; n *= 2)
+        ;
+      ring = work;
+      ringMask = n - 1;
+      half = n / 2;
+      in = &work[n];
+      inSize = workSize - n;
+      if (n < window)
+        status = IMAGE_ERR_MALLOC;
+    } else {
+      // Decompress in place, the whole canvas holds prior output
+      status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+      ring = NULL;
+      if ((img->canvas.canvas16 = new GFXcanvas16(imgWidth, imgHeight))) {
+        if ((ring = (uint8_t *)img->canvas.canvas16->getBuffer())) {
+          status = IMAGE_SUCCESS;
+        } else {
+          delete img->canvas.canvas16;
+          img->canvas.canvas16 = NULL;
+        }
+      }
+      ringMask = 0xFFFFFFFF;
+      half = 0x80000000; // No TFT writes
+      in = work;
+      inSize = workSize;
+    }
+
+    if (status == IMAGE_SUCCESS) {
+      // Blocks with visible rows, and their place in the file
+      firstBlock = loadY / blockRows;
+      lastBlock = (loadY + loadHeight - 1) / blockRows;
+      seekData(LZ565_HEADER + firstBlock * 4);
+      readPos = readLE32();
+      if ((lastBlock + 1) * blockRows < (uint32_t)imgHeight) {
+        seekData(LZ565_HEADER + (lastBlock + 1) * 4);
+        readEnd = readLE32();
+      } else {
+        readEnd = 0xFFFFFFFF; // Through last block in file
+      }
+      if (readEnd < readPos) // Corrupt block table
+        status = IMAGE_ERR_FORMAT;
+    }
+
+    if (status == IMAGE_SUCCESS) {
+      base = firstBlock * blockRows * imgWidth;
+      blockBytes = (uint32_t)blockRows * imgWidth * 2;
+      n = (lastBlock + 1) * blockRows;
+      if (n > (uint32_t)imgHeight)
+        n = imgHeight;
+      total = (n * imgWidth - base) * 2;
+      seekData(readPos);
+
+      if (stats)
+        stats->headerTime = micros() - startTime;
+
+      if (tft) {
+        tft->startWrite(); // Start SPI (regardless of transact)
+        tft->setAddrWindow(x, y, loadWidth, loadHeight);
+      }
+
+      while (g < total) {
+        if ((state != LZ_ENDLIT) && (state != LZ_COPY)) {
+          // State needs file data; none left in block is an error
+          if ((state != LZ_SIZE) && !left) {
+            status = IMAGE_ERR_FORMAT;
+            break;
+          }
+          if (ip >= il) { // Time to load more?
+            if (tft && transact) {
+              tft->dmaWait();
+              tft->endWrite(); // End TFT SPI transaction
+            }
+            n = min(inSize, readEnd - readPos);
+            il = (n > 0) ? readData(in, n) : 0;
+            if (tft && transact)
+              tft->startWrite(); // Start TFT SPI transaction
+            if ((int32_t)il <= 0) { // Truncated file
+              status = IMAGE_ERR_FORMAT;
+              break;
+            }
+            readPos += il;
+            ip = 0;
+          }
+        }
+        switch (state) {
+        case LZ_SIZE: // 32-bit LE, then block begins
+          left |= (uint32_t)in[ip++] << (sizeBytes * 8);
+          if (++sizeBytes == 4) {
+            sizeBytes = 0;
+            blockStart = g;
+            blockEnd = min(g + blockBytes, total);
+            state = LZ_TOKEN;
+          }
+          break;
+        case LZ_TOKEN:
+          b = in[ip++];
+          left--;
+          lit = b >> 4;
+          match = (b & 0x0F) + 4;
+          matchExt = ((b & 0x0F) == 15);
+          state = (lit == 15) ? LZ_LITLEN : lit ? LZ_LIT : LZ_ENDLIT;
+          break;
+        case LZ_LITLEN:
+          b = in[ip++];
+          left--;
+          lit += b;
+          if (b != 255)
+            state = LZ_LIT;
+          break;
+        case LZ_LIT:
+          // Copy as many literals as are in the read buffer, up to the
+          // end of this half of the ring (and no further than the block)
+          n = min(lit, min(il - ip, left));
+          n = min(n, min(half - (g & (half - 1)), blockEnd - g));
+          if (lit && !n) { // Too much data for block
+            status = IMAGE_ERR_FORMAT;
+            break;
+          }
+          memcpy(&ring[g & ringMask], &in[ip], n);
+          ip += n;
+          left -= n;
+          lit -= n;
+          g += n;
+          if (!lit)
+            state = LZ_ENDLIT;
+          break;
+        case LZ_ENDLIT:
+          if (left) {
+            state = LZ_OFFLO;
+          } else if (g == blockEnd) { // Block done
+            left = 0;
+            state = LZ_SIZE;
+          } else { // Block is short
+            status = IMAGE_ERR_FORMAT;
+          }
+          break;
+        case LZ_OFFLO:
+          off = in[ip++];
+          left--;
+          state = LZ_OFFHI;
+          break;
+        case LZ_OFFHI:
+          off |= in[ip++] << 8;
+          left--;
+          // Offset must be within block and, if TFT, within ring
+          if (!off || (off > g - blockStart) || (off - 1 > ringMask))
+            status = IMAGE_ERR_FORMAT;
+          state = matchExt ? LZ_MATCHLEN : LZ_COPY;
+          break;
+        case LZ_MATCHLEN:
+          b = in[ip++];
+          left--;
+          match += b;
+          if (b != 255)
+            state = LZ_COPY;
+          break;
+        case LZ_COPY:
+          // Copy from earlier output, up to the end of this half of the
+          // ring. Source may overlap destination (repeating pattern), or
+          // wrap around the ring; if neither, copy in one go.
+          n = min(match, min(half - (g & (half - 1)), blockEnd - g));
+          if (!n) { // Too much data for block
+            status = IMAGE_ERR_FORMAT;
+            break;
+          }
+          if ((off >= n) && (off + n - 1 <= ringMask) &&
+              (((g - off) & ringMask) + n - 1 <= ringMask)) {
+            memcpy(&ring[g & ringMask], &ring[(g - off) & ringMask], n);
+          } else {
+            for (i = 0; i < n; i++)
+              ring[(g + i) & ringMask] = ring[(g + i - off) & ringMask];
+          }
+          g += n;
+          match -= n;
+          if (!match)
+            state = LZ_TOKEN;
+          break;
+        }
+        if (status != IMAGE_SUCCESS)
+          break;
+
+        if (tft && (!(g & (half - 1)) || (g == total)) && (g > flushed)) {
+          // Half of ring is full (or all done). Write visible pixels of
+          // it to TFT, non-blocking, while the other half is filled. The
+          // other half is reused next, so its last write must be done
+          // (even if this half has nothing visible).
+          uint32_t p0 = base + flushed / 2, p1 = base + g / 2, p, q, row;
+          t = stats ? micros() : 0;
+          tft->dmaWait();
+          if (loadWidth == imgWidth) {
+            // Rows aren't clipped, visible pixels are contiguous
+            p = max(p0, (uint32_t)loadY * imgWidth);
+            q = min(p1, (uint32_t)(loadY + loadHeight) * imgWidth);
+            if (q > p)
+              tft->writePixels((uint16_t *)&ring[((p - base) * 2) & ringMask],
+                               q - p, false, true); // Big-endian
+          } else {
+            // Visible part of each row (or partial row)
+            for (p = p0; p < p1; p = q) {
+              row = p / imgWidth;
+              q = min(p1, (row + 1) * imgWidth); // End of row
+              if ((row >= (uint32_t)loadY) &&
+                  (row < (uint32_t)(loadY + loadHeight))) {
+                uint32_t c0 = max(p, row * imgWidth + loadX);
+                uint32_t c1 = min(q, row * imgWidth + loadX + loadWidth);
+                if (c1 > c0) {
+                  tft->dmaWait();
+                  tft->writePixels(
+                      (uint16_t *)&ring[((c0 - base) * 2) & ringMask],
+                      c1 - c0, false, true);
+                }
+              }
+            }
+          }
+          if (stats)
+            stats->writeTime += micros() - t;
+          flushed = g;
+        }
+      }
+
+      if (tft) {
+        tft->dmaWait();  // Wait for last non-blocking write
+        tft->endWrite(); // End TFT (regardless of transact)
+      } else if (status == IMAGE_SUCCESS) {
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        // File is big-endian, canvas is native order
+        uint16_t *dest = (uint16_t *)ring;
+        for (i = 0; i < total / 2; i++)
+          dest[i] = (dest[i] >> 8) | (dest[i] << 8);
+#endif
+        img->format = IMAGE_16;
+      }
+      if (stats && (status == IMAGE_SUCCESS))
+        stats->pixels = (uint32_t)loadWidth * loadHeight;
+    }
+    if (img && (status != IMAGE_SUCCESS) && img->canvas.canvas16) {
+      delete img->canvas.canvas16; // Loaded partially or not at all
+      img->canvas.canvas16 = NULL;
+    }
+  }
+
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+}
+
+/*!
+    @brief   Buffered file input for the decoders of compressed formats,
+             which read a byte (or a few) at a time; see readByte().
+*/
+struct ImageInput {
+  uint8_t *buf;         ///< File read buffer
+  uint32_t bufSize;     ///< Size of buf in bytes
+  uint32_t pos, len;    ///< Position & valid bytes in buf
+  uint32_t filePos;     ///< File position following buf contents
+  boolean eof;          ///< Read past end of file
+  Adafruit_SPITFT *tft; ///< TFT if its SPI transaction is open, else NULL
+  boolean transact;     ///< End TFT transaction around file reads
+};
+
+// JPEG decoding. Baseline JPEG (ITU T.81) only: 8-bit, Huffman-coded,
+// sequential, with all components in one interleaved scan. Grayscale or
+// YCbCr; chroma upsampling is by pixel replication.
+
+// Zigzag order of coefficients in file -> natural (row-major) order
+static const uint8_t jpegZigzag[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+// Reduced inverse DCTs (1/2 and 1/4 scale) give the average of each 2x2
+// or 4x4 group of pixels of the full inverse DCT, from the lowest 4x4 or
+// 2x2 coefficients (higher ones are dropped). Per dimension, averaging
+// K = 8/N adjacent outputs of the 8-point IDCT turns each basis function
+// into that of an N-point IDCT, times the mean of cos(d * u * pi / 16)
+// over offsets d = 1-K, 3-K ... K-1: out[x] = sum over u < N of
+// C(u)/2 * F(u) * cos((2x + 1) * u * pi / (2 * N)) * mean, C(0) =
+// 1/sqrt(2), else 1. Tables are these multipliers * 4096, indexed [x][u].
+static const int16_t jpegIDCT4[4][4] = {{1448, 1856, 1338, 652},
+                                        {1448, 769, -1338, -1573},
+                                        {1448, -769, -1338, 1573},
+                                        {1448, -1856, 1338, -652}};
+static const int16_t jpegIDCT2[2][2] = {{1448, 1312}, {1448, -1312}};
+
+/*!
+    @brief   Huffman table in decoding form. Codes are canonical, so each
+             code length covers a range of values; comparing the next 16
+             bits of input against each length's limit finds the length.
+*/
+struct JPEGHuffman {
+  uint32_t limit[18];  ///< Per length: first code past it, 16-bit aligned
+  int32_t delta[17];   ///< Per length: index in symbol[] minus code
+  uint8_t symbols;     ///< Number of symbols
+  uint8_t symbol[162]; ///< Symbols in code order (162 = most in baseline)
+};
+
+/*!
+    @brief   Working state of JPEG decoder: tables from file header, the
+             position in the entropy-coded data, and the MCU samples being
+             decoded. Allocated on the heap for each image (a few KB, too
+             much for many stacks).
+*/
+struct JPEGDecoder {
+  JPEGHuffman huff[4];   ///< DC tables 0-1, then AC tables 0-1
+  uint16_t quant[4][64]; ///< Quantization tables, zigzag order
+  int16_t coef[64];      ///< One block's DCT coefficients
+  uint8_t strip[640];    ///< Samples for one or more MCUs (10 blocks max.)
+  struct {
+    uint8_t id;          ///< Component ID in frame & scan headers
+    uint8_t h, v;        ///< Sampling factors (blocks per MCU)
+    uint8_t tq;          ///< Quantization table index
+    uint8_t td, ta;      ///< DC & AC Huffman table indices (into huff[])
+    int16_t pred;        ///< DC prediction (last block's DC)
+  } comp[3];             ///< Per image component
+  uint8_t nComp;         ///< Number of components (1 or 3)
+  uint8_t hMax, vMax;    ///< Largest sampling factors
+  uint16_t width;        ///< Image width in pixels
+  uint16_t height;       ///< Image height in pixels
+  uint16_t restart;      ///< Restart interval in MCUs, or 0
+  ImageInput in;         ///< File input
+  uint32_t bits;         ///< Entropy-coded bits, first in MSB
+  int8_t nBits;          ///< Number of valid bits in 'bits'
+  uint8_t marker;        ///< Marker met in entropy-coded data, or 0
+};
+
+/*!
+    @brief   Draws a baseline (not progressive) JPEG image file from SD card
+             to SPITFT screen. The image is decoded one MCU (the 8x8 or
+             16x16 pixel unit of JPEG compression) at a time into a small
+             strip buffer, which goes to the screen through its own address
+             window, so the working memory is a few KB regardless of image
+             size. Decoder tables and the strip are allocated on the heap
+             for the call, leaving about as much on the stack as drawBMP()
+             uses. Optionally the image can be reduced by 1/2, 1/4 or 1/8
+             while decoding; this does less work than a full-size decode
+             (only part of each block's transform, or none at 1/8 scale),
+             making oversized photos much quicker to show.
+    @param   filename
+             Name of JPEG image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   scale
+             Image reduction as a power of two: 0 = full size (default),
+             1 = half, 2 = quarter, 3 = eighth size (rounded up).
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure). Progressive, arithmetic-
+             coded, 12-bit and CMYK JPEGs return IMAGE_ERR_FORMAT.
+*/
+ImageReturnCode Adafruit_ImageReader::drawJPEG(const char *filename,
+                                               Adafruit_SPITFT &tft,
+                                               int16_t x, int16_t y,
+                                               uint8_t scale,
+                                               boolean transact) {
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
+  return coreJPEG(filename, &tft, tftbuf, x, y, NULL, scale, transact);
+}
+
+/*!
+    @brief   Loads a baseline JPEG image file from SD card into RAM, as a
+             GFXcanvas16 (IMAGE_16) Adafruit_Image, optionally reduced in
+             size (see drawJPEG()).
+    @param   filename
+             Name of JPEG image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @param   scale
+             Image reduction as a power of two: 0 = full size (default),
+             1 = half, 2 = quarter, 3 = eighth size (rounded up).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadJPEG(const char *filename,
+                                               Adafruit_Image &img,
+                                               uint8_t scale) {
+  return coreJPEG(filename, NULL, NULL, 0, 0, &img, scale, false);
+}
+
+/*!
+    @brief   Query pixel dimensions of JPEG image file on SD card (full
+             size; a reduced draw or load is this shifted right by the
+             scale, rounded up).
+    @param   filename
+             Name of JPEG image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::jpegDimensions(const char *filename,
+                                                     int32_t *width,
+                                                     int32_t *height) {
+  ImageReturnCode status;
+  JPEGDecoder *j;
+  uint8_t localbuf[64]; // Header is read in small pieces, seeks past rest
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if (!(j = (JPEGDecoder *)malloc(sizeof(JPEGDecoder)))) {
+    file.close();
+    return IMAGE_ERR_MALLOC;
+  }
+  j->in.buf = localbuf;
+  j->in.bufSize = sizeof localbuf;
+  j->in.tft = NULL;
+  if ((status = jpegHeader(*j, true)) == IMAGE_SUCCESS) {
+    if (width)
+      *width = j->width;
+    if (height)
+      *height = j->height;
+  }
+  free(j);
+  file.close();
+  return status;
+}
+
+/*!
+    @brief   Reads big-endian 16-bit value from JPEG file.
+    @param   j
+             JPEG decoder state.
+    @return  Unsigned 16-bit value.
+*/
+uint16_t Adafruit_ImageReader::jpegWord(JPEGDecoder &j) {
+  uint16_t hi = readByte(j.in);
+  return (hi << 8) | readByte(j.in);
+}
+
+/*!
+    @brief   Tops up JPEG entropy-coded bit buffer to at least 25 bits,
+             removing stuffed zero bytes. If a marker is met, it's noted in
+             j.marker and zero bits are supplied from then on.
+    @param   j
+             JPEG decoder state.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::jpegFill(JPEGDecoder &j) {
+  while (j.nBits <= 24) {
+    uint32_t b = 0;
+    if (!j.marker) {
+      if ((b = readByte(j.in)) == 0xFF) {
+        uint8_t b2;
+        while ((b2 = readByte(j.in)) == 0xFF) // Fill bytes
+          ;
+        if (b2 || j.in.eof) { // Marker (or truncated file)
+          j.marker = j.in.eof ? 0xD9 : b2;
+          b = 0;
+        } // else stuffed 0xFF00 is 0xFF data
+      }
+    }
+    j.bits |= b << (24 - j.nBits);
+    j.nBits += 8;
+  }
+}
+
+// Read 'n' (0-16) bits from JPEG entropy-coded data
+static inline uint32_t jpegBits(JPEGDecoder &j, uint8_t n) {
+  uint32_t v = n ? (j.bits >> (32 - n)) : 0;
+  j.bits <<= n;
+  j.nBits -= n;
+  return v;
+}
+
+// Sign-extend 'n'-bit JPEG magnitude value 'v' (T.81 section F.2.2.1)
+static inline int32_t jpegExtend(uint32_t v, uint8_t n) {
+  return (n && (v < (1UL << (n - 1)))) ? (int32_t)v - (1L << n) + 1
+                                       : (int32_t)v;
+}
+
+/*!
+    @brief   Parses JPEG file header up to the start of image data (or up
+             to the frame header, if only the dimensions are wanted),
+             building the decoding tables.
+    @param   j
+             JPEG decoder state; buf & bufSize must be set, the rest is
+             initialized here.
+    @param   dimsOnly
+             If true, stop once image dimensions are known.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::jpegHeader(JPEGDecoder &j,
+                                                 boolean dimsOnly) {
+  uint8_t m, i, k, n;
+  uint16_t len;
+  boolean frame = false; // Frame header seen
+
+  j.in.pos = j.in.len = j.in.filePos = 0;
+  j.in.eof = false;
+  j.restart = 0;
+  j.nComp = 0;
+  for (i = 0; i < 4; i++)
+    j.huff[i].symbols = 0; // Marks table undefined
+
+  if ((readByte(j.in) != 0xFF) || (readByte(j.in) != 0xD8)) // SOI marker
+    return IMAGE_ERR_FORMAT;
+
+  for (;;) {
+    if (readByte(j.in) != 0xFF)
+      return IMAGE_ERR_FORMAT;
+    while ((m = readByte(j.in)) == 0xFF) // Fill bytes
+      ;
+    len = jpegWord(j);
+    if (j.in.eof || (len < 2))
+      return IMAGE_ERR_FORMAT;
+    len -= 2;
+    if ((m == 0xC0) || (m == 0xC1)) { // SOF0, SOF1: baseline/extended
+      if ((len < 6) || (readByte(j.in) != 8)) // 8-bit samples only
+        return IMAGE_ERR_FORMAT;
+      j.height = jpegWord(j);
+      j.width = jpegWord(j);
+      n = readByte(j.in);
+      if (!j.width || !j.height || ((n != 1) && (n != 3)) ||
+          (len != 6 + n * 3)) // (Height 0 = DNL marker, unsupported)
+        return IMAGE_ERR_FORMAT;
+      if (dimsOnly)
+        return IMAGE_SUCCESS;
+      j.nComp = n;
+      j.hMax = j.vMax = 1;
+      for (i = 0; i < n; i++) {
+        j.comp[i].id = readByte(j.in);
+        k = readByte(j.in);
+        j.comp[i].h = (n == 1) ? 1 : (k >> 4); // Grayscale: 1 block/MCU
+        j.comp[i].v = (n == 1) ? 1 : (k & 15);
+        j.comp[i].tq = readByte(j.in);
+        if ((j.comp[i].h < 1) || (j.comp[i].h > 2) || (j.comp[i].v < 1) ||
+            (j.comp[i].v > 2) || (j.comp[i].tq > 3))
+          return IMAGE_ERR_FORMAT;
+        j.hMax = max(j.hMax, j.comp[i].h);
+        j.vMax = max(j.vMax, j.comp[i].v);
+      }
+      frame = true;
+    } else if (((m >= 0xC2) && (m <= 0xCF) && (m != 0xC4) && (m != 0xC8) &&
+                (m != 0xCC)) ||
+               (m == 0xD9)) {
+      // Progressive, lossless, arithmetic coding, or EOI before image
+      return IMAGE_ERR_FORMAT;
+    } else if (dimsOnly || ((m != 0xC4) && (m != 0xDB) && (m != 0xDD) &&
+                            (m != 0xDA))) {
+      // APPn, COM, etc. (or any segment, if only after dimensions): skip,
+      // seeking if it's not all in the read buffer (e.g. EXIF thumbnail)
+      skipBytes(j.in, len);
+    } else if (m == 0xC4) { // DHT: one or more Huffman tables
+      while (len >= 17) {
+        k = readByte(j.in);
+        if (((k >> 4) > 1) || ((k & 15) > 1))
+          return IMAGE_ERR_FORMAT;
+        JPEGHuffman *h = &j.huff[(k >> 4) * 2 + (k & 15)];
+        uint8_t count[16];
+        uint32_t code = 0, total = 0;
+        for (i = 0; i < 16; i++)
+          total += count[i] = readByte(j.in);
+        if ((total > sizeof h->symbol) || (total + 17 > len))
+          return IMAGE_ERR_FORMAT;
+        for (i = 0; i < total; i++)
+          h->symbol[i] = readByte(j.in);
+        // Canonical codes: each length's codes follow on from the last
+        // length's, shifted left one bit.
+        for (i = 0, n = 0; i < 16; i++) {
+          h->delta[i + 1] = n - code;
+          code += count[i];
+          n += count[i];
+          if (code > (1UL << (i + 1))) // Too many codes for length
+            return IMAGE_ERR_FORMAT;
+          h->limit[i + 1] = code << (15 - i);
+          code <<= 1;
+        }
+        h->limit[17] = 0xFFFFFFFF; // Stops search
+        h->symbols = total;
+        len -= 17 + total;
+      }
+      if (len)
+        return IMAGE_ERR_FORMAT;
+    } else if (m == 0xDB) { // DQT: one or more quantization tables
+      while (len >= 65) {
+        k = readByte(j.in);
+        if (((k >> 4) > 1) || ((k & 15) > 3) || (len < 65 + (k >> 4) * 64))
+          return IMAGE_ERR_FORMAT;
+        for (i = 0; i < 64; i++)
+          j.quant[k & 15][i] = (k >> 4) ? jpegWord(j) : readByte(j.in);
+        len -= 65 + (k >> 4) * 64;
+      }
+      if (len)
+        return IMAGE_ERR_FORMAT;
+    } else if (m == 0xDD) { // DRI: restart interval
+      if (len != 2)
+        return IMAGE_ERR_FORMAT;
+      j.restart = jpegWord(j);
+    } else { // SOS: start of scan, image data follows
+      n = readByte(j.in);
+      // One scan holding all components is the only baseline layout
+      // supported (multi-scan baseline files are very rare).
+      if (!frame || (n != j.nComp) || (len != 4 + n * 2))
+        return IMAGE_ERR_FORMAT;
+      for (i = 0; i < n; i++) {
+        uint8_t id = readByte(j.in);
+        k = readByte(j.in);
+        if ((j.comp[i].id != id) || ((k >> 4) > 1) || ((k & 15) > 1) ||
+            !j.huff[k >> 4].symbols || !j.huff[2 + (k & 15)].symbols)
+          return IMAGE_ERR_FORMAT;
+        j.comp[i].td = k >> 4;
+        j.comp[i].ta = 2 + (k & 15);
+        j.comp[i].pred = 0;
+      }
+      if ((readByte(j.in) != 0) || (readByte(j.in) != 63) || readByte(j.in))
+        return IMAGE_ERR_FORMAT; // Spectral selection: not sequential
+      j.bits = 0;
+      j.nBits = 0;
+      j.marker = 0;
+      return j.in.eof ? IMAGE_ERR_FORMAT : IMAGE_SUCCESS;
+    }
+    if (j.in.eof)
+      return IMAGE_ERR_FORMAT;
+  }
+}
+
+/*!
+    @brief   Decodes one Huffman-coded symbol from JPEG image data.
+    @param   j
+             JPEG decoder state.
+    @param   h
+             Huffman table.
+    @return  Symbol value (0-255), or -1 if data is invalid.
+*/
+int16_t Adafruit_ImageReader::jpegHuff(JPEGDecoder &j, const JPEGHuffman &h) {
+  uint8_t len;
+  jpegFill(j);
+  uint32_t look = j.bits >> 16; // Next 16 bits
+  for (len = 1; look >= h.limit[len]; len++)
+    ;
+  if (len > 16)
+    return -1;
+  int32_t i = (int32_t)(look >> (16 - len)) + h.delta[len];
+  if ((i < 0) || (i >= h.symbols))
+    return -1;
+  j.bits <<= len;
+  j.nBits -= len;
+  return h.symbol[i];
+}
+
+// Limit value to +/- 'lim'. Coefficients and IDCT intermediates of valid
+// JPEG data are well inside the limits used; this keeps corrupt data from
+// overflowing 32-bit math.
+static inline int32_t jpegLimit(int32_t v, int32_t lim) {
+  return (v > lim) ? lim : (v < -lim) ? -lim : v;
+}
+
+/*!
+    @brief   Decodes and dequantizes one 8x8 block of JPEG image data.
+    @param   j
+             JPEG decoder state.
+    @param   c
+             Image component index.
+    @param   coef
+             64 coefficients, natural order, returned. Only the top-left
+             n x n are filled in (the rest are undefined).
+    @param   n
+             Size of top-left area of coefficients wanted (1, 2, 4 or 8).
+    @return  Number of the last nonzero coefficient in zigzag order (0 if
+             DC only, else 1-63) within the n x n area, or -1 if data is
+             invalid.
+*/
+int8_t Adafruit_ImageReader::jpegBlock(JPEGDecoder &j, uint8_t c,
+                                       int16_t *coef, uint8_t n) {
+  const uint16_t *q = j.quant[j.comp[c].tq];
+  int16_t s;
+  int8_t last = 0;
+  uint8_t k, z;
+  int32_t v;
+
+  for (k = 0; k < n; k++) // Clear wanted area (row by row)
+    memset(&coef[k * 8], 0, n * sizeof(int16_t));
+
+  // DC coefficient: difference from last block's
+  if ((s = jpegHuff(j, j.huff[j.comp[c].td])) < 0 || (s > 11))
+    return -1;
+  jpegFill(j);
+  v = jpegLimit(j.comp[c].pred + jpegExtend(jpegBits(j, s), s), 32767);
+  j.comp[c].pred = v;
+  coef[0] = jpegLimit(v * q[0], 8191);
+
+  // AC coefficients: run of zeros, then value
+  for (k = 1; k < 64; k++) {
+    if ((s = jpegHuff(j, j.huff[j.comp[c].ta])) < 0)
+      return -1;
+    if (!(s & 15)) {
+      if (s != 0xF0) // End of block
+        break;
+      k += 15; // 16 zeros
+      continue;
+    }
+    k += s >> 4; // Zeros
+    s &= 15;
+    if ((k > 63) || (s > 10))
+      return -1;
+    jpegFill(j);
+    v = jpegExtend(jpegBits(j, s), s);
+    z = jpegZigzag[k];
+    if (((z & 7) < n) && ((z >> 3) < n)) {
+      coef[z] = jpegLimit(v * q[k], 8191);
+      last = k;
+    }
+  }
+  return (k > 64) ? -1 : last; // (16 zeros overran block?)
+}
+
+// Clamp IDCT output to 8-bit sample
+static inline uint8_t jpegClamp(int32_t v) {
+  return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+// One 8-point 1-D inverse DCT (islow integer algorithm of the IJG JPEG
+// library, constants * 4096). Outputs are (x0 + t3, x1 + t2, x2 + t1,
+// x3 + t0, x3 - t0, x2 - t1, x1 - t2, x0 - t3), to be descaled.
+#define JPEG_IDCT_1D(s0, s1, s2, s3, s4, s5, s6, s7)                         \
+  int32_t t0, t1, t2, t3, p1, p2, p3, p4, p5, x0, x1, x2, x3;                \
+  p2 = s2;                                                                   \
+  p3 = s6;                                                                   \
+  p1 = (p2 + p3) * 2217;                                                     \
+  t2 = p1 + p3 * -7567;                                                      \
+  t3 = p1 + p2 * 3135;                                                       \
+  t0 = ((int32_t)(s0) + (s4)) * 4096;                                        \
+  t1 = ((int32_t)(s0) - (s4)) * 4096;                                        \
+  x0 = t0 + t3;                                                              \
+  x3 = t0 - t3;                                                              \
+  x1 = t1 + t2;                                                              \
+  x2 = t1 - t2;                                                              \
+  t0 = s7;                                                                   \
+  t1 = s5;                                                                   \
+  t2 = s3;                                                                   \
+  t3 = s1;                                                                   \
+  p3 = t0 + t2;                                                              \
+  p4 = t1 + t3;                                                              \
+  p1 = t0 + t3;                                                              \
+  p2 = t1 + t2;                                                              \
+  p5 = (p3 + p4) * 4816;                                                     \
+  t0 = t0 * 1223;                                                            \
+  t1 = t1 * 8410;                                                            \
+  t2 = t2 * 12586;                                                           \
+  t3 = t3 * 6149;                                                            \
+  p1 = p5 + p1 * -3685;                                                      \
+  p2 = p5 + p2 * -10497;                                                     \
+  p3 = p3 * -8034;                                                           \
+  p4 = p4 * -1597;                                                           \
+  t3 += p1 + p4;                                                             \
+  t2 += p2 + p3;                                                             \
+  t1 += p2 + p4;                                                             \
+  t0 += p1 + p3;
+
+#if !defined(__AVR__) // Only coreJPEG() calls this, and not on AVR
+/*!
+    @brief   Inverse DCT of one block of JPEG coefficients to 8-bit samples,
+             full size (8x8) or reduced (4x4, 2x2 or 1x1).
+    @param   coef
+             64 dequantized coefficients, natural order (only top-left n x n
+             used); contents are overwritten.
+    @param   out
+             Output samples, n x n, row-major.
+    @param   n
+             Output size (8, 4, 2 or 1).
+    @param   last
+             Index (zigzag order) of last nonzero coefficient, as returned
+             by jpegBlock(). 0 = DC only, the common case for smooth areas,
+             which is a flat fill.
+    @return  None (void).
+*/
+static void jpegIDCT(int16_t *coef, uint8_t *out, uint8_t n, int8_t last) {
+  uint8_t i, x, y;
+
+  if (!last) { // DC only, all samples the same
+    memset(out, jpegClamp(((coef[0] + 4) >> 3) + 128), n * n);
+    return;
+  }
+  if (n == 8) {
+    int32_t v[64]; // Intermediate, * 4 (2 extra bits of precision)
+    for (i = 0; i < 8; i++) { // Columns
+      int16_t *d = &coef[i];
+      if (!(d[8] | d[16] | d[24] | d[32] | d[40] | d[48] | d[56])) {
+        // No AC in this column, all outputs the same
+        v[i] = v[i + 8] = v[i + 16] = v[i + 24] = v[i + 32] = v[i + 40] =
+            v[i + 48] = v[i + 56] = d[0] * 4;
+      } else {
+        JPEG_IDCT_1D(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56])
+        x0 += 512; // Round, descale * 4096 to * 4
+        x1 += 512;
+        x2 += 512;
+        x3 += 512;
+        v[i] = jpegLimit((x0 + t3) >> 10, 16383);
+        v[i + 56] = jpegLimit((x0 - t3) >> 10, 16383);
+        v[i + 8] = jpegLimit((x1 + t2) >> 10, 16383);
+        v[i + 48] = jpegLimit((x1 - t2) >> 10, 16383);
+        v[i + 16] = jpegLimit((x2 + t1) >> 10, 16383);
+        v[i + 40] = jpegLimit((x2 - t1) >> 10, 16383);
+        v[i + 24] = jpegLimit((x3 + t0) >> 10, 16383);
+        v[i + 32] = jpegLimit((x3 - t0) >> 10, 16383);
+      }
+    }
+    for (i = 0; i < 8; i++, out += 8) { // Rows
+      int32_t *d = &v[i * 8];
+      JPEG_IDCT_1D(d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7])
+      // Descale (4096 * 4 * 8, the 8 from the DCT's normalization),
+      // round and add 128 (samples are centered on zero)
+      x0 += 65536 + (128 << 17);
+      x1 += 65536 + (128 << 17);
+      x2 += 65536 + (128 << 17);
+      x3 += 65536 + (128 << 17);
+      out[0] = jpegClamp((x0 + t3) >> 17);
+      out[7] = jpegClamp((x0 - t3) >> 17);
+      out[1] = jpegClamp((x1 + t2) >> 17);
+      out[6] = jpegClamp((x1 - t2) >> 17);
+      out[2] = jpegClamp((x2 + t1) >> 17);
+      out[5] = jpegClamp((x2 - t1) >> 17);
+      out[3] = jpegClamp((x3 + t0) >> 17);
+      out[4] = jpegClamp((x3 - t0) >> 17);
+    }
+  } else { // 4x4 or 2x2 (1x1 is always DC only), matrix products
+    const int16_t *m = (n == 4) ? &jpegIDCT4[0][0] : &jpegIDCT2[0][0];
+    int32_t v[16], s; // Intermediate, * 4
+    for (x = 0; x < n; x++) { // Columns
+      for (y = 0; y < n; y++) {
+        for (s = 512, i = 0; i < n; i++)
+          s += m[y * n + i] * coef[i * 8 + x];
+        v[y * n + x] = s >> 10;
+      }
+    }
+    for (y = 0; y < n; y++) { // Rows
+      for (x = 0; x < n; x++) {
+        for (s = (1 << 13) + (128 << 14), i = 0; i < n; i++)
+          s += m[x * n + i] * v[y * n + i];
+        *out++ = jpegClamp(s >> 14);
+      }
+    }
+  }
+}
+#endif // !__AVR__
+
+/*!
+    @brief   JPEG-reading function common to the draw function (to TFT) and
+             load function (to canvas in RAM). MCUs (minimum coded units,
+             8x8 to 16x16 pixels, or smaller if scaled) are decoded into a
+             strip buffer holding as many side by side as fit. Each strip is
+             converted to 565 into the same working buffers drawBMP() uses
+             and written through its own TFT address window (or copied into
+             the canvas). MCUs off screen are entropy-decoded (unavoidable,
+             each depends on the last) but not transformed or converted, and
+             decoding stops after the last visible MCU row.
+    @param   filename
+             Name of JPEG image file to load.
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+    @param   dest
+             Working buffer for loading 16-bit TFT pixel data, if loading to
+             screen, else NULL.
+    @param   x
+             Horizontal offset in pixels (if loading to screen).
+    @param   y
+             Vertical offset in pixels (if loading to screen).
+    @param   img
+             Pointer to Adafruit_Image object, if loading to RAM (or NULL
+             if loading to screen).
+    @param   scale
+             Image reduction as a power of two (0-3).
+    @param   transact
+             Use SPI transactions; 'true' is needed only if loading to screen
+             and it's on the same SPI bus as the SD card.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::coreJPEG(const char *filename,
+                                               Adafruit_SPITFT *tft,
+                                               uint16_t *dest, int16_t x,
+                                               int16_t y, Adafruit_Image *img,
+                                               uint8_t scale,
+                                               boolean transact) {
+#if defined(__AVR__)
+  // Decoder tables alone are about as large as all of an AVR's RAM
+  (void)filename;
+  (void)tft;
+  (void)dest;
+  (void)x;
+  (void)y;
+  (void)img;
+  (void)scale;
+  (void)transact;
+  return IMAGE_ERR_MALLOC;
+#else
+  ImageReturnCode status;
+  JPEGDecoder *dec;                // Tables, decoding state & MCU samples
+  uint8_t localbuf[3 * BUFPIXELS]; // Default file read buf
+  uint8_t *sdbuf = localbuf;       // File read buf
+  uint32_t sdbufSize = sizeof localbuf;
+  uint32_t destSize = BUFPIXELS; // Size of each dest buf, pixels
+  uint32_t destidx = 0;          // Pixels in dest
+  uint16_t *destAlt = NULL;      // Alternate TFT buffer (non-blocking writes)
+  uint16_t *canvas = NULL;       // Canvas pixels, if loading to RAM
+  uint8_t n;                     // Block size after scaling (8, 4, 2, 1)
+  uint8_t blocks;                // Blocks per MCU (1 to 6)
+  uint16_t mcuBytes;             // Bytes of samples per MCU in strip
+  uint8_t compOfs[3];            // Offset of each component in MCU (/ n^2)
+  uint8_t colOfs[3][16];         // Sample offset per pixel column in MCU
+  uint16_t rowOfs[3];            // Sample offset for pixel row in MCU
+  uint8_t mcuW, mcuH;            // MCU size in pixels (after scaling)
+  uint16_t mcusX, mcusY;         // MCUs across & down image
+  uint16_t stripMCUs;            // MCUs per strip
+  uint16_t mx, my, k, i;         // MCU column & row, loop counters
+  uint16_t todo = 0;             // MCUs left before restart marker
+  int32_t imgWidth, imgHeight;   // Image size in pixels (after scaling)
+  int32_t loadWidth, loadHeight, // Region being loaded (clipped)
+      loadX = 0, loadY = 0;      // "
+  int32_t sx0, sx1, sy0, sy1;    // Visible part of strip, image coords
+  uint8_t c, bx, by, px, py;     // Component, block, pixel
+  int8_t last;                   // Last nonzero coefficient in block
+  uint32_t startTime = 0;        // Timing for stats
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  if (img)
+    img->dealloc();
+
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default file read buffer and (if drawing to TFT) dest buffers.
+  splitBuffer(tft ? DESTBUFS : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+#if DESTBUFS > 1
+  if (tft)
+    destAlt = &dest[destSize];
+#endif
+
+  if (tft && ((x >= tft->width()) || (y >= tft->height())))
+    return IMAGE_SUCCESS;
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+
+  if (!(dec = (JPEGDecoder *)malloc(sizeof(JPEGDecoder)))) {
+    file.close();
+    return IMAGE_ERR_MALLOC;
+  }
+  JPEGDecoder &j = *dec;
+  j.in.buf = sdbuf;
+  j.in.bufSize = sdbufSize;
+  j.in.tft = NULL;
+  j.in.transact = transact;
+  if ((status = jpegHeader(j, false)) != IMAGE_SUCCESS) {
+    free(dec);
+    file.close();
+    return status;
+  }
+
+  if (scale > 3)
+    scale = 3;
+  n = 8 >> scale;
+  imgWidth = (j.width + (1 << scale) - 1) >> scale;
+  imgHeight = (j.height + (1 << scale) - 1) >> scale;
+  mcuW = j.hMax * n;
+  mcuH = j.vMax * n;
+  mcusX = (j.width + j.hMax * 8 - 1) / (j.hMax * 8);
+  mcusY = (j.height + j.vMax * 8 - 1) / (j.vMax * 8);
+  for (blocks = c = 0; c < j.nComp; c++) {
+    compOfs[c] = blocks;
+    blocks += j.comp[c].h * j.comp[c].v;
+  }
+  mcuBytes = blocks * n * n;
+  stripMCUs = min((uint16_t)(sizeof j.strip / mcuBytes), mcusX);
+  if (blocks > 10) // Limit in JPEG spec, and what j.strip[] is sized for
+    status = IMAGE_ERR_FORMAT;
+
+  loadWidth = imgWidth;
+  loadHeight = imgHeight;
+  if (tft) {
+    // Crop area to be loaded (if destination is TFT)
+    if (x < 0) {
+      loadX = -x;
+      loadWidth += x;
+      x = 0;
+    }
+    if (y < 0) {
+      loadY = -y;
+      loadHeight += y;
+      y = 0;
+    }
+    if ((x + loadWidth) > tft->width())
+      loadWidth = tft->width() - x;
+    if ((y + loadHeight) > tft->height())
+      loadHeight = tft->height() - y;
+  } else if (status == IMAGE_SUCCESS) {
+    status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+    if ((img->canvas.canvas16 = new GFXcanvas16(imgWidth, imgHeight))) {
+      if ((canvas = img->canvas.canvas16->getBuffer())) {
+        status = IMAGE_SUCCESS;
+      } else {
+        delete img->canvas.canvas16;
+        img->canvas.canvas16 = NULL;
+      }
+    }
+  }
+
+  if ((status == IMAGE_SUCCESS) && (loadWidth > 0) && (loadHeight > 0)) {
+    if (stats)
+      stats->headerTime = micros() - startTime;
+    if (tft) {
+      tft->startWrite(); // Start SPI (regardless of transact)
+      j.in.tft = tft;    // Reads end & restart the transaction if needed
+    }
+
+    for (my = 0; my < mcusY; my++) {
+      if (my * mcuH >= loadY + loadHeight)
+        break; // Rest is below visible area
+      sy0 = max((int32_t)my * mcuH, loadY);
+      sy1 = min((int32_t)(my + 1) * mcuH, loadY + loadHeight);
+      for (mx = 0; mx < mcusX; mx += stripMCUs) {
+        uint16_t count = min(stripMCUs, (uint16_t)(mcusX - mx));
+        sx0 = max((int32_t)mx * mcuW, loadX);
+        sx1 = min((int32_t)(mx + count) * mcuW, loadX + loadWidth);
+        for (k = 0; k < count; k++) {
+          if (j.restart) { // Restart marker every j.restart MCUs
+            if (!todo && (my || mx || k)) {
+              // Discard leftover bits, expect RSTn marker next
+              j.bits = 0;
+              j.nBits = 0;
+              while (!j.marker && !j.in.eof) { // Not reached yet, find it
+                uint8_t b;
+                if (readByte(j.in) != 0xFF)
+                  continue;
+                while ((b = readByte(j.in)) == 0xFF) // Fill bytes
+                  ;
+                j.marker = b; // (0 if stuffed 0xFF00 data byte)
+              }
+              if ((j.marker & 0xF8) != 0xD0) {
+                status = IMAGE_ERR_FORMAT;
+                break;
+              }
+              j.marker = 0;
+              for (c = 0; c < j.nComp; c++)
+                j.comp[c].pred = 0;
+            }
+            if (!todo)
+              todo = j.restart;
+            todo--;
+          }
+          // Transform only MCUs with pixels in the visible area
+          boolean visible = (sy1 > sy0) &&
+                            ((int32_t)(mx + k + 1) * mcuW > sx0) &&
+                            ((int32_t)(mx + k) * mcuW < sx1);
+          uint8_t *s = &j.strip[k * mcuBytes];
+          for (c = 0; c < j.nComp; c++) {
+            for (i = j.comp[c].h * j.comp[c].v; i--; s += n * n) {
+              if ((last = jpegBlock(j, c, j.coef, n)) < 0) {
+                status = IMAGE_ERR_FORMAT;
+                break;
+              }
+              if (visible)
+                jpegIDCT(j.coef, s, n, last);
+            }
+            if (status != IMAGE_SUCCESS)
+              break;
+          }
+          if ((status != IMAGE_SUCCESS) || j.in.eof) {
+            status = IMAGE_ERR_FORMAT; // Bad or truncated data
+            break;
+          }
+        }
+        if (status != IMAGE_SUCCESS)
+          break;
+        if ((sx1 <= sx0) || (sy1 <= sy0))
+          continue; // Strip not visible
+
+        // Convert visible part of strip to 565, row by row
+        if (tft) {
+          tft->dmaWait(); // Last strip's pixels out before moving window
+          tft->setAddrWindow(x + sx0 - loadX, y + sy0 - loadY, sx1 - sx0,
+                             sy1 - sy0);
+        }
+        // Position in MCU of each component's sample for each pixel
+        // column (replicated if subsampled), and for this pixel row
+        for (c = 0; c < j.nComp; c++) {
+          for (px = 0; px < mcuW; px++) {
+            uint8_t cx = px * j.comp[c].h / j.hMax;
+            bx = cx / n;
+            colOfs[c][px] = bx * n * n + cx - bx * n;
+          }
+        }
+        for (int32_t row = sy0; row < sy1; row++) {
+          uint16_t *out = tft ? NULL : &canvas[row * imgWidth + sx0];
+          py = row - my * mcuH;
+          for (c = 0; c < j.nComp; c++) {
+            uint8_t cy = py * j.comp[c].v / j.vMax;
+            by = cy / n;
+            rowOfs[c] = (compOfs[c] + by * j.comp[c].h) * n * n +
+                        (cy - by * n) * n;
+          }
+          k = (sx0 - mx * mcuW) / mcuW;      // MCU in strip
+          px = (sx0 - mx * mcuW) - k * mcuW; // Pixel in MCU
+          const uint8_t *m = &j.strip[k * mcuBytes];
+          for (int32_t col = sx0; col < sx1; col++) {
+            uint16_t rgb;
+            uint8_t sample[3];
+            for (c = 0; c < j.nComp; c++)
+              sample[c] = m[rowOfs[c] + colOfs[c][px]];
+            if (++px >= mcuW) { // Next MCU
+              px = 0;
+              m += mcuBytes;
+            }
+            if (j.nComp == 1) {
+              rgb = ((sample[0] & 0xF8) << 8) | ((sample[0] & 0xFC) << 3) |
+                    (sample[0] >> 3);
+            } else {
+              // YCbCr to RGB (JFIF), constants * 65536
+              int32_t cb = sample[1] - 128, cr = sample[2] - 128;
+              uint8_t r = jpegClamp(sample[0] + ((91881 * cr + 32768) >> 16));
+              uint8_t g = jpegClamp(
+                  sample[0] + ((-22554 * cb - 46802 * cr + 32768) >> 16));
+              uint8_t b =
+                  jpegClamp(sample[0] + ((116130 * cb + 32768) >> 16));
+              rgb = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            }
+            if (tft) {
+              dest[destidx++] = TFT_BIGENDIAN ? ((rgb >> 8) | (rgb << 8)) : rgb;
+              if (destidx >= destSize) {
+                writeDest(tft, dest, destAlt, destidx);
+                destidx = 0;
+              }
+            } else {
+              *out++ = rgb;
+            }
+          }
+        }
+        if (destidx) {
+          writeDest(tft, dest, destAlt, destidx);
+          destidx = 0;
+        }
+      }
+      if (status != IMAGE_SUCCESS)
+        break;
+    }
+
+    if (tft) {
+      tft->dmaWait();  // Wait for last non-blocking write
+      tft->endWrite(); // End TFT (regardless of transact)
+    }
+    if (stats && (status == IMAGE_SUCCESS))
+      stats->pixels = (uint32_t)loadWidth * loadHeight;
+  }
+
+  if (img) {
+    if (status == IMAGE_SUCCESS) {
+      img->format = IMAGE_16;
+    } else if (img->canvas.canvas16) {
+      delete img->canvas.canvas16;
+      img->canvas.canvas16 = NULL;
+    }
+  }
+  free(dec);
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+#endif // !__AVR__
+}
+
+// PNG decoding (ISO/IEC 15948): all color types and bit depths, but not
+// interlaced. The zlib stream in the IDAT chunks is inflated (RFC 1951)
+// one scanline at a time, keeping only as much history as the stream
+// says it may refer back to (32 KB at most, less for small images), and
+// each scanline is unfiltered and converted to 565 as it arrives. Chunk
+// CRCs and the zlib checksum are not verified.
+
+#define PNG_FAST 9  ///< Code bits resolved by one table lookup in pngHuff()
+#define PNG_PAD 8   ///< Zero bytes ahead of each scanline, see pngUnfilter()
+#define PNG_SPAN 64 ///< Pixels per conversion through PNGDecoder::bgra
+
+// Inflate block state
+enum { PNG_BLOCK_HEADER, PNG_BLOCK_STORED, PNG_BLOCK_CODES };
+
+// Start of every PNG: signature, then IHDR chunk length and type
+static const uint8_t pngMagic[16] = {0x89, 'P', 'N', 'G', 13,  10,  26,  10,
+                                     0,    0,   0,   13,  'I', 'H', 'D', 'R'};
+
+// Base values & extra bits of inflate length and distance codes
+static const uint16_t pngLenBase[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t pngLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                        1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                        4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t pngDistBase[30] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,
+    97,  129, 193, 257, 385, 513,  769,  1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577};
+static const uint8_t pngDistExtra[30] = {0, 0, 0,  0,  1,  1,  2,  2,  3,  3,
+                                         4, 4, 5,  5,  6,  6,  7,  7,  8,  8,
+                                         9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order of code length code lengths in a dynamic block header
+static const uint8_t pngLenOrder[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                        11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+/*!
+    @brief   Huffman table in decoding form. Codes of up to PNG_FAST bits
+             are found with one lookup; longer ones by stepping through
+             the canonical code ranges one bit at a time.
+*/
+struct PNGHuffman {
+  uint16_t count[16];           ///< Number of codes of each length
+  uint16_t symbol[288];         ///< Symbols in code order
+  uint16_t fast[1 << PNG_FAST]; ///< By next PNG_FAST bits of input: code
+                                ///< length << 12 | symbol, 0 if longer
+};
+
+/*!
+    @brief   Working state of PNG decoder: image header, palette, and the
+             position in the compressed data.
+*/
+struct PNGDecoder {
+  ImageInput in;              ///< File input
+  PNGHuffman lit;             ///< Literal/length codes of current block
+  PNGHuffman dist;            ///< Distance codes of current block
+  uint8_t palette[256 * 4];   ///< Palette (or gray levels), B,G,R,A
+  uint8_t bgra[PNG_SPAN * 4]; ///< Pixels being converted, B,G,R,A
+  uint32_t width;             ///< Image width in pixels
+  uint32_t height;            ///< Image height in pixels
+  uint8_t depth;              ///< Bits per sample (1, 2, 4, 8, 16)
+  uint8_t color;              ///< Color type (0, 2, 3, 4, 6)
+  uint8_t channels;           ///< Samples per pixel (1 to 4)
+  boolean alpha;              ///< Has alpha channel or tRNS chunk
+  boolean keyed;              ///< tRNS gives a transparent gray/RGB value
+  uint16_t key[3];            ///< Transparent gray or R,G,B value
+  uint8_t windowBits;         ///< log2 of zlib window size
+  uint8_t *window;            ///< Recent output, for matches to copy from
+  uint32_t windowMask;        ///< Window size (a power of 2) - 1
+  uint32_t out;               ///< Bytes inflated so far
+  uint32_t chunk;             ///< Bytes left in current IDAT chunk
+  boolean idatEnd;            ///< Last IDAT chunk has been read
+  uint32_t over;              ///< Zero bytes supplied past end of data
+  uint32_t bits;              ///< Compressed bits, first in LSB
+  uint8_t nBits;              ///< Number of valid bits in 'bits'
+  uint8_t block;              ///< Inflate block state, PNG_BLOCK_*
+  boolean last;               ///< Current block is the final one
+  uint16_t stored;            ///< Bytes left in stored block
+  uint16_t copy;              ///< Bytes left to copy of a match
+  uint16_t distance;          ///< Distance back of match
+};
+
+/*!
+    @brief   Draws a PNG image file from SD card to SPITFT screen. Palette,
+             grayscale, RGB and RGBA PNGs (with or without a tRNS chunk)
+             at any bit depth are supported, but not interlaced ones. Rows
+             are inflated, unfiltered and converted one at a time, so the
+             working memory is the compression window (32 KB at most; it's
+             sized to the file's zlib header, and smaller images need
+             less) plus two rows and about 5 KB of tables. Alpha is handled
+             as for 32-bit BMPs, see setAlpha().
+    @param   filename
+             Name of PNG image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure). Interlaced PNGs return
+             IMAGE_ERR_FORMAT.
+*/
+ImageReturnCode Adafruit_ImageReader::drawPNG(const char *filename,
+                                              Adafruit_SPITFT &tft, int16_t x,
+                                              int16_t y, boolean transact) {
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
+  return corePNG(filename, &tft, tftbuf, x, y, NULL, transact);
+}
+
+/*!
+    @brief   Loads a PNG image file from SD card into RAM. Palette and
+             grayscale PNGs of up to 8 bits become a GFXcanvas8 (IMAGE_8)
+             Adafruit_Image with 565 palette, others a GFXcanvas16
+             (IMAGE_16). With IMAGE_ALPHA_MASK (see setAlpha()), images
+             with transparency are always IMAGE_16, with a 1-bit mask.
+    @param   filename
+             Name of PNG image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadPNG(const char *filename,
+                                              Adafruit_Image &img) {
+  return corePNG(filename, NULL, NULL, 0, 0, &img, false);
+}
+
+/*!
+    @brief   Query pixel dimensions of PNG image file on SD card.
+    @param   filename
+             Name of PNG image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::pngDimensions(const char *filename,
+                                                    int32_t *width,
+                                                    int32_t *height) {
+  ImageReturnCode status = IMAGE_ERR_FORMAT;
+  uint8_t header[24]; // Signature, IHDR length & type, width, height
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if ((readData(header, sizeof header) == (int)sizeof header) &&
+      !memcmp(header, pngMagic, sizeof pngMagic)) {
+    uint32_t w = ((uint32_t)header[16] << 24) | ((uint32_t)header[17] << 16) |
+                 (header[18] << 8) | header[19];
+    uint32_t h = ((uint32_t)header[20] << 24) | ((uint32_t)header[21] << 16) |
+                 (header[22] << 8) | header[23];
+    if (w && h && (w <= 65535) && (h <= 65535)) {
+      if (width)
+        *width = w;
+      if (height)
+        *height = h;
+      status = IMAGE_SUCCESS;
+    }
+  }
+  file.close();
+  return status;
+}
+
+/*!
+    @brief   Parses PNG file header and the chunks ahead of the image data
+             (palette and transparency), up to and including the zlib
+             header at the start of the first IDAT chunk.
+    @param   p
+             PNG decoder state; p.in must be set up, the rest is
+             initialized here.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::pngHeader(PNGDecoder &p) {
+  uint8_t i, compression, filter, interlace, cmf, flg;
+  uint16_t colors = 0; // Palette entries (PLTE chunk)
+  uint32_t len, type;
+
+  p.in.pos = p.in.len = p.in.filePos = 0;
+  p.in.eof = false;
+  for (i = 0; i < sizeof pngMagic; i++) {
+    if (readByte(p.in) != pngMagic[i])
+      return IMAGE_ERR_FORMAT;
+  }
+  p.width = readBE32(p.in);
+  p.height = readBE32(p.in);
+  p.depth = readByte(p.in);
+  p.color = readByte(p.in);
+  compression = readByte(p.in);
+  filter = readByte(p.in);
+  interlace = readByte(p.in);
+  skipBytes(p.in, 4); // CRC
+  // Bit depths allowed for each color type
+  static const uint8_t depths[7] = {0x1F, 0, 0x18, 0x0F, 0x18, 0, 0x18};
+  if (!p.width || !p.height || (p.width > 65535) || (p.height > 65535) ||
+      (p.color > 6) || (p.depth & (p.depth - 1)) || (p.depth > 16) ||
+      !(depths[p.color] & p.depth) || compression || filter || interlace)
+    return IMAGE_ERR_FORMAT; // Also if interlaced (Adam7)
+  static const uint8_t channels[7] = {1, 0, 3, 1, 2, 0, 4};
+  p.channels = channels[p.color];
+  p.alpha = (p.color == 4) || (p.color == 6);
+  p.keyed = false;
+
+  // Gray levels up to 8 bits are handled like a palette
+  for (uint16_t c = 0; c < 256; c++) {
+    uint8_t v = 0;
+    if (!p.color && (c < (1 << p.depth)))
+      v = c * 255 / ((1 << p.depth) - 1);
+    p.palette[c * 4] = p.palette[c * 4 + 1] = p.palette[c * 4 + 2] = v;
+    p.palette[c * 4 + 3] = 255;
+  }
+
+  for (;;) {
+    len = readBE32(p.in);
+    type = readBE32(p.in);
+    if (p.in.eof || (len > 0x7FFFFFFF))
+      return IMAGE_ERR_FORMAT;
+    if (type == 0x49444154) { // IDAT
+      if ((p.color == 3) && !colors)
+        return IMAGE_ERR_FORMAT; // Palette is required
+      break;
+    } else if (type == 0x49454E44) { // IEND before any image data
+      return IMAGE_ERR_FORMAT;
+    } else if ((type == 0x504C5445) && (p.color == 3)) { // PLTE
+      colors = len / 3;
+      if ((len % 3) || !colors || (colors > (1 << p.depth)))
+        return IMAGE_ERR_FORMAT;
+      for (uint16_t c = 0; c < colors; c++) {
+        p.palette[c * 4 + 2] = readByte(p.in); // R, G, B
+        p.palette[c * 4 + 1] = readByte(p.in);
+        p.palette[c * 4] = readByte(p.in);
+      }
+    } else if (type == 0x74524E53) { // tRNS
+      if ((p.color == 3) && (len <= colors)) { // Alpha of palette entries
+        for (uint16_t c = 0; c < len; c++)
+          p.palette[c * 4 + 3] = readByte(p.in);
+        p.alpha = true;
+      } else if (((p.color == 0) && (len == 2)) ||
+                 ((p.color == 2) && (len == 6))) { // Transparent color
+        for (i = 0; i < len / 2; i++) {
+          p.key[i] = readByte(p.in) << 8;
+          p.key[i] |= readByte(p.in);
+        }
+        if ((p.color == 0) && (p.depth <= 8)) {
+          if (p.key[0] < (1 << p.depth)) // Else matches no pixel
+            p.palette[p.key[0] * 4 + 3] = 0;
+        } else {
+          p.keyed = true;
+        }
+        p.alpha = true;
+      } else { // Invalid for color type, ignore
+        skipBytes(p.in, len);
+      }
+    } else { // Any other chunk, skip
+      skipBytes(p.in, len);
+    }
+    skipBytes(p.in, 4); // CRC
+  }
+
+  // Start of compressed data. IDAT chunks are read through pngByte().
+  p.chunk = len;
+  p.idatEnd = false;
+  p.over = 0;
+  p.bits = 0;
+  p.nBits = 0;
+  p.block = PNG_BLOCK_HEADER;
+  p.last = false;
+  p.copy = 0;
+  p.out = 0;
+  cmf = pngByte(p);
+  flg = pngByte(p);
+  // Deflate, window up to 32 KB, header check, no preset dictionary
+  if (((cmf & 0x0F) != 8) || ((cmf >> 4) > 7) || ((cmf * 256 + flg) % 31) ||
+      (flg & 0x20) || p.over)
+    return IMAGE_ERR_FORMAT;
+  p.windowBits = (cmf >> 4) + 8;
+  return IMAGE_SUCCESS;
+}
+
+/*!
+    @brief   Reads next byte of zlib stream, which may span any number of
+             IDAT chunks. Past the end of the image data, zero bytes are
+             supplied and counted in p.over (pngInflate() uses this to
+             tell if more bits were consumed than the file held).
+    @param   p
+             PNG decoder state.
+    @return  Byte value.
+*/
+uint8_t Adafruit_ImageReader::pngByte(PNGDecoder &p) {
+  while (!p.chunk) {
+    if (p.idatEnd || p.in.eof) {
+      p.over++;
+      return 0;
+    }
+    skipBytes(p.in, 4); // Last chunk's CRC
+    p.chunk = readBE32(p.in);
+    if ((readBE32(p.in) != 0x49444154) || p.in.eof) { // Not IDAT
+      p.chunk = 0;
+      p.idatEnd = true;
+    }
+  }
+  p.chunk--;
+  return readByte(p.in);
+}
+
+/*!
+    @brief   Reads bits from zlib stream.
+    @param   p
+             PNG decoder state.
+    @param   n
+             Number of bits (0-16).
+    @return  Value of bits, first bit in LSB.
+*/
+uint32_t Adafruit_ImageReader::pngBits(PNGDecoder &p, uint8_t n) {
+  while (p.nBits < n) {
+    p.bits |= (uint32_t)pngByte(p) << p.nBits;
+    p.nBits += 8;
+  }
+  uint32_t v = p.bits & ((1UL << n) - 1);
+  p.bits >>= n;
+  p.nBits -= n;
+  return v;
+}
+
+/*!
+    @brief   Builds Huffman decoding table from code lengths, in the
+             canonical code order of RFC 1951 section 3.2.2.
+    @param   h
+             Table to fill in.
+    @param   length
+             Code length (0-15, 0 = unused) of each symbol.
+    @param   n
+             Number of symbols.
+    @return  true on success, false if lengths are invalid (more codes
+             than lengths allow). An incomplete code is allowed, its
+             unused codes are reported as errors when decoding.
+*/
+static bool pngCodes(PNGHuffman &h, const uint8_t *length, uint16_t n) {
+  uint16_t offs[16], i, len, code;
+  int32_t left = 1;
+
+  memset(h.count, 0, sizeof h.count);
+  for (i = 0; i < n; i++)
+    h.count[length[i]]++;
+  offs[1] = 0;
+  for (len = 1; len < 16; len++) {
+    left = (left << 1) - h.count[len];
+    if (left < 0)
+      return false;
+    if (len < 15)
+      offs[len + 1] = offs[len] + h.count[len];
+  }
+  for (i = 0; i < n; i++) {
+    if (length[i])
+      h.symbol[offs[length[i]]++] = i;
+  }
+  // Codes are sent first bit first, so the lookup index is each code
+  // bit-reversed, and all its entries are alike in the bits above it.
+  memset(h.fast, 0, sizeof h.fast);
+  for (len = 1, code = 0, i = 0; len <= PNG_FAST; len++, code <<= 1) {
+    for (uint16_t k = h.count[len]; k--; code++, i++) {
+      uint16_t r = 0;
+      for (uint8_t b = 0; b < len; b++)
+        r |= ((code >> b) & 1) << (len - 1 - b);
+      for (; r < (1 << PNG_FAST); r += 1 << len)
+        h.fast[r] = (len << 12) | h.symbol[i];
+    }
+  }
+  return true;
+}
+
+/*!
+    @brief   Decodes one Huffman-coded symbol from zlib stream.
+    @param   p
+             PNG decoder state.
+    @param   h
+             Huffman table.
+    @return  Symbol value, or -1 if data is invalid.
+*/
+int16_t Adafruit_ImageReader::pngHuff(PNGDecoder &p, const PNGHuffman &h) {
+  while (p.nBits < 15) {
+    p.bits |= (uint32_t)pngByte(p) << p.nBits;
+    p.nBits += 8;
+  }
+  uint16_t e = h.fast[p.bits & ((1 << PNG_FAST) - 1)];
+  if (e) {
+    p.bits >>= e >> 12;
+    p.nBits -= e >> 12;
+    return e & 0x1FF;
+  }
+  // Longer code: compare against each length's range of codes in turn
+  int32_t code = 0, first = 0;
+  uint16_t index = 0;
+  uint32_t b = p.bits;
+  for (uint8_t len = 1; len < 16; len++, b >>= 1) {
+    code |= b & 1;
+    if (code - first < h.count[len]) {
+      p.bits >>= len;
+      p.nBits -= len;
+      return h.symbol[index + code - first];
+    }
+    index += h.count[len];
+    first = (first + h.count[len]) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+/*!
+    @brief   Inflates the next bytes of PNG image data, resuming where the
+             last call left off.
+    @param   p
+             PNG decoder state.
+    @param   dest
+             Destination buffer.
+    @param   n
+             Number of bytes to inflate.
+    @return  IMAGE_SUCCESS, or IMAGE_ERR_FORMAT if data is invalid or
+             ends too soon.
+*/
+ImageReturnCode Adafruit_ImageReader::pngInflate(PNGDecoder &p,
+                                                 uint8_t *dest, uint32_t n) {
+  uint8_t *window = p.window;
+  uint32_t mask = p.windowMask;
+  uint16_t i, len, count;
+  int16_t sym;
+
+  while (n) {
+    if (p.copy) { // Match in progress, copy from history
+      count = min(n, (uint32_t)p.copy);
+      p.copy -= count;
+      n -= count;
+      for (uint32_t src = p.out - p.distance; count--; src++) {
+        uint8_t b = window[src & mask];
+        window[p.out++ & mask] = b;
+        *dest++ = b;
+      }
+    } else if (p.block == PNG_BLOCK_CODES) {
+      if ((sym = pngHuff(p, p.lit)) < 0)
+        return IMAGE_ERR_FORMAT;
+      if (sym < 256) { // Literal
+        window[p.out++ & mask] = sym;
+        *dest++ = sym;
+        n--;
+      } else if (sym == 256) { // End of block
+        p.block = PNG_BLOCK_HEADER;
+      } else { // Length, then distance of match
+        if ((sym -= 257) >= 29)
+          return IMAGE_ERR_FORMAT;
+        len = pngLenBase[sym] + pngBits(p, pngLenExtra[sym]);
+        if (((sym = pngHuff(p, p.dist)) < 0) || (sym >= 30))
+          return IMAGE_ERR_FORMAT;
+        p.distance = pngDistBase[sym] + pngBits(p, pngDistExtra[sym]);
+        if ((p.distance > p.out) || (p.distance > mask + 1))
+          return IMAGE_ERR_FORMAT; // Before start of data, or of window
+        p.copy = len;
+      }
+    } else if (p.block == PNG_BLOCK_STORED) {
+      if (!p.stored) {
+        p.block = PNG_BLOCK_HEADER;
+        continue;
+      }
+      count = min(n, (uint32_t)p.stored);
+      p.stored -= count;
+      n -= count;
+      while (count--) {
+        uint8_t b = pngBits(p, 8); // Whole bytes, bit buffer is aligned
+        window[p.out++ & mask] = b;
+        *dest++ = b;
+      }
+    } else { // Block header
+      if (p.last)
+        return IMAGE_ERR_FORMAT; // Data ended before image did
+      p.last = pngBits(p, 1);
+      uint8_t type = pngBits(p, 2);
+      if (type == 0) { // Stored: skip to byte boundary, then LEN, NLEN
+        pngBits(p, p.nBits & 7);
+        p.stored = pngBits(p, 16);
+        if (pngBits(p, 16) != (uint16_t)~p.stored)
+          return IMAGE_ERR_FORMAT;
+        p.block = PNG_BLOCK_STORED;
+      } else if (type == 1) { // Fixed codes
+        uint8_t length[288];
+        memset(length, 8, 144);
+        memset(&length[144], 9, 112);
+        memset(&length[256], 7, 24);
+        memset(&length[280], 8, 8);
+        pngCodes(p.lit, length, 288);
+        memset(length, 5, 30);
+        pngCodes(p.dist, length, 30);
+        p.block = PNG_BLOCK_CODES;
+      } else if (type == 2) { // Dynamic codes, from code length codes
+        uint8_t length[286 + 30];
+        uint16_t nLit = pngBits(p, 5) + 257, nDist = pngBits(p, 5) + 1;
+        uint8_t nLen = pngBits(p, 4) + 4;
+        if ((nLit > 286) || (nDist > 30))
+          return IMAGE_ERR_FORMAT;
+        memset(length, 0, 19);
+        for (i = 0; i < nLen; i++)
+          length[pngLenOrder[i]] = pngBits(p, 3);
+        if (!pngCodes(p.lit, length, 19)) // Code length codes, for now
+          return IMAGE_ERR_FORMAT;
+        for (i = 0; i < nLit + nDist; i += count) {
+          uint8_t value = 0; // Length to repeat
+          if ((sym = pngHuff(p, p.lit)) < 0)
+            return IMAGE_ERR_FORMAT;
+          if (sym < 16) { // Literal length
+            value = sym;
+            count = 1;
+          } else if (sym == 16) { // Repeat previous length 3-6 times
+            if (!i)
+              return IMAGE_ERR_FORMAT;
+            value = length[i - 1];
+            count = 3 + pngBits(p, 2);
+          } else if (sym == 17) { // 3-10 zeros
+            count = 3 + pngBits(p, 3);
+          } else { // 11-138 zeros
+            count = 11 + pngBits(p, 7);
+          }
+          if (i + count > nLit + nDist)
+            return IMAGE_ERR_FORMAT;
+          memset(&length[i], value, count);
+        }
+        if (!length[256] || !pngCodes(p.lit, length, nLit) ||
+            !pngCodes(p.dist, &length[nLit], nDist))
+          return IMAGE_ERR_FORMAT; // No end-of-block code, or bad lengths
+        p.block = PNG_BLOCK_CODES;
+      } else {
+        return IMAGE_ERR_FORMAT;
+      }
+    }
+  }
+  // Zero bytes supplied past the end must not have been consumed
+  return (p.nBits >= p.over * 8) ? IMAGE_SUCCESS : IMAGE_ERR_FORMAT;
+}
+
+#if !defined(__AVR__) // Only corePNG() calls these, and not on AVR
+/*!
+    @brief   Reverses PNG filtering of one scanline, in place. The
+             PNG_PAD bytes ahead of each line are zero, standing in for
+             the pixel to the left of the first one.
+    @param   type
+             Filter type (first byte of line in file).
+    @param   cur
+             Scanline.
+    @param   prev
+             Previous scanline, unfiltered (all zero for first line).
+    @param   n
+             Bytes in scanline.
+    @param   bpp
+             Bytes per complete pixel, rounded up (1-8).
+    @return  true on success, false if filter type is invalid.
+*/
+static bool pngUnfilter(uint8_t type, uint8_t *cur, const uint8_t *prev,
+                        uint32_t n, uint8_t bpp) {
+  const uint8_t *left = cur - bpp, *upLeft = prev - bpp; // Neighbors
+  uint32_t i;
+  if (type == 1) { // Sub
+    for (i = 0; i < n; i++)
+      cur[i] += left[i];
+  } else if (type == 2) { // Up
+    for (i = 0; i < n; i++)
+      cur[i] += prev[i];
+  } else if (type == 3) { // Average
+    for (i = 0; i < n; i++)
+      cur[i] += (left[i] + prev[i]) >> 1;
+  } else if (type == 4) { // Paeth
+    for (i = 0; i < n; i++) {
+      int16_t a = left[i], b = prev[i], c = upLeft[i];
+      int16_t pa = abs(b - c), pb = abs(a - c), pc = abs(a + b - c - c);
+      cur[i] += ((pa <= pb) && (pa <= pc)) ? a : (pb <= pc) ? b : c;
+    }
+  } else if (type) {
+    return false;
+  }
+  return true;
+}
+
+/*!
+    @brief   Converts pixels of a PNG scanline that has no palette (RGB,
+             RGBA, gray + alpha, or 16-bit gray) to B,G,R,A order, 8 bits
+             each, in p.bgra.
+    @param   p
+             PNG decoder state.
+    @param   src
+             Scanline, unfiltered.
+    @param   col
+             First pixel to convert.
+    @param   n
+             Number of pixels (PNG_SPAN max.).
+    @return  None (void).
+*/
+static void pngBGRA(PNGDecoder &p, const uint8_t *src, uint32_t col,
+                    uint32_t n) {
+  uint8_t s = p.depth / 8, step = p.channels * s; // Sample & pixel bytes
+  uint8_t *out = p.bgra;
+  for (src += col * step; n--; src += step, out += 4) {
+    if (p.channels < 3) { // Gray (+ alpha)
+      out[0] = out[1] = out[2] = src[0];
+      out[3] = (p.channels == 2) ? src[s] : 255;
+    } else {
+      out[0] = src[s * 2];
+      out[1] = src[s];
+      out[2] = src[0];
+      out[3] = (p.channels == 4) ? src[s * 3] : 255;
+    }
+    if (p.keyed) { // Transparent if all samples match, at full depth
+      uint8_t c;
+      for (c = 0; c < p.channels; c++) {
+        uint16_t v = (s == 2) ? ((src[c * 2] << 8) | src[c * 2 + 1]) : src[c];
+        if (v != p.key[c])
+          break;
+      }
+      if (c == p.channels)
+        out[3] = 0;
+    }
+  }
+}
+#endif // !__AVR__
+
+/*!
+    @brief   Loads PNG image file from SD card directly to Adafruit_SPITFT
+             screen, or into RAM. Called by drawPNG() and loadPNG().
+    @param   filename
+             Name of PNG image file to load.
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+    @param   dest
+             Working buffer for loading 16-bit TFT pixel data, if loading
+             to screen, else NULL.
+    @param   x
+             Horizontal offset in pixels (if loading to screen).
+    @param   y
+             Vertical offset in pixels (if loading to screen).
+    @param   img
+             Pointer to Adafruit_Image object, if loading to RAM (or NULL
+             if loading to screen).
+    @param   transact
+             Use SPI transactions; 'true' is needed only if loading to screen
+             and it's on the same SPI bus as the SD card.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::corePNG(const char *filename,
+                                              Adafruit_SPITFT *tft,
+                                              uint16_t *dest, int16_t x,
+                                              int16_t y, Adafruit_Image *img,
+                                              boolean transact) {
+#if defined(__AVR__)
+  // Compression window alone can be many times an AVR's RAM
+  (void)filename;
+  (void)tft;
+  (void)dest;
+  (void)x;
+  (void)y;
+  (void)img;
+  (void)transact;
+  return IMAGE_ERR_MALLOC;
+#else
+  ImageReturnCode status;
+  PNGDecoder *p;                   // Tables & decoding state (on heap)
+  uint8_t localbuf[3 * BUFPIXELS]; // Default file read buf
+  uint8_t *sdbuf = localbuf;       // File read buf
+  uint32_t sdbufSize = sizeof localbuf;
+  uint32_t destSize = BUFPIXELS; // Size of each dest buf, pixels
+  uint32_t destidx = 0;          // Pixels in dest
+  uint16_t *destAlt = NULL;      // Alternate TFT buffer (non-blocking writes)
+  uint16_t *canvas = NULL;       // Canvas pixels, if loading to 16-bit canvas
+  uint8_t *canvas8 = NULL;       // Canvas indices, if loading to 8-bit canvas
+  uint8_t *mask1 = NULL;         // Alpha mask, if loading with IMAGE_ALPHA_MASK
+  uint32_t maskStride = 0;       // Bytes per mask row
+  uint16_t *quantized = NULL;    // 16-bit 5/6/5 color palette, if indexed
+  uint8_t *rows = NULL;          // Window, then two scanlines
+  uint8_t *cur, *prev;           // Scanline being decoded & previous one
+  uint8_t filter;                // Filter type of scanline
+  uint8_t bpp = 1;               // Bytes per pixel for filters (at least 1)
+  boolean indexed = false;       // Pixels are palette (or gray) indices
+  uint32_t rowBytes = 0;         // Bytes per scanline, not incl. filter type
+  uint32_t windowSize;           // Bytes of history kept for matches
+  uint32_t row, col, span, i;    // Scanline, pixel, pixels converted at once
+  int32_t loadWidth = 0, loadHeight = 0, // Region being loaded (clipped)
+      loadX = 0, loadY = 0;              // "
+  uint32_t startTime = 0;                // Timing for stats
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  if (img)
+    img->dealloc();
+
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default file read buffer and (if drawing to TFT) dest buffers.
+  splitBuffer(tft ? DESTBUFS : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+#if DESTBUFS > 1
+  if (tft)
+    destAlt = &dest[destSize];
+#endif
+
+  if (tft && ((x >= tft->width()) || (y >= tft->height())))
+    return IMAGE_SUCCESS;
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+
+  if (!(p = (PNGDecoder *)malloc(sizeof(PNGDecoder)))) {
+    file.close();
+    return IMAGE_ERR_MALLOC;
+  }
+  p->in.buf = sdbuf;
+  p->in.bufSize = sdbufSize;
+  p->in.tft = NULL;
+  p->in.transact = transact;
+  status = pngHeader(*p);
+
+  if (status == IMAGE_SUCCESS) {
+    indexed = (p->depth <= 8) && ((p->color == 0) || (p->color == 3));
+    rowBytes = (p->width * p->channels * p->depth + 7) / 8;
+    bpp = (p->channels * p->depth + 7) / 8;
+    // Matches can't reach back further than the start of the data, so a
+    // small image needs less than the window size given in its header.
+    windowSize = 1UL << p->windowBits;
+    while ((windowSize > 256) &&
+           (windowSize / 2 / (rowBytes + 1) >= p->height))
+      windowSize /= 2;
+    p->windowMask = windowSize - 1;
+    status = IMAGE_ERR_MALLOC;
+    if ((rows = (uint8_t *)calloc(windowSize + 2 * (PNG_PAD + rowBytes), 1)) &&
+        (!indexed ||
+         (quantized = (uint16_t *)malloc(sizeof(uint16_t) << p->depth))))
+      status = IMAGE_SUCCESS;
+  }
+
+  if (status == IMAGE_SUCCESS) {
+    p->window = rows;
+    cur = &rows[windowSize + PNG_PAD];
+    prev = &cur[rowBytes + PNG_PAD];
+
+    loadWidth = p->width;
+    loadHeight = p->height;
+    if (tft) {
+      // Crop area to be loaded (if destination is TFT)
+      if (x < 0) {
+        loadX = -x;
+        loadWidth += x;
+        x = 0;
+      }
+      if (y < 0) {
+        loadY = -y;
+        loadHeight += y;
+        y = 0;
+      }
+      if ((x + loadWidth) > tft->width())
+        loadWidth = tft->width() - x;
+      if ((y + loadHeight) > tft->height())
+        loadHeight = tft->height() - y;
+    } else {
+      // Loading to RAM -- palette image (unless it needs a mask) keeps
+      // its indices, anything else is expanded to 16 bits.
+      status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+      if (indexed && !(p->alpha && (alphaMode == IMAGE_ALPHA_MASK))) {
+        if ((img->canvas.canvas8 = new GFXcanvas8(p->width, p->height))) {
+          if ((canvas8 = img->canvas.canvas8->getBuffer())) {
+            img->format = IMAGE_8;
+            status = IMAGE_SUCCESS;
+          } else {
+            delete img->canvas.canvas8;
+            img->canvas.canvas8 = NULL;
+          }
+        }
+      } else if ((img->canvas.canvas16 =
+                      new GFXcanvas16(p->width, p->height))) {
+        img->format = IMAGE_16; // dealloc() cleans up from here on
+        if ((canvas = img->canvas.canvas16->getBuffer())) {
+          status = IMAGE_SUCCESS;
+          if (p->alpha && (alphaMode == IMAGE_ALPHA_MASK)) {
+            // Alpha is thresholded into a 1-bit mask (zeroed by GFX)
+            if ((img->mask = new GFXcanvas1(p->width, p->height)) &&
+                (mask1 = img->mask->getBuffer()))
+              maskStride = (p->width + 7) / 8;
+            else
+              status = IMAGE_ERR_MALLOC;
+          }
+        }
+      }
+    }
+
+    if (indexed) {
+      // Quantize palette once, applying alpha policy; a masked canvas
+      // keeps full color (alpha goes to the mask).
+      bgra8888To565(p->palette, quantized, 1 << p->depth,
+                    mask1 ? (uint8_t)IMAGE_ALPHA_IGNORE : alphaMode,
+                    alphaThreshold, alphaColor, tft && TFT_BIGENDIAN);
+    }
+  }
+
+  if ((status == IMAGE_SUCCESS) && (loadWidth > 0) && (loadHeight > 0)) {
+    if (stats)
+      stats->headerTime = micros() - startTime;
+    if (tft) {
+      tft->startWrite(); // Start SPI (regardless of transact)
+      tft->setAddrWindow(x, y, loadWidth, loadHeight);
+      p->in.tft = tft; // Reads end & restart the transaction if needed
+    }
+
+    for (row = 0; row < (uint32_t)(loadY + loadHeight); row++) {
+      uint8_t *tmp = cur; // Last line becomes previous line
+      cur = prev;
+      prev = tmp;
+      if ((pngInflate(*p, &filter, 1) != IMAGE_SUCCESS) ||
+          (pngInflate(*p, cur, rowBytes) != IMAGE_SUCCESS) ||
+          !pngUnfilter(filter, cur, prev, rowBytes, bpp)) {
+        status = IMAGE_ERR_FORMAT;
+        break;
+      }
+      if (row < (uint32_t)loadY)
+        continue; // Above visible area
+
+      // Convert visible part of line, as many pixels at a time as
+      // (for TFT) dest has room for
+      for (col = loadX; col < (uint32_t)(loadX + loadWidth); col += span) {
+        uint16_t *out = NULL; // 16-bit output (unused if canvas8)
+        span = loadX + loadWidth - col;
+        if (tft) {
+          span = min(span, destSize - destidx);
+          out = &dest[destidx];
+        } else if (canvas) {
+          out = &canvas[row * p->width + col];
+        }
+        if (indexed) {
+          for (i = 0; i < span; i++) {
+            uint8_t idx;
+            if (p->depth == 8) {
+              idx = cur[col + i];
+            } else { // Leftmost pixel in most significant bits
+              uint32_t bit = (col + i) * p->depth;
+              idx = (cur[bit >> 3] >> (8 - p->depth - (bit & 7))) &
+                    ((1 << p->depth) - 1);
+            }
+            if (canvas8) {
+              canvas8[row * p->width + col + i] = idx;
+            } else {
+              out[i] = quantized[idx];
+              if (mask1 && (p->palette[idx * 4 + 3] >= alphaThreshold))
+                mask1[row * maskStride + ((col + i) >> 3)] |=
+                    0x80 >> ((col + i) & 7);
+            }
+          }
+        } else if ((p->color == 2) && (p->depth == 8) && !p->keyed) {
+          const uint8_t *s = &cur[col * 3]; // R, G, B
+          for (i = 0; i < span; i++, s += 3) {
+            uint16_t c = ((s[0] & 0xF8) << 8) | ((s[1] & 0xFC) << 3) |
+                         (s[2] >> 3);
+            out[i] = (tft && TFT_BIGENDIAN) ? ((c >> 8) | (c << 8)) : c;
+          }
+        } else {
+          span = min(span, (uint32_t)PNG_SPAN);
+          pngBGRA(*p, cur, col, span);
+          // Masked canvas keeps full color, alpha goes to mask
+          bgra8888To565(p->bgra, out, span,
+                        mask1 ? (uint8_t)IMAGE_ALPHA_IGNORE : alphaMode,
+                        alphaThreshold, alphaColor, tft && TFT_BIGENDIAN);
+          if (mask1) {
+            for (i = 0; i < span; i++) {
+              if (p->bgra[i * 4 + 3] >= alphaThreshold)
+                mask1[row * maskStride + ((col + i) >> 3)] |=
+                    0x80 >> ((col + i) & 7);
+            }
+          }
+        }
+        if (tft && ((destidx += span) >= destSize)) {
+          writeDest(tft, dest, destAlt, destidx);
+          destidx = 0;
+        }
+      }
+    }
+
+    if (tft) {
+      if (destidx)
+        writeDest(tft, dest, destAlt, destidx);
+      tft->dmaWait();  // Wait for last non-blocking write
+      tft->endWrite(); // End TFT (regardless of transact)
+    }
+    if (stats && (status == IMAGE_SUCCESS))
+      stats->pixels = (uint32_t)loadWidth * loadHeight;
+  }
+
+  if (img) {
+    if (status != IMAGE_SUCCESS) {
+      img->dealloc(); // Loaded partially or not at all
+    } else if (canvas8) {
+      img->palette = quantized; // Keep palette with img
+      quantized = NULL;
+    }
+  }
+  free(quantized);
+  free(rows);
+  free(p);
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+#endif // !__AVR__
+}
+
+// QOI decoding ("Quite OK Image" format, qoiformat.org): RGB or RGBA, one
+// pass, with a 64-entry cache of recent colors. Each pixel is either a
+// repeat of the last, a cache index, a small difference from the last, or
+// an explicit color, so decoding is a few operations per pixel.
+
+#define QOI_HEADER 14 ///< Header size, and file position of first pixel
+
+/*!
+    @brief   Draws a QOI image file from SD card to SPITFT screen. Pixels
+             are decoded straight into the TFT working buffers; only a
+             256-byte color cache is needed on top of those. Alpha (in
+             4-channel files) is handled as for 32-bit BMPs, see
+             setAlpha().
+    @param   filename
+             Name of QOI image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::drawQOI(const char *filename,
+                                              Adafruit_SPITFT &tft, int16_t x,
+                                              int16_t y, boolean transact) {
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
+  return coreQOI(filename, &tft, tftbuf, x, y, NULL, transact);
+}
+
+/*!
+    @brief   Loads a QOI image file from SD card into RAM, as a GFXcanvas16
+             (IMAGE_16) Adafruit_Image; with IMAGE_ALPHA_MASK (see
+             setAlpha()), 4-channel images also get a 1-bit mask.
+    @param   filename
+             Name of QOI image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadQOI(const char *filename,
+                                              Adafruit_Image &img) {
+  return coreQOI(filename, NULL, NULL, 0, 0, &img, false);
+}
+
+/*!
+    @brief   Query pixel dimensions of QOI image file on SD card.
+    @param   filename
+             Name of QOI image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::qoiDimensions(const char *filename,
+                                                    int32_t *width,
+                                                    int32_t *height) {
+  int32_t w, h;
+  uint8_t channels;
+  ImageReturnCode status = openQOI(filename, &w, &h, &channels);
+  if (status == IMAGE_SUCCESS) {
+    file.close();
+    if (width)
+      *width = w;
+    if (height)
+      *height = h;
+  }
+  return status;
+}
+
+/*!
+    @brief   Opens a QOI image file and reads its header. On success the
+             file is left open, positioned at the first pixel.
+    @param   filename
+             Name of image file to open.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @param   channels
+             Pointer to uint8_t; 3 (RGB) or 4 (RGBA), returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS if the file
+             is open and valid).
+*/
+ImageReturnCode Adafruit_ImageReader::openQOI(const char *filename,
+                                              int32_t *width, int32_t *height,
+                                              uint8_t *channels) {
+  uint8_t header[QOI_HEADER]; // "qoif", width, height, channels, colorspace
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if ((readData(header, sizeof header) == (int)sizeof header) &&
+      !memcmp(header, "qoif", 4) && !header[4] && !header[5] && !header[8] &&
+      !header[9]) { // (Larger than 65535 pixels either way not supported)
+    *width = (header[6] << 8) | header[7];
+    *height = (header[10] << 8) | header[11];
+    *channels = header[12];
+    if (*width && *height && ((*channels == 3) || (*channels == 4)))
+      return IMAGE_SUCCESS;
+  }
+  file.close();
+  return IMAGE_ERR_FORMAT;
+}
+
+/*!
+    @brief   Loads QOI image file from SD card directly to Adafruit_SPITFT
+             screen, or into RAM. Called by drawQOI() and loadQOI().
+    @param   filename
+             Name of QOI image file to load.
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+    @param   dest
+             Working buffer for loading 16-bit TFT pixel data, if loading
+             to screen, else NULL.
+    @param   x
+             Horizontal offset in pixels (if loading to screen).
+    @param   y
+             Vertical offset in pixels (if loading to screen).
+    @param   img
+             Pointer to Adafruit_Image object, if loading to RAM (or NULL
+             if loading to screen).
+    @param   transact
+             Use SPI transactions; 'true' is needed only if loading to screen
+             and it's on the same SPI bus as the SD card.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::coreQOI(const char *filename,
+                                              Adafruit_SPITFT *tft,
+                                              uint16_t *dest, int16_t x,
+                                              int16_t y, Adafruit_Image *img,
+                                              boolean transact) {
+  ImageReturnCode status;
+  ImageInput in;                   // File input
+  uint8_t localbuf[3 * BUFPIXELS]; // Default file read buf
+  uint8_t *sdbuf = localbuf;       // File read buf
+  uint32_t sdbufSize = sizeof localbuf;
+  uint32_t destSize = BUFPIXELS; // Size of each dest buf, pixels
+  uint32_t destidx = 0;          // Pixels in dest
+  uint16_t *destAlt = NULL;      // Alternate TFT buffer (non-blocking writes)
+  uint16_t *canvas = NULL;       // Canvas pixels, if loading to RAM
+  uint8_t *mask1 = NULL;         // Alpha mask, if loading with IMAGE_ALPHA_MASK
+  uint32_t maskStride = 0;       // Bytes per mask row
+  uint8_t cache[64][4];          // Recently seen colors, B,G,R,A
+  uint8_t px[4] = {0, 0, 0, 255}; // Current color, B,G,R,A
+  uint16_t c = 0;                // Current color as 565 (TFT byte order)
+  uint32_t repeat = 0;           // Pixels left of current color
+  uint8_t channels;              // 3 = RGB, 4 = RGBA
+  boolean blend;                 // Alpha is applied to color
+  int32_t imgWidth, imgHeight;   // Image size in pixels
+  int32_t loadWidth, loadHeight, // Region being loaded (clipped)
+      loadX = 0, loadY = 0;      // "
+  int32_t row, col, c0, c1, n;   // Position in image, visible run
+  uint32_t startTime = 0;        // Timing for stats
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  if (img)
+    img->dealloc();
+
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default file read buffer and (if drawing to TFT) dest buffers.
+  splitBuffer(tft ? DESTBUFS : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+#if DESTBUFS > 1
+  if (tft)
+    destAlt = &dest[destSize];
+#endif
+
+  if (tft && ((x >= tft->width()) || (y >= tft->height())))
+    return IMAGE_SUCCESS;
+
+  if ((status = openQOI(filename, &imgWidth, &imgHeight, &channels)) !=
+      IMAGE_SUCCESS)
+    return status;
+
+  loadWidth = imgWidth;
+  loadHeight = imgHeight;
+  if (tft) {
+    // Crop area to be loaded (if destination is TFT)
+    if (x < 0) {
+      loadX = -x;
+      loadWidth += x;
+      x = 0;
+    }
+    if (y < 0) {
+      loadY = -y;
+      loadHeight += y;
+      y = 0;
+    }
+    if ((x + loadWidth) > tft->width())
+      loadWidth = tft->width() - x;
+    if ((y + loadHeight) > tft->height())
+      loadHeight = tft->height() - y;
+  } else {
+    status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+    if ((img->canvas.canvas16 = new GFXcanvas16(imgWidth, imgHeight))) {
+      img->format = IMAGE_16; // dealloc() cleans up from here on
+      if ((canvas = img->canvas.canvas16->getBuffer())) {
+        status = IMAGE_SUCCESS;
+        if ((channels == 4) && (alphaMode == IMAGE_ALPHA_MASK)) {
+          // Alpha is thresholded into a 1-bit mask (zeroed by GFX)
+          if ((img->mask = new GFXcanvas1(imgWidth, imgHeight)) &&
+              (mask1 = img->mask->getBuffer()))
+            maskStride = (imgWidth + 7) / 8;
+          else
+            status = IMAGE_ERR_MALLOC;
+        }
+      }
+    }
+  }
+  // Masked canvas keeps full color, alpha goes to mask
+  blend = (channels == 4) && !mask1 && (alphaMode != IMAGE_ALPHA_IGNORE);
+
+  if ((status == IMAGE_SUCCESS) && (loadWidth > 0) && (loadHeight > 0)) {
+    if (stats)
+      stats->headerTime = micros() - startTime;
+    memset(cache, 0, sizeof cache);
+    in.buf = sdbuf;
+    in.bufSize = sdbufSize;
+    in.pos = in.len = 0;
+    in.filePos = QOI_HEADER;
+    in.eof = false;
+    in.transact = transact;
+    in.tft = tft;
+    if (tft) {
+      tft->startWrite(); // Start SPI (regardless of transact)
+      tft->setAddrWindow(x, y, loadWidth, loadHeight);
+    }
+
+    for (row = 0; row < loadY + loadHeight; row++) {
+      for (col = 0; col < imgWidth; col += n) {
+        if (!repeat) { // Decode next chunk
+          uint8_t b1 = readByte(in);
+          repeat = 1;
+          if (b1 == 0xFE) { // QOI_OP_RGB
+            px[2] = readByte(in);
+            px[1] = readByte(in);
+            px[0] = readByte(in);
+          } else if (b1 == 0xFF) { // QOI_OP_RGBA
+            px[2] = readByte(in);
+            px[1] = readByte(in);
+            px[0] = readByte(in);
+            px[3] = readByte(in);
+          } else if (b1 < 0x40) { // QOI_OP_INDEX
+            memcpy(px, cache[b1], 4);
+          } else if (b1 < 0x80) { // QOI_OP_DIFF, each channel -2 to 1
+            px[2] += ((b1 >> 4) & 3) - 2;
+            px[1] += ((b1 >> 2) & 3) - 2;
+            px[0] += (b1 & 3) - 2;
+          } else if (b1 < 0xC0) { // QOI_OP_LUMA, green -32 to 31 & others
+            uint8_t b2 = readByte(in); // relative to it, -8 to 7
+            int8_t dg = (b1 & 0x3F) - 32;
+            px[2] += dg - 8 + (b2 >> 4);
+            px[1] += dg;
+            px[0] += dg - 8 + (b2 & 0x0F);
+          } else { // QOI_OP_RUN, 1 to 62 of last color
+            repeat = (b1 & 0x3F) + 1;
+          }
+          if (in.eof) {
+            status = IMAGE_ERR_FORMAT; // Truncated file
+            break;
+          }
+          memcpy(cache[(px[2] * 3 + px[1] * 5 + px[0] * 7 + px[3] * 11) & 63],
+                 px, 4);
+          if (blend) {
+            bgra8888To565(px, &c, 1, alphaMode, alphaThreshold, alphaColor,
+                          tft && TFT_BIGENDIAN);
+          } else {
+            c = ((px[2] & 0xF8) << 8) | ((px[1] & 0xFC) << 3) | (px[0] >> 3);
+            if (tft && TFT_BIGENDIAN)
+              c = (c >> 8) | (c << 8);
+          }
+        }
+        // Current color for up to the rest of the row; store the part
+        // that's visible
+        n = min((int32_t)repeat, imgWidth - col);
+        repeat -= n;
+        if (row < loadY)
+          continue;
+        c0 = max(col, loadX);
+        c1 = min(col + n, loadX + loadWidth);
+        if (tft) {
+          while (c0 < c1) {
+            int32_t k = min(c1 - c0, (int32_t)(destSize - destidx));
+            for (int32_t i = 0; i < k; i++)
+              dest[destidx + i] = c;
+            destidx += k;
+            c0 += k;
+            if (destidx >= destSize) {
+              writeDest(tft, dest, destAlt, destidx);
+              destidx = 0;
+            }
+          }
+        } else {
+          for (int32_t i = c0; i < c1; i++)
+            canvas[row * imgWidth + i] = c;
+          if (mask1 && (px[3] >= alphaThreshold)) {
+            for (int32_t i = c0; i < c1; i++)
+              mask1[row * maskStride + (i >> 3)] |= 0x80 >> (i & 7);
+          }
+        }
+      }
+      if (status != IMAGE_SUCCESS)
+        break;
+    }
+
+    if (tft) {
+      if (destidx)
+        writeDest(tft, dest, destAlt, destidx);
+      tft->dmaWait();  // Wait for last non-blocking write
+      tft->endWrite(); // End TFT (regardless of transact)
+    }
+    if (stats && (status == IMAGE_SUCCESS))
+      stats->pixels = (uint32_t)loadWidth * loadHeight;
+  }
+
+  if (img && (status != IMAGE_SUCCESS))
+    img->dealloc(); // Loaded partially or not at all
+  file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+}
+
+// GIF decoding (GIF87a/89a): palette images of up to 8 bits per pixel,
+// LZW-compressed, optionally as several frames that each cover some part
+// of the "logical screen," with their own palette, transparent color,
+// delay and disposal. Frames are decoded one row at a time; the LZW
+// string table is the fixed 4096 codes the format allows (12-bit codes),
+// so memory use doesn't depend on image size beyond one row of indices.
+
+#define GIF_CODES 4096 ///< Size of LZW string table (12-bit codes)
+#define GIF_HEADER 13  ///< Header size, up to global palette (if any)
+
+// Interlaced GIFs store rows in four passes: first row & row step of each
+static const uint8_t gifPassStart[4] = {0, 4, 2, 1};
+static const uint8_t gifPassStep[4] = {8, 8, 4, 2};
+
+/*!
+    @brief   Working state of GIF decoder, kept from openGIF() to
+             closeGIF(): global palette, LZW string table and the position
+             in the compressed data of the current frame. A buffer of one
+             row of indices (as wide as the logical screen) follows it in
+             the same allocation.
+*/
+struct GIFDecoder {
+  ImageInput in;               ///< File input
+  uint16_t prefix[GIF_CODES];  ///< String table: code of all but last pixel
+  uint8_t suffix[GIF_CODES];   ///< String table: last pixel
+  uint8_t stack[GIF_CODES];    ///< Pixels of string being output, last first
+                               ///< (also frame palette, B,G,R,A, before LZW)
+  uint8_t global[256 * 3];     ///< Global palette, R,G,B
+  uint16_t quantized[256];     ///< Frame palette as 565, for drawing
+  uint8_t *line;               ///< Visible pixels of current row (indices)
+  uint16_t colors;             ///< Number of global palette entries
+  uint8_t background;          ///< Background color index
+  uint16_t clear;              ///< Clear code (first code after pixels)
+  uint16_t avail;              ///< Next free code in string table
+  int16_t old;                 ///< Previous code, -1 after clear code
+  uint8_t first;               ///< First pixel of previous code's string
+  uint16_t sp;                 ///< Pixels in stack not yet output
+  uint8_t codeSize;            ///< Current code size in bits (3 to 12)
+  uint32_t bits;               ///< Compressed bits, first in LSB
+  uint8_t nBits;               ///< Number of valid bits in 'bits'
+  uint8_t blockLeft;           ///< Bytes left in current data sub-block
+  boolean ended;               ///< Data sub-block terminator has been read
+  boolean done;                ///< End of information code has been read
+};
+
+/*!
+    @brief   Draws the first frame of a GIF image file from SD card to
+             SPITFT screen, at its position within the image's "logical
+             screen" (normally the whole of it). Interlaced images are
+             supported. Memory use is about 18 KB of tables plus one row
+             of pixel indices. The transparent color, if any, is handled
+             as alpha is for 32-bit BMPs (see setAlpha()): drawn as-is
+             with IMAGE_ALPHA_IGNORE, else as the background color. For
+             animations, see openGIF() and drawGIFFrame().
+    @param   filename
+             Name of GIF image file to load.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset in pixels; left edge = 0, positive = right.
+             Value is signed, image will be clipped if all or part is off
+             the screen edges. Screen rotation setting is observed.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::drawGIF(const char *filename,
+                                              Adafruit_SPITFT &tft, int16_t x,
+                                              int16_t y, boolean transact) {
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
+  GIFAnimation gif;
+  ImageReturnCode status = openGIF(filename, gif);
+  if (status == IMAGE_SUCCESS)
+    status = gifFrame(gif, &tft, tftbuf, x, y, NULL, transact, false);
+  closeGIF(gif);
+  return status;
+}
+
+/*!
+    @brief   Loads the first frame of a GIF image file from SD card into
+             RAM, as a GFXcanvas8 (IMAGE_8) Adafruit_Image the size of the
+             image's logical screen, with a 565 palette. Any part of the
+             screen the frame doesn't cover is the background color. With
+             IMAGE_ALPHA_MASK (see setAlpha()), an image with a transparent
+             color (or a frame not covering the screen) is instead loaded
+             as IMAGE_16 with a 1-bit mask.
+    @param   filename
+             Name of GIF image file to load.
+    @param   img
+             Adafruit_Image object, contents will be initialized, allocated
+             and loaded on success (else cleared).
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::loadGIF(const char *filename,
+                                              Adafruit_Image &img) {
+  GIFAnimation gif;
+  ImageReturnCode status = openGIF(filename, gif);
+  if (status == IMAGE_SUCCESS)
+    status = gifFrame(gif, NULL, NULL, 0, 0, &img, false, false);
+  else
+    img.dealloc();
+  closeGIF(gif);
+  return status;
+}
+
+/*!
+    @brief   Query pixel dimensions of GIF image file on SD card (the size
+             of its logical screen, which all frames fit within).
+    @param   filename
+             Name of GIF image file to query.
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::gifDimensions(const char *filename,
+                                                    int32_t *width,
+                                                    int32_t *height) {
+  uint8_t header[10]; // "GIF87a" or "GIF89a", width, height
+  ImageReturnCode status = IMAGE_ERR_FORMAT;
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if ((readData(header, sizeof header) == (int)sizeof header) &&
+      !memcmp(header, "GIF8", 4) &&
+      ((header[4] == '7') || (header[4] == '9')) && (header[5] == 'a')) {
+    if (width)
+      *width = readLE16(&header[6]);
+    if (height)
+      *height = readLE16(&header[8]);
+    status = IMAGE_SUCCESS;
+  }
+  file.close();
+  return status;
+}
+
+/*!
+    @brief   Opens a GIF image file to be played frame by frame with
+             drawGIFFrame(). The file stays open, and the decoder's tables
+             (about 18 KB, plus a row as wide as the image) stay allocated,
+             until closeGIF(); other images can be drawn in between.
+             Opening an animation that's already open closes it first.
+    @param   filename
+             Name of GIF image file to open.
+    @param   gif
+             GIFAnimation object; initialized for the first frame, with
+             width and height set to the image's logical screen size.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS if the file
+             is open and ready to play).
+*/
+ImageReturnCode Adafruit_ImageReader::openGIF(const char *filename,
+                                              GIFAnimation &gif) {
+  closeGIF(gif);
+  gif.width = gif.height = 0;
+#if defined(__AVR__)
+  // String table alone is more than an AVR's RAM
+  (void)filename;
+  return IMAGE_ERR_MALLOC;
+#else
+  uint8_t header[GIF_HEADER]; // Signature, screen size, flags, background...
+  GIFDecoder *g;
+  ImageReturnCode status = IMAGE_ERR_FORMAT;
+
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if ((readData(header, sizeof header) == (int)sizeof header) &&
+      !memcmp(header, "GIF8", 4) &&
+      ((header[4] == '7') || (header[4] == '9')) && (header[5] == 'a')) {
+    gif.width = readLE16(&header[6]);
+    gif.height = readLE16(&header[8]);
+  }
+  if (gif.width && gif.height) {
+    status = IMAGE_ERR_MALLOC;
+    if ((g = (GIFDecoder *)malloc(sizeof(GIFDecoder) + gif.width))) {
+      g->line = (uint8_t *)&g[1];
+      g->colors = (header[10] & 0x80) ? (2 << (header[10] & 7)) : 0;
+      g->background = header[11];
+      memset(g->global, 0, sizeof g->global); // Unlisted colors are black
+      if (readData(g->global, g->colors * 3) == g->colors * 3) {
+        gif.decoder = g;
+        gif.start = gif.next = GIF_HEADER + g->colors * 3;
+        gif.frame = gif.loops = gif.delay = 0;
+        gif.dispose = 0;
+        gif.lastW = gif.lastH = 0;
+        gif.file = file; // Animation keeps the open file
+        file = File32();
+        return IMAGE_SUCCESS;
+      }
+      free(g);
+      status = IMAGE_ERR_FORMAT;
+    }
+  }
+  file.close();
+  return status;
+#endif // !__AVR__
+}
+
+/*!
+    @brief   Draws the next frame of a GIF animation opened with openGIF(),
+             writing only the frame's own area of the screen (which may be
+             a small part of the image). Transparent pixels are not drawn,
+             leaving the previous frame showing through; each run of
+             opaque pixels gets its own setAddrWindow(). If the previous
+             frame asked for its area to be restored to the background,
+             that's filled with the background color of setAlpha() first
+             ("restore to previous" frames are left in place instead).
+             After the last frame, the animation starts over.
+    @param   gif
+             GIFAnimation object, as set up by openGIF(). On return, its
+             'delay' is how long to show this frame for (in milliseconds,
+             0 if not given), and 'frame' is one more than this frame's
+             number.
+    @param   tft
+             Adafruit_SPITFT object (e.g. Adafruit_ILI9341).
+    @param   x
+             Horizontal offset of the image's logical screen in pixels,
+             left edge = 0, positive = right. Value is signed, frames will
+             be clipped if all or part is off the screen edges.
+    @param   y
+             Vertical offset in pixels; top edge = 0, positive = down.
+    @param   transact
+             Pass 'true' if TFT and SD are on the same SPI bus, in which
+             case SPI transactions are necessary. If separate peripherals,
+             can pass 'false'.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::drawGIFFrame(GIFAnimation &gif,
+                                                   Adafruit_SPITFT &tft,
+                                                   int16_t x, int16_t y,
+                                                   boolean transact) {
+  uint16_t tftbuf[BUFPIXELS * DESTBUFS]; // Temp space for buffering TFT data
+  return gifFrame(gif, &tft, tftbuf, x, y, NULL, transact, true);
+}
+
+/*!
+    @brief   Closes a GIF animation opened with openGIF(), freeing its
+             memory. Does nothing if it isn't open.
+    @param   gif
+             GIFAnimation object.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::closeGIF(GIFAnimation &gif) {
+  free(gif.decoder);
+  gif.decoder = NULL;
+  if (gif.file)
+    gif.file.close();
+}
+
+/*!
+    @brief   Decodes pixels of the current GIF frame's LZW-compressed data,
+             continuing from where the last call left off.
+    @param   g
+             GIF decoder state.
+    @param   dest
+             Destination for pixels (palette indices), or NULL to discard.
+    @param   n
+             Number of pixels.
+    @return  IMAGE_SUCCESS, or IMAGE_ERR_FORMAT if the data is invalid or
+             ends before n pixels.
+*/
+ImageReturnCode Adafruit_ImageReader::gifDecode(GIFDecoder &g, uint8_t *dest,
+                                                uint32_t n) {
+  uint16_t code, in;
+
+  while (n) {
+    if (g.sp) { // Output what's left of last string first
+      uint16_t k = min(n, (uint32_t)g.sp);
+      n -= k;
+      if (dest) {
+        while (k--)
+          *dest++ = g.stack[--g.sp];
+      } else {
+        g.sp -= k;
+      }
+      continue;
+    }
+    // Next code, from as many sub-blocks of data as it takes
+    while (!g.done && (g.nBits < g.codeSize)) {
+      if (!g.blockLeft && !(g.blockLeft = readByte(g.in))) {
+        g.ended = g.done = true; // Block terminator, no more data
+        break;
+      }
+      g.bits |= (uint32_t)readByte(g.in) << g.nBits;
+      g.nBits += 8;
+      g.blockLeft--;
+    }
+    if (g.done || g.in.eof)
+      return IMAGE_ERR_FORMAT; // Out of data with pixels still to go
+    code = g.bits & ((1 << g.codeSize) - 1);
+    g.bits >>= g.codeSize;
+    g.nBits -= g.codeSize;
+
+    if (code == g.clear) { // Reset string table
+      g.codeSize = 0;
+      while ((1 << g.codeSize) <= g.clear)
+        g.codeSize++; // Minimum code size + 1
+      g.avail = g.clear + 2;
+      g.old = -1;
+    } else if (code == g.clear + 1) { // End of information
+      g.done = true;
+    } else if (g.old < 0) { // First code after clear is a single pixel
+      if (code > g.clear)
+        return IMAGE_ERR_FORMAT;
+      g.stack[g.sp++] = g.first = code;
+      g.old = code;
+    } else {
+      if (code > g.avail)
+        return IMAGE_ERR_FORMAT;
+      in = code;
+      if (code == g.avail) { // Code being defined: old string + its first
+        g.stack[g.sp++] = g.first;
+        code = g.old;
+      }
+      // Walk string back to its first pixel. Each table entry's prefix is
+      // an earlier code, so this ends, and fits the stack.
+      while (code > g.clear) {
+        g.stack[g.sp++] = g.suffix[code];
+        code = g.prefix[code];
+      }
+      g.stack[g.sp++] = g.first = code;
+      if (g.avail < GIF_CODES) { // Table full: codes stay 12 bits
+        g.prefix[g.avail] = g.old;
+        g.suffix[g.avail] = g.first;
+        if ((++g.avail == (1 << g.codeSize)) && (g.codeSize < 12))
+          g.codeSize++;
+      }
+      g.old = in;
+    }
+  }
+  return IMAGE_SUCCESS;
+}
+
+/*!
+    @brief   Decodes the next frame of an open GIF file directly to
+             Adafruit_SPITFT screen, or into RAM. Called by drawGIF(),
+             loadGIF() and drawGIFFrame().
+    @param   gif
+             Open GIF animation (see openGIF()).
+    @param   tft
+             Pointer to TFT object, if loading to screen, else NULL.
+    @param   dest
+             Working buffer for loading 16-bit TFT pixel data, if loading
+             to screen, else NULL.
+    @param   x
+             Horizontal offset in pixels of logical screen (if loading to
+             screen).
+    @param   y
+             Vertical offset in pixels (if loading to screen).
+    @param   img
+             Pointer to Adafruit_Image object, if loading to RAM (or NULL
+             if loading to screen).
+    @param   transact
+             Use SPI transactions; 'true' is needed only if loading to screen
+             and it's on the same SPI bus as the SD card.
+    @param   animate
+             If true (with tft), previous frame's disposal is done first and
+             transparent pixels are skipped, else the frame is drawn as a
+             still image.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS on successful
+             completion, other values on failure).
+*/
+ImageReturnCode Adafruit_ImageReader::gifFrame(GIFAnimation &gif,
+                                               Adafruit_SPITFT *tft,
+                                               uint16_t *dest, int16_t x,
+                                               int16_t y, Adafruit_Image *img,
+                                               boolean transact,
+                                               boolean animate) {
+  ImageReturnCode status = IMAGE_SUCCESS;
+  GIFDecoder *g = gif.decoder;     // Tables & decoding state (on heap)
+  uint8_t localbuf[3 * BUFPIXELS]; // Default file read buf
+  uint8_t *sdbuf = localbuf;       // File read buf
+  uint32_t sdbufSize = sizeof localbuf;
+  uint32_t destSize = BUFPIXELS; // Size of each dest buf, pixels
+  uint32_t destidx = 0;          // Pixels in dest
+  uint16_t *destAlt = NULL;      // Alternate TFT buffer (non-blocking writes)
+  uint16_t *canvas = NULL;       // Canvas pixels, if loading to 16-bit canvas
+  uint8_t *canvas8 = NULL;       // Canvas indices, if loading to 8-bit canvas
+  uint8_t *mask1 = NULL;         // Alpha mask, if loading with IMAGE_ALPHA_MASK
+  uint32_t maskStride = 0;       // Bytes per mask row
+  uint16_t *quantized = NULL;    // 565 palette for output
+  uint8_t *bgra;                 // Frame palette, B,G,R,A (in decoder stack)
+  uint8_t b, n;                  // Block type, sub-block size
+  uint8_t dispose = 0;           // Frame's disposal method
+  uint16_t delay = 0;            // Frame's delay, 1/100 sec
+  int16_t transparent = -1;      // Transparent color index, or -1 if none
+  int16_t skip = -1;             // Color index not drawn, or -1 if none
+  uint16_t left = 0, top = 0;    // Frame position on logical screen
+  uint16_t fw = 0, fh = 0;       // Frame size
+  uint16_t lw = 0, lh = 0;       // Frame size within logical screen
+  uint8_t flags = 0;             // GCE flags, then frame descriptor flags
+  boolean wrapped = false;       // Returned to first frame in this call
+  boolean windowed;              // Address window per run, not per frame
+  uint32_t row, i, j, k;         // Frame row, pixel indices
+  uint8_t pass = 0;              // Interlace pass
+  int32_t sx = 0, sy = 0;        // Screen position of visible area
+  int32_t loadWidth = 0, loadHeight = 0, // Region being loaded (clipped)
+      loadX = 0, loadY = 0;      // "
+  uint32_t startTime = 0;        // Timing for stats
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
+
+  if (img)
+    img->dealloc();
+
+  if (!g)
+    return IMAGE_ERR_FILE_NOT_FOUND; // Not open
+
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default file read buffer and (if drawing to TFT) dest buffers.
+  splitBuffer(tft ? DESTBUFS : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+#if DESTBUFS > 1
+  if (tft)
+    destAlt = &dest[destSize];
+#endif
+
+  file = gif.file; // Animation's file is current until done
+  g->in.buf = sdbuf;
+  g->in.bufSize = sdbufSize;
+  g->in.pos = g->in.len = 0;
+  g->in.filePos = gif.next;
+  g->in.eof = false;
+  g->in.tft = NULL;
+  g->in.transact = transact;
+  seekData(gif.next);
+
+  // Extensions up to the next image; only the graphic control extension
+  // (transparency, delay & disposal of that image) is of interest.
+  while ((b = readByte(g->in)) != 0x2C) { // Until image descriptor
+    if (b == 0x21) {                      // Extension
+      b = readByte(g->in);                // Label
+      while ((n = readByte(g->in)) && !g->in.eof) { // Each sub-block
+        if ((b == 0xF9) && (n >= 4)) {
+          flags = readByte(g->in);
+          dispose = (flags >> 2) & 7;
+          delay = readByte(g->in);
+          delay |= readByte(g->in) << 8;
+          b = readByte(g->in);
+          transparent = (flags & 1) ? b : -1;
+          n -= 4;
+          b = 0; // Any further sub-blocks are skipped
+        }
+        skipBytes(g->in, n);
+      }
+    } else if ((b == 0x3B) || g->in.eof) { // Trailer (or end of file)
+      if (!gif.frame || wrapped) {
+        status = IMAGE_ERR_FORMAT; // No frames
+        break;
+      }
+      wrapped = true; // Back to first frame
+      gif.frame = 0;
+      gif.loops++;
+      dispose = delay = 0;
+      transparent = -1;
+      g->in.pos = g->in.len = 0;
+      g->in.filePos = gif.start;
+      g->in.eof = false;
+      seekData(gif.start);
+    } else {
+      status = IMAGE_ERR_FORMAT;
+      break;
+    }
+  }
+
+  if (status == IMAGE_SUCCESS) {
+    // Image descriptor & local palette, if any, else global palette
+    left = readByte(g->in);
+    left |= readByte(g->in) << 8;
+    top = readByte(g->in);
+    top |= readByte(g->in) << 8;
+    fw = readByte(g->in);
+    fw |= readByte(g->in) << 8;
+    fh = readByte(g->in);
+    fh |= readByte(g->in) << 8;
+    flags = readByte(g->in);
+    bgra = g->stack; // Free until LZW decoding starts
+    memset(bgra, 0, 256 * 4);
+    for (i = 0; i < 256; i++) {
+      if ((flags & 0x80) ? (i < (2U << (flags & 7))) : (i < g->colors)) {
+        for (j = 3; j--;) // R,G,B -> B,G,R
+          bgra[i * 4 + j] =
+              (flags & 0x80) ? readByte(g->in) : g->global[i * 3 + 2 - j];
+      }
+      bgra[i * 4 + 3] = (i == (uint32_t)transparent) ? 0 : 255;
+    }
+    // LZW minimum code size (pixel bits, but at least 2)
+    b = readByte(g->in);
+    if (g->in.eof || (b < 2) || (b > 8) || !fw || !fh) {
+      status = IMAGE_ERR_FORMAT;
+    } else {
+      g->clear = 1 << b;
+      g->codeSize = b + 1;
+      g->avail = g->clear + 2;
+      g->old = -1;
+      g->sp = 0;
+      g->bits = g->nBits = g->blockLeft = 0;
+      g->ended = g->done = false;
+    }
+  }
+
+  if (status == IMAGE_SUCCESS) {
+    // Area of frame on logical screen
+    loadWidth = max(min((int32_t)fw, (int32_t)gif.width - left), (int32_t)0);
+    loadHeight = max(min((int32_t)fh, (int32_t)gif.height - top), (int32_t)0);
+    lw = loadWidth;
+    lh = loadHeight;
+    if (tft) {
+      // Crop area to be loaded (if destination is TFT)
+      sx = x + left;
+      sy = y + top;
+      if (sx < 0) {
+        loadX = -sx;
+        loadWidth += sx;
+        sx = 0;
+      }
+      if (sy < 0) {
+        loadY = -sy;
+        loadHeight += sy;
+        sy = 0;
+      }
+      if ((sx + loadWidth) > tft->width())
+        loadWidth = tft->width() - sx;
+      if ((sy + loadHeight) > tft->height())
+        loadHeight = tft->height() - sy;
+      quantized = g->quantized;
+      if (animate) { // Transparent pixels are skipped, not drawn
+        skip = transparent;
+        bgra8888To565(bgra, quantized, 256, IMAGE_ALPHA_IGNORE, 0, 0,
+                      TFT_BIGENDIAN);
+      } else {
+        bgra8888To565(bgra, quantized, 256, alphaMode, alphaThreshold,
+                      alphaColor, TFT_BIGENDIAN);
+      }
+    } else {
+      // Loading to RAM -- logical screen size, palette indices kept
+      // unless there's transparency to go in a mask
+      boolean alpha = (transparent >= 0) || left || top ||
+                      (fw < gif.width) || (fh < gif.height);
+      uint32_t size = (uint32_t)gif.width * gif.height;
+      status = IMAGE_ERR_MALLOC; // Assume won't fit to start
+      if (alpha && (alphaMode == IMAGE_ALPHA_MASK)) {
+        if ((img->canvas.canvas16 = new GFXcanvas16(gif.width, gif.height))) {
+          img->format = IMAGE_16; // dealloc() cleans up from here on
+          if ((canvas = img->canvas.canvas16->getBuffer()) &&
+              (img->mask = new GFXcanvas1(gif.width, gif.height)) &&
+              (mask1 = img->mask->getBuffer())) {
+            maskStride = (gif.width + 7) / 8; // (Zeroed by GFX)
+            quantized = g->quantized;         // Full color, alpha to mask
+            bgra8888To565(bgra, quantized, 256, IMAGE_ALPHA_IGNORE, 0, 0,
+                          false);
+            if (alphaThreshold) // Else transparent pixels count as opaque
+              skip = transparent;
+            status = IMAGE_SUCCESS;
+          }
+        }
+      } else if ((quantized = (uint16_t *)malloc(256 * sizeof(uint16_t)))) {
+        if ((img->canvas.canvas8 = new GFXcanvas8(gif.width, gif.height))) {
+          if ((canvas8 = img->canvas.canvas8->getBuffer())) {
+            img->format = IMAGE_8;
+            img->palette = quantized; // Keep palette with img
+            bgra8888To565(bgra, quantized, 256, alphaMode, alphaThreshold,
+                          alphaColor, false);
+            memset(canvas8, g->background, size); // Outside frame
+            status = IMAGE_SUCCESS;
+          } else {
+            delete img->canvas.canvas8;
+            img->canvas.canvas8 = NULL;
+            free(quantized);
+          }
+        } else {
+          free(quantized);
+        }
+      }
+    }
+  }
+
+  if (status == IMAGE_SUCCESS) {
+    if (stats)
+      stats->headerTime = micros() - startTime;
+    if (tft && animate && (gif.dispose == 2) && gif.lastW && gif.lastH) {
+      // Previous frame's area back to background
+      tft->fillRect(x + gif.lastX, y + gif.lastY, gif.lastW, gif.lastH,
+                    alphaColor);
+    }
+    gif.dispose = dispose;
+    gif.delay = delay * 10UL;
+    gif.lastX = left;
+    gif.lastY = top;
+    gif.lastW = lw;
+    gif.lastH = lh;
+  }
+
+  if ((status == IMAGE_SUCCESS) && (loadWidth > 0) && (loadHeight > 0)) {
+    // Interlaced rows arrive out of order, and transparent pixels leave
+    // gaps, so in those cases each run of pixels gets its own window.
+    windowed = tft && ((flags & 0x40) || (skip >= 0));
+    if (tft) {
+      tft->startWrite(); // Start SPI (regardless of transact)
+      if (!windowed)
+        tft->setAddrWindow(sx, sy, loadWidth, loadHeight);
+      g->in.tft = tft; // Reads end & restart the transaction if needed
+    }
+
+    for (i = 0, row = 0; i < fh; i++) {
+      boolean visible = (row >= (uint32_t)loadY) &&
+                        (row < (uint32_t)(loadY + loadHeight));
+      if (!visible) {
+        status = gifDecode(*g, NULL, fw);
+      } else if (((status = gifDecode(*g, NULL, loadX)) == IMAGE_SUCCESS) &&
+                 ((status = gifDecode(*g, g->line, loadWidth)) ==
+                  IMAGE_SUCCESS)) {
+        status = gifDecode(*g, NULL, fw - loadX - loadWidth);
+      }
+      if (status != IMAGE_SUCCESS)
+        break;
+
+      if (visible) {
+        const uint8_t *s = g->line;
+        if (canvas8) {
+          memcpy(&canvas8[(top + row) * gif.width + left], s, loadWidth);
+        } else if (canvas) {
+          uint32_t o = (top + row) * gif.width + left;
+          for (j = 0; j < (uint32_t)loadWidth; j++) {
+            canvas[o + j] = quantized[s[j]];
+            if (s[j] != skip)
+              mask1[(top + row) * maskStride + ((left + j) >> 3)] |=
+                  0x80 >> ((left + j) & 7);
+          }
+        } else {
+          // Runs of drawn pixels (whole row if nothing is skipped)
+          for (j = 0; j < (uint32_t)loadWidth; j = k) {
+            if (s[j] == skip) {
+              k = j + 1;
+              continue;
+            }
+            for (k = j + 1; (k < (uint32_t)loadWidth) && (s[k] != skip); k++)
+              ;
+            if (windowed) {
+              if (destidx) { // Previous run out before moving window
+                writeDest(tft, dest, destAlt, destidx);
+                destidx = 0;
+              }
+              tft->dmaWait();
+              tft->setAddrWindow(sx + j, sy + row - loadY, k - j, 1);
+            }
+            while (j < k) {
+              uint32_t span = min(k - j, destSize - destidx);
+              for (uint32_t p = 0; p < span; p++)
+                dest[destidx + p] = quantized[s[j + p]];
+              destidx += span;
+              j += span;
+              if (destidx >= destSize) {
+                writeDest(tft, dest, destAlt, destidx);
+                destidx = 0;
+              }
+            }
+          }
+        }
+      }
+
+      // Next row, in order or by interlace pass
+      if (flags & 0x40) {
+        row += gifPassStep[pass];
+        while ((row >= fh) && (++pass < 4))
+          row = gifPassStart[pass];
+      } else if (++row >= (uint32_t)(loadY + loadHeight)) {
+        break; // Rest is not visible
+      }
+    }
+
+    if (tft) {
+      if (destidx)
+        writeDest(tft, dest, destAlt, destidx);
+      tft->dmaWait();  // Wait for last non-blocking write
+      tft->endWrite(); // End TFT (regardless of transact)
+      g->in.tft = NULL;
+    }
+    if (stats && (status == IMAGE_SUCCESS))
+      stats->pixels = (uint32_t)loadWidth * loadHeight;
+  }
+
+  if (status == IMAGE_SUCCESS) {
+    // Skip rest of frame data, next call starts after it
+    if (!g->ended) {
+      skipBytes(g->in, g->blockLeft);
+      while ((n = readByte(g->in)) && !g->in.eof)
+        skipBytes(g->in, n);
+    }
+    gif.next = g->in.filePos - (g->in.len - g->in.pos);
+    gif.frame++;
+  }
+
+  if (img && (status != IMAGE_SUCCESS))
+    img->dealloc(); // Loaded partially or not at all
+  gif.file = file; // (Position has moved)
+  file = File32();
+  if (stats)
+    stats->totalTime = micros() - startTime;
+  return status;
+}
+
+/*!
+    @brief   Opens a raw or LZ4-compressed RGB565 image file and reads the
+             start of its header (4-byte signature, width and height). On
+             success the file is left open, positioned just past these.
+    @param   filename
+             Name of image file to open.
+    @param   magic
+             Expected 4-character signature ("R565" or "L565").
+    @param   width
+             Pointer to int32_t; image width in pixels, returned.
+    @param   height
+             Pointer to int32_t; image height in pixels, returned.
+    @return  One of the ImageReturnCode values (IMAGE_SUCCESS if the file
+             is open and valid).
+*/
+ImageReturnCode Adafruit_ImageReader::openRGB565(const char *filename,
+                                                 const char *magic,
+                                                 int32_t *width,
+                                                 int32_t *height) {
+  uint8_t header[8];
+
+  // No filesystem (reader constructed without one) -- cannot load by name.
+  if (!filesys || !(file = filesys->open(filename, FILE_READ)))
+    return IMAGE_ERR_FILE_NOT_FOUND;
+  if ((readData(header, sizeof header) == (int)sizeof header) &&
+      !memcmp(header, magic, 4)) {
+    *width = header[4] | (header[5] << 8);
+    *height = header[6] | (header[7] << 8);
+    if (*width && *height)
+      return IMAGE_SUCCESS;
+  }
+  file.close();
+  return IMAGE_ERR_FORMAT;
+}
+
+/*!
+    @brief   Reads next byte from currently-open File through an ImageInput
+             buffer, refilling it as needed (ending TFT SPI transaction
+             around the read if the input was so configured).
+    @param   in
+             Input state.
+    @return  Byte value, or 0 at end of file (with in.eof set).
+*/
+uint8_t Adafruit_ImageReader::readByte(ImageInput &in) {
+  if (in.pos >= in.len) { // Time to load more?
+    uint32_t n = in.bufSize;
+    if (n >= 1024) // Large buffer, end reads on a sector boundary
+      n -= (in.filePos + n) & 511;
+    if (in.tft && in.transact) {
+      in.tft->dmaWait();
+      in.tft->endWrite(); // End TFT SPI transaction
+    }
+    int32_t r = readData(in.buf, n);
+    if (in.tft && in.transact)
+      in.tft->startWrite(); // Start TFT SPI transaction
+    if (r <= 0) {
+      in.eof = true;
+      return 0;
+    }
+    in.filePos += r;
+    in.len = r;
+    in.pos = 0;
+  }
+  return in.buf[in.pos++];
+}
+
+/*!
+    @brief   Skips over bytes of currently-open File read through an
+             ImageInput buffer, seeking if they're not all in the buffer.
+             Like readByte(), ends and restarts the TFT transaction around
+             the seek if needed.
+    @param   in
+             Input state.
+    @param   n
+             Number of bytes to skip.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::skipBytes(ImageInput &in, uint32_t n) {
+  if (n <= in.len - in.pos) {
+    in.pos += n;
+  } else {
+    in.filePos += n - (in.len - in.pos);
+    if (in.tft && in.transact) {
+      in.tft->dmaWait();
+      in.tft->endWrite(); // End TFT SPI transaction
+    }
+    seekData(in.filePos);
+    if (in.tft && in.transact)
+      in.tft->startWrite(); // Start TFT SPI transaction
+    in.pos = in.len = 0;
+  }
+}
+
+/*!
+    @brief   Reads big-endian 32-bit value from currently-open File through
+             an ImageInput buffer.
+    @param   in
+             Input state.
+    @return  Unsigned 32-bit value.
+*/
+uint32_t Adafruit_ImageReader::readBE32(ImageInput &in) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < 4; i++)
+    v = (v << 8) | readByte(in);
+  return v;
+}
+
+/*!
+    @brief   Reads bytes from currently-open File, tallying decode
+             statistics if enabled (see setStats()).
+    @param   buf
+             Destination buffer.
+    @param   len
+             Number of bytes to read.
+    @return  Number of bytes actually read, or -1 on error.
+*/
+int Adafruit_ImageReader::readData(void *buf, uint32_t len) {
+  uint32_t t = stats ? micros() : 0;
+#if defined(ARDUINO_NRF52_ADAFRUIT)
+  // NRF52840 seems to have trouble reading more than 512 bytes across
+  // certain boundaries. Workaround for now is to break the read into
+  // smaller chunks...
+  int n = 0, bytesThisPass;
+  while (len > 0) {
+    bytesThisPass = file.read((uint8_t *)buf + n, min(len, (uint32_t)512));
+    if (bytesThisPass <= 0)
+      break;
+    n += bytesThisPass;
+    len -= bytesThisPass;
+  }
+#else
+  int n = file.read(buf, len);
+#endif
+  if (stats) {
+    stats->readTime += micros() - t;
+    stats->reads++;
+    if (n > 0)
+      stats->bytesRead += n;
+  }
+  return n;
+}
+
+/*!
+    @brief   Seeks to a position in currently-open File, tallying decode
+             statistics if enabled (see setStats()).
+    @param   pos
+             Absolute byte position in file.
+    @return  true on success, false on error.
+*/
+bool Adafruit_ImageReader::seekData(uint32_t pos) {
+  if (!stats)
+    return file.seek(pos);
+  uint32_t t = micros();
+  bool result = file.seek(pos);
+  stats->readTime += micros() - t;
+  stats->seeks++;
+  return result;
+}
+
+/*!
+    @brief   Divides the caller-provided working buffer (see setBuffer()),
+             if any, into a number of 16-bit pixel buffers followed by a
+             file read buffer sized to hold the same number of 24-bit
+             pixels. If no buffer was provided, or it's too small to be
+             of use, the passed-in default buffers are left as-is.
+    @param   nDest
+             Number of 16-bit pixel buffers needed (0 if none).
+    @param   dest
+             Pointer to first pixel buffer, returned.
+    @param   destSize
+             Pointer to size of each pixel buffer in pixels, returned.
+    @param   sdbuf
+             Pointer to file read buffer, returned.
+    @param   sdbufSize
+             Pointer to size of file read buffer in bytes, returned.
+    @return  true if the caller's buffer is in use, false if defaults.
+*/
+bool Adafruit_ImageReader::splitBuffer(uint8_t nDest, uint16_t **dest,
+                                       uint32_t *destSize, uint8_t **sdbuf,
+                                       uint32_t *sdbufSize) {
+  if (!scratch || (scratchSize < 32))
+    return false;
+
+  // Round start up to 32-bit boundary for the 16-bit buffers & SD reads
+  uint8_t *buf = (uint8_t *)(((uintptr_t)scratch + 3) & ~(uintptr_t)3);
+  uint32_t len = scratchSize - (buf - scratch);
+  uint32_t pixels = (len / (3 + 2 * nDest)) & ~1; // Even: keep alignment
+
+  if (nDest) {
+    *dest = (uint16_t *)buf;
+    *destSize = pixels;
+    buf += pixels * 2 * nDest;
+    len = pixels * 3;
+  }
+  // File reads are kept to a whole number of pixels at any depth (a
+  // multiple of 12 bytes), and of 512-byte sectors when large enough.
+  if (len >= 1536)
+    len -= len % 1536;
+  else
+    len -= len % 12;
+  *sdbuf = buf;
+  *sdbufSize = len;
+  return true;
+}
+
+/*!
+    @brief   Writes a block of converted pixels to the TFT. If an alternate
+             working buffer is available, the write is non-blocking (DMA on
+             devices that support it) and the two buffers are exchanged, so
+             the caller can fill one while the other is still going out.
+             Any prior non-blocking write is finished first, which also
+             makes the newly-returned buffer safe to overwrite. Long runs
+             of one color are sent as fills if enabled (see setRunFill()).
+    @param   tft
+             Pointer to TFT object (caller has started the SPI transaction).
+    @param   dest
+             Buffer of 16-bit pixels to write; on return, the buffer to
+             use next (swapped with destAlt if non-NULL).
+    @param   destAlt
+             Alternate working buffer, or NULL for blocking writes only.
+    @param   len
+             Number of pixels in dest.
+    @return  None (void).
+*/
+void Adafruit_ImageReader::writeDest(Adafruit_SPITFT *tft, uint16_t *&dest,
+                                     uint16_t *&destAlt, uint32_t len) {
+  uint32_t t = stats ? micros() : 0;
+  uint32_t start = 0; // First pixel not yet written
+  tft->dmaWait(); // Previous write (from other buffer) must be finished
+  if (runFill) {
+    // Long runs of one color go out as writeColor(), pixels ahead of each
+    // run as a blocking write (the run can't start until they're sent).
+    uint32_t i = 0, j;
+    uint16_t c;
+    while (i < len) {
+      c = dest[i];
+      for (j = i + 1; (j < len) && (dest[j] == c); j++)
+        ;
+      if (j - i >= runFill) {
+        if (i > start)
+          tft->writePixels(&dest[start], i - start, true, TFT_BIGENDIAN);
+        if (TFT_BIGENDIAN) // writeColor() takes native order
+          c = (c >> 8) | (c << 8);
+        tft->writeColor(c, j - i);
+        start = j;
+      }
+      i = j;
+    }
+  }
+  len -= start; // Pixels following the last fill (all, if none)
+  if (destAlt) {
+    if (len) // Non-blocking write
+      tft->writePixels(&dest[start], len, false, TFT_BIGENDIAN);
+    uint16_t *tmp = dest; // and swap buffers
+    dest = destAlt;
+    destAlt = tmp;
+  } else if (len) {
+    tft->writePixels(&dest[start], len, true, TFT_BIGENDIAN); // Blocking
+  }
+  if (stats)
+    stats->writeTime += micros() - t;
+}
+
 /*!
     @brief   Reads a little-endian 16-bit unsigned value from currently-
              open File, converting if necessary to the microcontroller's
@@ -697,11 +5344,13 @@ uint16_t Adafruit_ImageReader::readLE16(void) {
     (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
   // Read directly into result -- BMP data and variable both little-endian.
   uint16_t result;
-  file.read(&result, sizeof result);
+  readData(&result, sizeof result);
   return result;
 #else
-  // Big-endian or unknown. Byte-by-byte read will perform reversal if needed.
-  return file.read() | ((uint16_t)file.read() << 8);
+  // Big-endian or unknown. Byte-by-byte assembly performs reversal if needed.
+  uint8_t buf[2];
+  readData(buf, sizeof buf);
+  return readLE16(buf);
 #endif
 }
 
@@ -716,12 +5365,13 @@ uint32_t Adafruit_ImageReader::readLE32(void) {
     (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
   // Read directly into result -- BMP data and variable both little-endian.
   uint32_t result;
-  file.read(&result, sizeof result);
+  readData(&result, sizeof result);
   return result;
 #else
-  // Big-endian or unknown. Byte-by-byte read will perform reversal if needed.
-  return file.read() | ((uint32_t)file.read() << 8) |
-         ((uint32_t)file.read() << 16) | ((uint32_t)file.read() << 24);
+  // Big-endian or unknown. Byte-by-byte assembly performs reversal if needed.
+  uint8_t buf[4];
+  readData(buf, sizeof buf);
+  return readLE32(buf);
 #endif
 }
 
@@ -26,12 +26,39 @@ enum ImageReturnCode {
   IMAGE_ERR_MALLOC          // Could not allocate image (loadBMP() only)
 };
 
+/*!
+   @brief  Optional decode statistics, filled in by the image-reading
+           functions when a pointer has been passed to
+           Adafruit_ImageReader::setStats(). All fields are cleared at the
+           start of each drawBMP() or loadBMP() call. Time spent converting
+           pixels is whatever remains of totalTime after the other three
+           time fields are subtracted.
+*/
+typedef struct {
+  uint32_t reads;      ///< Number of file read() calls
+  uint32_t seeks;      ///< Number of file seek() calls
+  uint32_t bytesRead;  ///< Total bytes read from file
+  uint32_t pixels;     ///< Pixels delivered to display or canvas
+  uint32_t headerTime; ///< Microseconds to open file, parse header & palette
+  uint32_t readTime;   ///< Microseconds in pixel data reads & seeks
+  uint32_t writeTime;  ///< Microseconds pushing pixels to display
+  uint32_t totalTime;  ///< Microseconds for the whole call
+} ImageReaderStats;
+
+/** Handling of the alpha channel in 32-bit BMPs, see setAlpha() */
+enum ImageAlphaMode {
+  IMAGE_ALPHA_IGNORE, // All pixels are drawn opaque (default)
+  IMAGE_ALPHA_MASK,   // Alpha is thresholded into a 1-bit mask
+  IMAGE_ALPHA_BLEND   // Pixels are blended against a background color
+};
+
 /** Image formats returned by loadBMP() */
 enum ImageFormat {
   IMAGE_NONE, // No image was loaded; IMAGE_ERR_* condition
   IMAGE_1,    // GFXcanvas1 image (NOT YET SUPPORTED)
-  IMAGE_8,    // GFXcanvas8 image (NOT YET SUPPORTED)
-  IMAGE_16    // GFXcanvas16 image (SUPPORTED)
+  IMAGE_8,    // GFXcanvas8 image, with 565 color palette (SUPPORTED)
+  IMAGE_16,   // GFXcanvas16 image (SUPPORTED)
+  IMAGE_4     // 4bpp image, two pixels/byte in a GFXcanvas8, with palette
 };
 
 /*!
@@ -48,8 +75,10 @@ public:
   /*!
       @brief   Return canvas image format.
       @return  An ImageFormat type: IMAGE_1 for a GFXcanvas1, IMAGE_8 for
-               a GFXcanvas8, IMAGE_16 for a GFXcanvas16, IMAGE_NONE if no
-               canvas currently allocated.
+               a GFXcanvas8, IMAGE_16 for a GFXcanvas16, IMAGE_4 for a
+               GFXcanvas8 holding two pixels per byte (high nibble first,
+               so the canvas is half the image width, rounded up),
+               IMAGE_NONE if no canvas currently allocated.
   */
   ImageFormat getFormat(void) const { return (ImageFormat)format; }
   void *getCanvas(void) const;
@@ -70,16 +99,46 @@ protected:
   // MOST OF THESE ARE NOT SUPPORTED YET -- WIP
   union {                  // Single pointer, only one variant is used:
     GFXcanvas1 *canvas1;   ///< Canvas object if 1bpp format
-    GFXcanvas8 *canvas8;   ///< Canvas object if 8bpp format
+    GFXcanvas8 *canvas8;   ///< Canvas object if 8bpp (or 4bpp) format
     GFXcanvas16 *canvas16; ///< Canvas object if 16bpp
   } canvas;                ///< Union of different GFXcanvas types
   GFXcanvas1 *mask;        ///< 1bpp image mask (or NULL)
-  uint16_t *palette;       ///< Color palette for 8bpp image (or NULL)
+  uint16_t *palette;       ///< Color palette for 1-8bpp image (or NULL)
   uint8_t format;          ///< Canvas bundle type in use
+  int16_t width4;          ///< Image width if 4bpp (canvas is half as wide)
   void dealloc(void);      ///< Free/deinitialize variables
   friend class Adafruit_ImageReader; ///< Loading occurs here
 };
 
+struct ImageInput;  // Buffered file input, see Adafruit_ImageReader.cpp
+struct JPEGDecoder; // JPEG decoding state, "
+struct JPEGHuffman; // JPEG Huffman table, "
+struct PNGDecoder;  // PNG decoding state, "
+struct PNGHuffman;  // PNG (inflate) Huffman table, "
+struct GIFDecoder;  // GIF decoding state, "
+
+/*!
+   @brief  A GIF file open for playing frame by frame, see
+           Adafruit_ImageReader::openGIF() and drawGIFFrame(). Keep it
+           (e.g. global or static) from one frame to the next. The first
+           five fields may be read by the caller; all are maintained by
+           the reader.
+*/
+typedef struct {
+  uint16_t width;              ///< Logical screen (whole image) width
+  uint16_t height;             ///< Logical screen height
+  uint16_t frame;              ///< Number of next frame (0 = first)
+  uint16_t loops;              ///< Times the animation has started over
+  uint32_t delay;              ///< Milliseconds to show last frame drawn
+  File32 file;                 ///< GIF file, open until closeGIF()
+  GIFDecoder *decoder = NULL;  ///< Decoding state & tables, or NULL
+  uint32_t start;              ///< File position of first frame
+  uint32_t next;               ///< File position of next frame
+  uint16_t lastX, lastY;       ///< Position of last frame on logical screen
+  uint16_t lastW, lastH;       ///< Size of last frame (clipped to screen)
+  uint8_t dispose;             ///< Disposal method of last frame
+} GIFAnimation;
+
 /*!
    @brief  An optional adjunct to Adafruit_SPITFT that reads RGB BMP
            images (maybe others in the future) from a flash filesystem
@@ -103,14 +162,114 @@ public:
   ImageReturnCode bmpDimensions(const char *filename, int32_t *w, int32_t *h);
   ImageReturnCode bmpDimensions(const uint8_t *bmp, size_t bmp_len, int32_t *w,
                                 int32_t *h);
+  ImageReturnCode drawRGB565(const char *filename, Adafruit_SPITFT &tft,
+                             int16_t x, int16_t y, boolean transact = true);
+  ImageReturnCode loadRGB565(const char *filename, Adafruit_Image &img);
+  ImageReturnCode rgb565Dimensions(const char *filename, int32_t *w,
+                                   int32_t *h);
+  ImageReturnCode drawLZ565(const char *filename, Adafruit_SPITFT &tft,
+                            int16_t x, int16_t y, boolean transact = true);
+  ImageReturnCode loadLZ565(const char *filename, Adafruit_Image &img);
+  ImageReturnCode lz565Dimensions(const char *filename, int32_t *w,
+                                  int32_t *h);
+  ImageReturnCode drawJPEG(const char *filename, Adafruit_SPITFT &tft,
+                           int16_t x, int16_t y, uint8_t scale = 0,
+                           boolean transact = true);
+  ImageReturnCode loadJPEG(const char *filename, Adafruit_Image &img,
+                           uint8_t scale = 0);
+  ImageReturnCode jpegDimensions(const char *filename, int32_t *w,
+                                 int32_t *h);
+  ImageReturnCode drawPNG(const char *filename, Adafruit_SPITFT &tft, int16_t x,
+                          int16_t y, boolean transact = true);
+  ImageReturnCode loadPNG(const char *filename, Adafruit_Image &img);
+  ImageReturnCode pngDimensions(const char *filename, int32_t *w, int32_t *h);
+  ImageReturnCode drawQOI(const char *filename, Adafruit_SPITFT &tft, int16_t x,
+                          int16_t y, boolean transact = true);
+  ImageReturnCode loadQOI(const char *filename, Adafruit_Image &img);
+  ImageReturnCode qoiDimensions(const char *filename, int32_t *w, int32_t *h);
+  ImageReturnCode drawGIF(const char *filename, Adafruit_SPITFT &tft, int16_t x,
+                          int16_t y, boolean transact = true);
+  ImageReturnCode loadGIF(const char *filename, Adafruit_Image &img);
+  ImageReturnCode gifDimensions(const char *filename, int32_t *w, int32_t *h);
+  ImageReturnCode openGIF(const char *filename, GIFAnimation &gif);
+  ImageReturnCode drawGIFFrame(GIFAnimation &gif, Adafruit_SPITFT &tft,
+                               int16_t x, int16_t y, boolean transact = true);
+  void closeGIF(GIFAnimation &gif);
   void printStatus(ImageReturnCode stat, Stream &stream = Serial);
+  /*!
+      @brief   Enable or disable collection of decode statistics.
+      @param   s  Pointer to ImageReaderStats structure to be filled in by
+                  subsequent image-reading calls, or NULL to disable.
+      @return  None (void).
+  */
+  void setStats(ImageReaderStats *s) { stats = s; }
+  void setBuffer(void *buf, uint32_t len);
+  void setReverseScan(int16_t madctl, int16_t offset = 0);
+  void setAlpha(ImageAlphaMode mode, uint16_t background = 0x0000,
+                uint8_t threshold = 128);
+  void setRunFill(uint16_t minRun);
 
 protected:
-  FatVolume *filesys; ///< FAT FileSystem Object
-  File32 file;        ///< Current Open file
+  FatVolume *filesys;      ///< FAT FileSystem Object
+  File32 file;             ///< Current Open file
+  ImageReaderStats *stats; ///< Decode statistics (or NULL)
+  uint8_t *scratch;        ///< Caller-provided working buffer (or NULL)
+  uint32_t scratchSize;    ///< Size of scratch buffer in bytes
+  int16_t scanMADCTL;      ///< TFT MADCTL value for reverse scan, or -1
+  int16_t scanOffset;      ///< Rows added to mirrored window, reverse scan
+  uint8_t alphaMode;       ///< ImageAlphaMode for 32-bit BMPs
+  uint8_t alphaThreshold;  ///< Minimum alpha for opaque, IMAGE_ALPHA_MASK
+  uint16_t alphaColor;     ///< 565 color behind transparent pixels
+  uint16_t runFill;        ///< Min. run for writeColor() in TFT draws, or 0
   ImageReturnCode coreBMP(const char *filename, Adafruit_SPITFT *tft,
                           uint16_t *dest, int16_t x, int16_t y,
                           Adafruit_Image *img, boolean transact);
+  void rleBMP(Adafruit_SPITFT *tft, uint16_t *&dest, uint16_t *&destAlt,
+              uint32_t destSize, uint8_t *dest1, uint8_t *sdbuf,
+              uint32_t sdbufSize, uint16_t *palette, uint8_t depth,
+              int bmpWidth, int bmpHeight, int16_t x, int16_t y, int loadX,
+              int loadY, int loadWidth, int loadHeight, boolean transact);
+  bool splitBuffer(uint8_t nDest, uint16_t **dest, uint32_t *destSize,
+                   uint8_t **sdbuf, uint32_t *sdbufSize);
+  void writeDest(Adafruit_SPITFT *tft, uint16_t *&dest, uint16_t *&destAlt,
+                 uint32_t len);
+  ImageReturnCode openRGB565(const char *filename, const char *magic,
+                             int32_t *w, int32_t *h);
+  ImageReturnCode coreLZ565(const char *filename, Adafruit_SPITFT *tft,
+                            int16_t x, int16_t y, Adafruit_Image *img,
+                            boolean transact);
+  ImageReturnCode coreJPEG(const char *filename, Adafruit_SPITFT *tft,
+                           uint16_t *dest, int16_t x, int16_t y,
+                           Adafruit_Image *img, uint8_t scale,
+                           boolean transact);
+  ImageReturnCode jpegHeader(JPEGDecoder &j, boolean dimsOnly);
+  uint16_t jpegWord(JPEGDecoder &j);
+  void jpegFill(JPEGDecoder &j);
+  int16_t jpegHuff(JPEGDecoder &j, const JPEGHuffman &h);
+  int8_t jpegBlock(JPEGDecoder &j, uint8_t c, int16_t *coef, uint8_t n);
+  ImageReturnCode corePNG(const char *filename, Adafruit_SPITFT *tft,
+                          uint16_t *dest, int16_t x, int16_t y,
+                          Adafruit_Image *img, boolean transact);
+  ImageReturnCode pngHeader(PNGDecoder &p);
+  uint8_t pngByte(PNGDecoder &p);
+  uint32_t pngBits(PNGDecoder &p, uint8_t n);
+  int16_t pngHuff(PNGDecoder &p, const PNGHuffman &h);
+  ImageReturnCode pngInflate(PNGDecoder &p, uint8_t *dest, uint32_t n);
+  ImageReturnCode openQOI(const char *filename, int32_t *w, int32_t *h,
+                          uint8_t *channels);
+  ImageReturnCode coreQOI(const char *filename, Adafruit_SPITFT *tft,
+                          uint16_t *dest, int16_t x, int16_t y,
+                          Adafruit_Image *img, boolean transact);
+  ImageReturnCode gifFrame(GIFAnimation &gif, Adafruit_SPITFT *tft,
+                           uint16_t *dest, int16_t x, int16_t y,
+                           Adafruit_Image *img, boolean transact,
+                           boolean animate);
+  ImageReturnCode gifDecode(GIFDecoder &g, uint8_t *dest, uint32_t n);
+  uint8_t readByte(ImageInput &in);
+  void skipBytes(ImageInput &in, uint32_t n);
+  uint32_t readBE32(ImageInput &in);
+  int readData(void *buf, uint32_t len);
+  bool seekData(uint32_t pos);
   uint16_t readLE16(void);
   uint32_t readLE32(void);
   uint16_t readLE16(const uint8_t *buf);
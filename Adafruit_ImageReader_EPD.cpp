@@ -86,6 +86,69 @@ uint8_t Adafruit_ImageReader_EPD::mapColorForDisplay(uint8_t r, uint8_t g,
   }
 }
 
+/*!
+    @brief   Fills in a color lookup table for one display mode, for use
+             with mapColor() and mapColors().
+    @param   map
+             Table to fill in.
+    @param   mode
+             The display mode (THINKINK_MONO, THINKINK_TRICOLOR, etc.).
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::initColorMap(EPDColorMap &map,
+                                            thinkinkmode_t mode) {
+  map.mode = mode;
+  // Monochrome and grayscale threshold the average of R, G and B, other
+  // modes threshold each channel
+  map.sum = (mode == THINKINK_MONO) || (mode == THINKINK_MONO_PARTIAL) ||
+            (mode == THINKINK_GRAYSCALE4);
+#if EPD_COLORMAP
+  int i, s;
+  if (map.sum) {
+    for (i = 0; i <= 765 / 64; i++) { // Any R, G, B adding up to i * 64
+      s = i * 64;
+      map.color[i] = mapColorForDisplay(min(s, 255), min(s, 510) - min(s, 255),
+                                        s - min(s, 510), mode);
+    }
+  } else {
+    for (i = 0; i < EPD_COLORMAP; i++) { // Lowest R, G, B in each bin
+      map.color[i] = mapColorForDisplay((i >> 6) << 5, ((i >> 3) & 7) << 5,
+                                        (i & 7) << 5, mode);
+    }
+  }
+#endif
+}
+
+/*!
+    @brief   Maps a run of BMP pixels to EPD display colors.
+    @param   map
+             Table from initColorMap() for the display's mode.
+    @param   bgr
+             Pixel data, 3 bytes (blue, green, red) per pixel.
+    @param   dest
+             EPD colors out, one per pixel.
+    @param   n
+             Number of pixels.
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::mapColors(const EPDColorMap &map,
+                                         const uint8_t *bgr, uint16_t *dest,
+                                         uint32_t n) {
+#if EPD_COLORMAP
+  if (map.sum) {
+    for (; n--; bgr += 3)
+      *dest++ = map.color[(bgr[0] + bgr[1] + bgr[2]) >> 6];
+  } else {
+    for (; n--; bgr += 3)
+      *dest++ = map.color[((bgr[2] >> 5) << 6) | ((bgr[1] >> 5) << 3) |
+                          (bgr[0] >> 5)];
+  }
+#else
+  for (; n--; bgr += 3)
+    *dest++ = mapColorForDisplay(bgr[2], bgr[1], bgr[0], map.mode);
+#endif
+}
+
 /*!
     @brief   Draw image to an Adafruit ePaper-type display.
     @param   epd
@@ -120,10 +183,36 @@ void Adafruit_Image_EPD::draw(Adafruit_EPD &epd, int16_t x, int16_t y) {
       }
       buffer++;
     };
-  } else if (format == IMAGE_8) {
+  } else if ((format == IMAGE_8) || (format == IMAGE_4)) {
+    // Palette is 565 (as loadBMP() makes it); map each entry to the
+    // display's colors once, then unpack pixels through it.
+    uint8_t *buffer = canvas.canvas8->getBuffer();
+    int16_t stride = canvas.canvas8->width(); // Bytes per row
+    int16_t w = width(), h = canvas.canvas8->height();
+    uint16_t n = (format == IMAGE_8) ? 256 : 16, i;
+    uint8_t colors[256];
+    EPDColorMap colorMap;
+    if (!palette)
+      return;
+    Adafruit_ImageReader_EPD::initColorMap(colorMap, epd.getMode());
+    for (i = 0; i < n; i++) {
+      colors[i] = Adafruit_ImageReader_EPD::mapColor(
+          colorMap, (palette[i] & 0xf800) >> 8, (palette[i] & 0x07e0) >> 3,
+          (palette[i] & 0x001f) << 3);
+    }
+    for (row = 0; row < h; row++, buffer += stride) {
+      for (col = 0; col < w; col++) {
+        if (format == IMAGE_8)
+          i = buffer[col];
+        else // Left pixel in high nibble
+          i = (buffer[col >> 1] >> ((col & 1) ? 0 : 4)) & 0x0F;
+        epd.writePixel(x + col, y + row, colors[i]);
+      }
+    }
   } else if (format == IMAGE_16) {
     uint16_t *buffer = canvas.canvas16->getBuffer();
-    thinkinkmode_t displayMode = epd.getMode();
+    EPDColorMap colorMap;
+    Adafruit_ImageReader_EPD::initColorMap(colorMap, epd.getMode());
 
     while (row < y + canvas.canvas16->height()) {
       // RGB in 565 format
@@ -131,8 +220,7 @@ void Adafruit_Image_EPD::draw(Adafruit_EPD &epd, int16_t x, int16_t y) {
       uint8_t g = (*buffer & 0x07e0) >> 3;
       uint8_t b = (*buffer & 0x001f) << 3;
 
-      uint8_t c =
-          Adafruit_ImageReader_EPD::mapColorForDisplay(r, g, b, displayMode);
+      uint8_t c = Adafruit_ImageReader_EPD::mapColor(colorMap, r, g, b);
 
       epd.writePixel(col, row, c);
       col++;
@@ -145,6 +233,282 @@ void Adafruit_Image_EPD::draw(Adafruit_EPD &epd, int16_t x, int16_t y) {
   }
 }
 
+// EPD DITHERING ***************************************************************
+
+/*!
+   @brief  Dithering state for one drawBMP() call, set up by initDither().
+           Pixels are processed in rows, left to right, with ditherRow()
+           called at the start of each row. Modes that threshold the
+           average of the channels (see initColorMap()) are dithered on
+           the R+G+B sum, others on each of R, G and B.
+           Error diffusion quantizes through the color table, and passes
+           on the difference from the chosen EPD color's level. Ordered
+           dithering picks between evenly spaced levels instead (0 and
+           255 per channel; black, dark, light and white grays; or black
+           and white), as the table's thresholds aren't midway between
+           the EPD colors.
+*/
+struct EPDDither {
+  uint8_t mode = EPD_DITHER_NONE; ///< EPDDitherMode
+  const EPDColorMap *map;         ///< Color table for the display mode
+  uint8_t channels;               ///< 1 (R+G+B sum) or 3 (R, G, B)
+  int16_t max;                    ///< Largest channel value
+  int16_t level[8][3];            ///< Channel values of each EPD color
+  int16_t step;                   ///< Ordered dither level spacing
+  uint8_t ordered[8];             ///< EPD color of each ordered level
+  int16_t *buf = NULL;            ///< Error term allocation
+  int16_t *err;     ///< Error into this row (Floyd-Steinberg: & next row)
+  int16_t *errNext; ///< Error into next row (Atkinson)
+  int16_t carry[2][3]; ///< Error into next pixel(s) in this row
+  int16_t below[2][3]; ///< Next row's error held back (Floyd-Steinberg)
+  int16_t bayer[4];    ///< Ordered dither offsets for this row
+  int16_t width;       ///< Pixels per row
+  int16_t col, row;    ///< Position of next pixel
+};
+
+/*!
+    @brief   Maps channel values (after dithering) to an EPD color.
+    @param   map
+             Table from initColorMap() for the display's mode.
+    @param   v
+             R+G+B sum (0-765) if map.sum is set, else R, G, B (0-255).
+    @return  EPD color constant for the display mode.
+*/
+static inline uint8_t ditherColor(const EPDColorMap &map, const int16_t *v) {
+#if EPD_COLORMAP
+  return map.color[map.sum ? (v[0] >> 6)
+                           : (((v[0] >> 5) << 6) | ((v[1] >> 5) << 3) |
+                              (v[2] >> 5))];
+#else
+  if (map.sum) // Any R, G, B adding up to v[0] maps the same
+    return Adafruit_ImageReader_EPD::mapColorForDisplay(
+        min((int)v[0], 255), min((int)v[0], 510) - min((int)v[0], 255),
+        v[0] - min((int)v[0], 510), map.mode);
+  return Adafruit_ImageReader_EPD::mapColorForDisplay(v[0], v[1], v[2],
+                                                      map.mode);
+#endif
+}
+
+/*!
+    @brief   Sets up dithering for one draw, using the current setDither()
+             mode.
+    @param   d
+             Dithering state to set up.
+    @param   map
+             Table from initColorMap() for the display's mode.
+    @param   width
+             Pixels per row.
+    @return  IMAGE_SUCCESS, or IMAGE_ERR_MALLOC if the error terms for
+             error diffusion couldn't be allocated.
+*/
+ImageReturnCode Adafruit_ImageReader_EPD::initDither(EPDDither &d,
+                                                     const EPDColorMap &map,
+                                                     int16_t width) {
+  uint8_t c, r, g, b;
+  int16_t v[3] = {0, 0, 0};
+  uint32_t n;
+
+  d.mode = ditherMode;
+  d.map = &map;
+  d.channels = map.sum ? 1 : 3;
+  d.max = map.sum ? 765 : 255;
+  d.width = width;
+  d.col = d.row = 0;
+  // Channel values of each EPD color, for the error left by a pixel
+  for (c = 0; c < 8; c++) {
+    r = g = b = 0xFF; // EPD_WHITE (or anything unexpected)
+    if (c == EPD_BLACK) {
+      r = g = b = 0x00;
+    } else if (c == EPD_DARK) {
+      r = g = b = 0x55;
+    } else if (c == EPD_LIGHT) {
+      r = g = b = 0xAA;
+    } else if (c == EPD_RED) {
+      g = b = 0x00;
+    } else if (c == EPD_YELLOW) {
+      b = 0x00;
+    }
+    if (map.sum) {
+      d.level[c][0] = r + g + b;
+    } else {
+      d.level[c][0] = r;
+      d.level[c][1] = g;
+      d.level[c][2] = b;
+    }
+  }
+  // Ordered dithering levels (per channel, or for the R+G+B sum) & colors
+  if (map.sum) {
+    d.step = (map.mode == THINKINK_GRAYSCALE4) ? 255 : 765;
+    for (c = 0; c < 4; c++) {
+      v[0] = min(c * d.step, 765);
+      d.ordered[c] = ditherColor(map, v);
+    }
+  } else {
+    d.step = 256; // Channel + offset of 0 to 255 rounds with >> 8
+    for (c = 0; c < 8; c++) {
+      v[0] = (c & 4) ? 255 : 0;
+      v[1] = (c & 2) ? 255 : 0;
+      v[2] = (c & 1) ? 255 : 0;
+      d.ordered[c] = ditherColor(map, v);
+    }
+  }
+  // Error terms, with a spare pixel at each end of a row for the
+  // neighbors of the first & last pixel
+  if ((d.mode == EPD_DITHER_FLOYD_STEINBERG) ||
+      (d.mode == EPD_DITHER_ATKINSON)) {
+    n = (uint32_t)(width + 2) * d.channels;
+    if (!(d.buf = (int16_t *)calloc(
+              (d.mode == EPD_DITHER_ATKINSON) ? n * 2 : n, sizeof(int16_t))))
+      return IMAGE_ERR_MALLOC;
+    d.err = d.buf;
+    d.errNext = (d.mode == EPD_DITHER_ATKINSON) ? &d.buf[n] : NULL;
+  }
+  return IMAGE_SUCCESS;
+}
+
+/*!
+    @brief   Starts the next row of dithering.
+    @param   d
+             Dithering state from initDither().
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::ditherRow(EPDDither &d) {
+  // Bayer 4x4 threshold map
+  static const uint8_t bayer[4][4] = {
+      {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+  int16_t *t;
+  uint8_t c;
+
+  if (d.col) { // Finish prior row
+    if (d.mode == EPD_DITHER_FLOYD_STEINBERG) {
+      for (c = 0; c < d.channels; c++) // Last pixel's share below
+        d.err[d.col * d.channels + c] = d.below[0][c];
+    } else if (d.mode == EPD_DITHER_ATKINSON) {
+      t = d.err; // Next row's error becomes this row's, and
+      d.err = d.errNext; // this row's buffer (holding error two rows
+      d.errNext = t;     // down) continues as the next row's
+      for (c = 0; c < d.channels; c++) {
+        t[c] = 0; // Spare pixels, outside the row
+        t[(d.width + 1) * d.channels + c] = 0;
+      }
+    }
+  }
+  memset(d.carry, 0, sizeof d.carry);
+  memset(d.below, 0, sizeof d.below);
+  // Offsets of 1/32 to 31/32 of the step between levels
+  for (c = 0; c < 4; c++)
+    d.bayer[c] = ((2 * bayer[d.row & 3][c] + 1) * d.step) / 32;
+  d.col = 0;
+  d.row++;
+}
+
+/*!
+    @brief   Dithers one pixel to an EPD color.
+    @param   d
+             Dithering state from initDither().
+    @param   r
+             Red component of the color (0-255).
+    @param   g
+             Green component of the color (0-255).
+    @param   b
+             Blue component of the color (0-255).
+    @return  EPD color constant for the display mode.
+*/
+uint8_t Adafruit_ImageReader_EPD::ditherPixel(EPDDither &d, uint8_t r,
+                                              uint8_t g, uint8_t b) {
+  int16_t v[3], e, *err, *next;
+  uint8_t c, color;
+
+  if (d.mode == EPD_DITHER_ORDERED) { // See ditherColors()
+    e = d.bayer[d.col++ & 3];
+    if (d.channels == 1) {
+      e += r + g + b;
+      return d.ordered[(e >= d.step) + (e >= 2 * d.step) + (e >= 3 * d.step)];
+    }
+    return d.ordered[(((r + e) >> 8) << 2) | (((g + e) >> 8) << 1) |
+                     ((b + e) >> 8)];
+  }
+
+  if (d.channels == 1) {
+    v[0] = r + g + b;
+  } else {
+    v[0] = r;
+    v[1] = g;
+    v[2] = b;
+  }
+  err = &d.err[(d.col + 1) * d.channels]; // This pixel's error terms
+  for (c = 0; c < d.channels; c++) {
+    v[c] += err[c] + d.carry[0][c];
+    if (v[c] < 0)
+      v[c] = 0;
+    else if (v[c] > d.max)
+      v[c] = d.max;
+  }
+  color = ditherColor(*d.map, v);
+
+  for (c = 0; c < d.channels; c++) {
+    e = v[c] - d.level[color & 7][c];
+    if (d.mode == EPD_DITHER_FLOYD_STEINBERG) {
+      // 7/16 right, 3/16 below left, 5/16 below, 1/16 below right. The
+      // previous pixel's slot has been used and takes its next row
+      // error; this one's and the next are held until then.
+      d.carry[0][c] = e * 7 / 16;
+      err[c - d.channels] = d.below[0][c] + e * 3 / 16;
+      d.below[0][c] = d.below[1][c] + e * 5 / 16;
+      d.below[1][c] = e / 16;
+    } else {
+      // 1/8 to each of the next 2 pixels, 3 below and 1 two rows down
+      e /= 8;
+      next = &d.errNext[(d.col + 1) * d.channels];
+      d.carry[0][c] = d.carry[1][c] + e;
+      d.carry[1][c] = e;
+      next[c - d.channels] += e;
+      next[c] += e;
+      next[c + d.channels] += e;
+      err[c] = e; // This row's buffer is two rows down's next time
+    }
+  }
+  d.col++;
+  return color;
+}
+
+/*!
+    @brief   Dithers a run of BMP pixels to EPD display colors.
+    @param   d
+             Dithering state from initDither().
+    @param   bgr
+             Pixel data, 3 bytes (blue, green, red) per pixel.
+    @param   dest
+             EPD colors out, one per pixel.
+    @param   n
+             Number of pixels.
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::ditherColors(EPDDither &d, const uint8_t *bgr,
+                                            uint16_t *dest, uint32_t n) {
+  int o;
+
+  if (d.mode == EPD_DITHER_ORDERED) {
+    // Same work per pixel as mapColors(), plus the offset
+    if (d.channels == 1) {
+      for (; n--; bgr += 3) {
+        o = bgr[0] + bgr[1] + bgr[2] + d.bayer[d.col++ & 3];
+        *dest++ = d.ordered[(o >= d.step) + (o >= 2 * d.step) +
+                            (o >= 3 * d.step)];
+      }
+    } else {
+      for (; n--; bgr += 3) {
+        o = d.bayer[d.col++ & 3];
+        *dest++ = d.ordered[(((bgr[2] + o) >> 8) << 2) |
+                            (((bgr[1] + o) >> 8) << 1) | ((bgr[0] + o) >> 8)];
+      }
+    }
+    return;
+  }
+  for (; n--; bgr += 3)
+    *dest++ = ditherPixel(d, bgr[2], bgr[1], bgr[0]);
+}
+
 // ADAFRUIT_IMAGEREADER_EPD CLASS **********************************************
 // Loads images from SD card to screen or RAM.
 
@@ -161,7 +525,8 @@ void Adafruit_Image_EPD::draw(Adafruit_EPD &epd, int16_t x, int16_t y) {
              before any of the image loading or size functions are called!
 */
 Adafruit_ImageReader_EPD::Adafruit_ImageReader_EPD(FatVolume &fs)
-    : Adafruit_ImageReader(fs) {}
+    : Adafruit_ImageReader(fs),
+      ditherMode(EPD_DITHER_NONE) {}
 
 /*!
     @brief   Constructor for Adafruit_ImageReader_EPD object without an
@@ -169,7 +534,28 @@ Adafruit_ImageReader_EPD::Adafruit_ImageReader_EPD(FatVolume &fs)
     @return  Adafruit_ImageReader object.
 */
 Adafruit_ImageReader_EPD::Adafruit_ImageReader_EPD(void)
-    : Adafruit_ImageReader() {}
+    : Adafruit_ImageReader(),
+      ditherMode(EPD_DITHER_NONE) {}
+
+/*!
+    @brief   Select dithering for subsequent drawBMP() calls. Without it,
+             each pixel is thresholded to the nearest EPD color (see
+             mapColorForDisplay()), which posterizes photos on displays
+             with only 2 to 4 colors.
+    @param   mode
+             EPD_DITHER_NONE (default) thresholds each pixel.
+             EPD_DITHER_ORDERED adds a 4x4 Bayer pattern before
+             thresholding; as fast as no dithering and needs no memory.
+             EPD_DITHER_FLOYD_STEINBERG and EPD_DITHER_ATKINSON diffuse
+             each pixel's error to its neighbors, using one or two rows of
+             error terms (allocated per draw; drawBMP() returns
+             IMAGE_ERR_MALLOC if that fails). Atkinson spreads only 3/4 of
+             the error, for more contrast.
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::setDither(EPDDitherMode mode) {
+  ditherMode = mode;
+}
 
 /*!
     @brief   Loads BMP image file from SD card directly to Adafruit_EPD screen.
@@ -263,6 +649,8 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
     Adafruit_Image_EPD *img, // NULL if load-to-screen
     boolean transact) {      // SD & EPD sharing bus, use transactions
   thinkinkmode_t displayMode = epd ? epd->getMode() : THINKINK_TRICOLOR;
+  EPDColorMap colorMap;                      // RGB to EPD color table
+  EPDDither dither;                          // Dithering state
   ImageReturnCode status = IMAGE_ERR_FORMAT; // IMAGE_SUCCESS on valid file
   uint32_t offset;                           // Start of image data in file
   uint32_t headerSize;                       // Indicates BMP version
@@ -272,30 +660,55 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
   uint32_t compression = 0;                  // BMP compression mode
   uint32_t colors = 0;                       // Number of colors in palette
   uint16_t *quantized = NULL;                // EPD Color palette
+  uint8_t palette[3 * 16];                   // B, G, R palette, if dither
   uint32_t rowSize;                          // >bmpWidth if scanline padding
-  uint8_t sdbuf[3 * BUFPIXELS];              // BMP read buf (R+G+B/pixel)
+  uint8_t localbuf[3 * BUFPIXELS];           // Default BMP read buf
+  uint8_t *sdbuf = localbuf;                 // BMP read buf (R+G+B/pixel)
+  uint32_t sdbufSize = sizeof localbuf;      // Size of sdbuf in bytes
+  uint32_t destSize = BUFPIXELS;             // Size of dest buf in pixels
+  uint32_t srcidx;                           // Current position in sdbuf
   int16_t epd_col = 0, epd_row = 0;
-#if ((3 * BUFPIXELS) <= 255)
-  uint8_t srcidx = sizeof sdbuf; // Current position in sdbuf
-#else
-  uint16_t srcidx = sizeof sdbuf;
-#endif
   uint32_t destidx = 0;
+  uint32_t destStart;        // dest index at start of pass, for dithering
   uint8_t *dest1 = NULL;     // Dest ptr for 1-bit BMPs to img
   boolean flip = true;       // BMP is stored bottom-to-top
   uint32_t bmpPos = 0;       // Next pixel position in file
+  uint32_t readPos = 0;      // File position of next sdbuf load
+  uint32_t bufPos = 0;       // File position of sdbuf[0]
+  uint32_t bufLen = 0;       // Valid bytes in sdbuf
+  uint32_t skip = 0;         // Initial srcidx following a load
+  uint32_t readLen;          // Bytes in next sdbuf load
+  uint32_t readOfs = 0;      // Index in sdbuf of next load (after kept data)
+  uint32_t keep = 0;         // Bytes kept in sdbuf following next load
+  uint32_t firstSector;      // Start of sector holding first pixel data
+  uint32_t rowBytes;         // Bytes per scanline within clipped area
+  boolean rowMode;           // If set, load whole scanlines to sdbuf
   int loadWidth, loadHeight, // Region being loaded (clipped)
       loadX, loadY;          // "
   int row, col;              // Current pixel pos.
+  int32_t n;                 // Bytes read from file
+  uint32_t span;             // Pixels converted in one pass
   uint8_t r, g, b, color;    // Current pixel color
   uint8_t bitIn = 0;         // Bit number for 1-bit data in
   uint8_t bitOut = 0;        // Column mask for 1-bit data out
+  uint32_t startTime = 0;    // Timing for stats (if enabled)
+
+  if (stats) {
+    memset(stats, 0, sizeof *stats);
+    startTime = micros();
+  }
 
   // If an Adafruit_Image object is passed and currently contains anything,
   // free its contents as it's about to be overwritten with new stuff.
   if (img)
     img->dealloc();
 
+  // If the caller provided a working buffer (see setBuffer()), it replaces
+  // the default sdbuf and (if drawing to EPD) dest buffers.
+  splitBuffer(epd ? 1 : 0, &dest, &destSize, &sdbuf, &sdbufSize);
+  srcidx = sdbufSize; // Force initial buffer load
+  readLen = sdbufSize;
+
   // If BMP is being drawn off the right or bottom edge of the screen,
   // nothing to do here. NOT an error, just a trivial clip operation.
   if (epd && ((x >= epd->width()) || (y >= epd->height())))
@@ -322,7 +735,8 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
     bmpHeight = readLE32();
     // If bmpHeight is negative, image is in top-down order.
     // This is not canon but has been observed in the wild.
-    if (bmpHeight < 0) {
+    // (Out-of-range values are left as-is and rejected below.)
+    if ((bmpHeight < 0) && (bmpHeight >= -0x7FFF)) {
       bmpHeight = -bmpHeight;
       flip = false;
     }
@@ -338,45 +752,54 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
       (void)readLE32();    // Number of colors used (ignore)
       // File position should now be at start of palette (if present)
     }
-    if (!colors)
+    if ((depth < 16) && (!colors || (colors > (1UL << depth))))
       colors = 1 << depth;
 
-    loadWidth = bmpWidth;
-    loadHeight = bmpHeight;
-    loadX = 0;
-    loadY = 0;
-    if (epd) {
-      // Crop area to be loaded (if destination is EPD)
-      if (x < 0) {
-        loadX = -x;
-        loadWidth += x;
-        x = 0;
-      }
-      if (y < 0) {
-        loadY = -y;
-        loadHeight += y;
-        y = 0;
-      }
-      if ((x + loadWidth) > epd->width())
-        loadWidth = epd->width() - x;
-      if ((y + loadHeight) > epd->height())
-        loadHeight = epd->height() - y;
-    }
+    // Only uncompressed is handled. Dimensions must fit GFX canvases and
+    // the size math below (same limits as Adafruit_ImageReader::coreBMP()).
+    if ((planes == 1) && (compression == 0) && (bmpWidth > 0) &&
+        (bmpWidth <= 0x7FFF) && (bmpHeight > 0) && (bmpHeight <= 0x7FFF)) {
 
-    if ((planes == 1) && (compression == 0)) { // Only uncompressed is handled
+      loadWidth = bmpWidth;
+      loadHeight = bmpHeight;
+      loadX = 0;
+      loadY = 0;
+      if (epd) {
+        // Crop area to be loaded (if destination is EPD)
+        if (x < 0) {
+          loadX = -x;
+          loadWidth += x;
+          x = 0;
+        }
+        if (y < 0) {
+          loadY = -y;
+          loadHeight += y;
+          y = 0;
+        }
+        if ((x + loadWidth) > epd->width())
+          loadWidth = epd->width() - x;
+        if ((y + loadHeight) > epd->height())
+          loadHeight = epd->height() - y;
+      }
 
       // BMP rows are padded (if needed) to 4-byte boundary
-      rowSize = ((depth * bmpWidth + 31) / 32) * 4;
+      rowSize = ((depth * (uint32_t)bmpWidth + 31) / 32) * 4;
 
-      if ((depth == 24) || (depth == 1)) { // BGR or 1-bit bitmap format
+      // BGR, 4-bit palettized or 1-bit bitmap format
+      if ((depth == 24) || (depth == 4) || (depth == 1)) {
 
         if (img) {
-          // Loading to RAM -- allocate GFX 16-bit canvas type
+          // Loading to RAM -- allocate GFX canvas type matching depth
           status = IMAGE_ERR_MALLOC; // Assume won't fit to start
           if (depth == 24) {
             if ((img->canvas.canvas16 = new GFXcanvas16(bmpWidth, bmpHeight))) {
               dest = img->canvas.canvas16->getBuffer();
             }
+          } else if (depth == 4) { // Stays packed, 2 pixels per byte
+            if ((img->canvas.canvas8 =
+                     new GFXcanvas8((bmpWidth + 1) / 2, bmpHeight))) {
+              dest1 = img->canvas.canvas8->getBuffer();
+            }
           } else {
             if ((img->canvas.canvas1 = new GFXcanvas1(bmpWidth, bmpHeight))) {
               dest1 = img->canvas.canvas1->getBuffer();
@@ -396,30 +819,64 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
             } else {
               if (depth == 1) {
                 img->format = IMAGE_1; // Is a GFX 1-bit canvas type
+              } else if (depth == 4) {
+                img->format = IMAGE_4; // GFX 8-bit canvas, packed 4-bit
+                img->width4 = bmpWidth;
               } else {
                 img->format = IMAGE_16; // Is a GFX 16-bit canvas type
               }
             }
 
-            if ((depth >= 16) ||
-                (quantized = (uint16_t *)malloc(colors * sizeof(uint16_t)))) {
+            // Palette has an entry for every possible pixel value, even
+            // if the file holds fewer colors
+            if ((depth >= 16) || (quantized = (uint16_t *)calloc(
+                                      1 << depth, sizeof(uint16_t)))) {
               if (depth < 16) {
-                // Load and quantize color table
-                thinkinkmode_t displayMode =
-                    epd ? epd->getMode() : THINKINK_TRICOLOR;
+                // Load and quantize color table. When dithering, pixels
+                // are unpacked as palette indices and dithered from the
+                // palette's B, G, R (missing entries are white).
+                memset(palette, 0xFF, sizeof palette);
                 for (uint16_t c = 0; c < colors; c++) {
-                  b = file.read();
-                  g = file.read();
-                  r = file.read();
-                  (void)file.read(); // Ignore 4th byte
+                  readData(sdbuf, 4); // B, G, R, ignore 4th byte
+                  b = sdbuf[0];
+                  g = sdbuf[1];
+                  r = sdbuf[2];
+                  // Loaded images keep a 565 palette, as Adafruit_Image
+                  // draw() functions expect; mapped when drawn.
                   color = mapColorForDisplay(r, g, b, displayMode);
-                  quantized[c] = color;
+                  quantized[c] = epd ? color
+                                     : ((r & 0xF8) << 8) | ((g & 0xFC) << 3) |
+                                           (b >> 3);
+                  memcpy(&palette[c * 3], sdbuf, 3);
+                }
+                if (epd && ditherMode) {
+                  for (uint16_t c = 0; c < (1 << depth); c++)
+                    quantized[c] = c;
                 }
               }
+              if ((depth == 24) || (epd && ditherMode))
+                initColorMap(colorMap, displayMode);
+              if (epd && ditherMode)
+                status = initDither(dither, colorMap, loadWidth);
 
-              for (row = 0; row < loadHeight; row++) { // For each scanline...
+              if (stats) { // Header & palette done, pixel data starts here
+                stats->headerTime = micros() - startTime;
+                stats->readTime = 0;
+              }
+
+              // Whole scanlines are loaded at once when they fit (see
+              // Adafruit_ImageReader::coreBMP()).
+              rowBytes = ((uint32_t)(loadX + loadWidth) * depth + 7) / 8 -
+                         ((uint32_t)loadX * depth) / 8;
+              rowMode = (sdbufSize >= rowBytes + 511);
+              firstSector = offset & ~(uint32_t)511;
+
+              for (row = 0; (row < loadHeight) && (status == IMAGE_SUCCESS);
+                   row++) { // For each scanline...
 
                 yield(); // Keep ESP8266 happy
+                if (dither.mode)
+                  ditherRow(dither);
 
                 // Seek to start of scan line.  It might seem labor-intensive
                 // to be doing this on every line, but this method covers a
@@ -433,6 +890,12 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
                   bmpPos = offset + (row + loadY) * rowSize;
                 if (depth == 24) {
                   bmpPos += loadX * 3;
+                } else if (depth == 4) {
+                  bmpPos += loadX / 2;
+                  bitIn = (loadX & 1) ? 0 : 4; // Nibble shift of 1st pixel
+                  if (img) {
+                    destidx = ((bmpWidth + 1) / 2) * row;
+                  }
                 } else {
                   bmpPos += loadX / 8;
                   bitIn = 7 - (loadX & 7);
@@ -441,66 +904,137 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
                     destidx = ((bmpWidth + 7) / 8) * row;
                   }
                 }
-                if (file.position() != bmpPos) { // Need seek?
-                  if (transact) {
-                    epd->endWrite(); // End EPD SPI transaction
+                if (rowMode) {
+                  // Whole rows fit in sdbuf; is this one there already?
+                  if ((bmpPos >= bufPos) &&
+                      (bmpPos + rowBytes <= bufPos + bufLen)) {
+                    srcidx = bmpPos - bufPos;
+                  } else {
+                    if (!flip && bufLen && (bmpPos >= bufPos) &&
+                        (bmpPos <= bufPos + bufLen)) {
+                      // Row starts in sdbuf but runs past the end. Move
+                      // that part to the front and continue reading from
+                      // the file where the last load left off (no seek,
+                      // and reads stay sector-aligned).
+                      readOfs = bufPos + bufLen - bmpPos;
+                      memmove(sdbuf, &sdbuf[bmpPos - bufPos], readOfs);
+                      readLen = (sdbufSize - readOfs) & ~(uint32_t)511;
+                    } else if (flip && bufLen && (bmpPos < bufPos) &&
+                               (bmpPos + rowBytes >= bufPos)) {
+                      // Bottom-to-top: row ends in sdbuf. Move that part
+                      // to the back and load the block preceding it, so
+                      // each seek brings in several rows (in reverse).
+                      keep = bmpPos + rowBytes - bufPos;
+                      readLen = (sdbufSize - keep) & ~(uint32_t)511;
+                      if (readLen > bufPos - firstSector)
+                        readLen = bufPos - firstSector;
+                      memmove(&sdbuf[readLen], sdbuf, keep);
+                      readPos = bufPos - readLen;
+                      skip = bmpPos - readPos; // Row start within block
+                    } else if (flip) {
+                      // Not sequential, load a block ending with this row
+                      n = bmpPos + rowBytes + 511 - sdbufSize;
+                      readPos = (n > (int32_t)firstSector)
+                                    ? (n & ~(int32_t)511)
+                                    : firstSector;
+                      skip = bmpPos - readPos; // Row start within block
+                    } else {
+                      // Not sequential, load from the row's sector
+                      readPos = bmpPos & ~(uint32_t)511;
+                      skip = bmpPos - readPos; // Row start within block
+                    }
+                    srcidx = sdbufSize; // Force buffer reload
                   }
-                  file.seek(bmpPos);     // Seek = SD transaction
-                  srcidx = sizeof sdbuf; // Force buffer reload
+                } else if (!bufLen || ((bufPos + srcidx) != bmpPos)) {
+                  // Unless this row continues directly from the unread
+                  // data in sdbuf, start a new read at the row.
+                  readPos = bmpPos;
+                  srcidx = sdbufSize; // Force buffer reload
                 }
-                for (col = 0; col < loadWidth; col++) { // For each pixel...
-                  if (srcidx >= sizeof sdbuf) {         // Time to load more?
-                    if (epd) {                          // Drawing to TFT?
-                      if (transact) {
-                        epd->endWrite(); // End EPD SPI transact
-                      }
-#if defined(ARDUINO_NRF52_ADAFRUIT)
-                      // NRF52840 seems to have trouble reading more than 512
-                      // bytes across certain boundaries. Workaround for now
-                      // is to break the read into smaller chunks...
-                      int32_t bytesToGo = sizeof sdbuf, bytesRead = 0,
-                              bytesThisPass;
-                      while (bytesToGo > 0) {
-                        bytesThisPass = min(bytesToGo, 512);
-                        file.read(&sdbuf[bytesRead], bytesThisPass);
-                        bytesRead += bytesThisPass;
-                        bytesToGo -= bytesThisPass;
-                      }
-#else
-                      file.read(sdbuf, sizeof sdbuf); // Load from SD
-#endif
+                for (col = 0; col < loadWidth;) { // For each pixel...
+                  if (srcidx >= sdbufSize) {       // Time to load more?
+                    if (epd && transact) {
+                      epd->endWrite(); // End EPD SPI transact
+                    }
+                    if (file.position() != readPos) // Need seek?
+                      seekData(readPos);            // Seek = SD transaction
+                    n = readData(&sdbuf[readOfs], readLen); // Load from SD
+                    if (n < 0)
+                      n = 0;
+                    bufPos = readPos - readOfs;
+                    bufLen = readOfs + n;
+                    if (n == (int32_t)readLen)
+                      bufLen += keep; // Retained data follows the load
+                    readPos += n;     // Next sequential load
+                    readOfs = keep = 0;
+                    readLen = sdbufSize;
+                    if (epd) { // Drawing to EPD?
                       if (transact)
                         epd->startWrite(); // Start EPD SPI transact
                       if (destidx) {       // If buffered EPD data
-                        // Non-blocking writes (DMA) have been temporarily
-                        // disabled until this can be rewritten with two
-                        // alternating 'dest' buffers (else the nonblocking
-                        // data out is overwritten in the dest[] write below).
-                        uint16_t index = 0;
-                        while (index < destidx && epd_row < y + loadHeight) {
-                          epd->writePixel(epd_col, epd_row, dest[index]);
-                          epd_col++;
-                          if (epd_col == x + loadWidth) {
-                            epd_col = x;
-                            epd_row++;
-                          }
-                          index++;
-                        };
+                        writeDest(epd, dest, destidx, x, y, loadWidth,
+                                  loadHeight, epd_col, epd_row);
                         destidx = 0; // and reset dest index
                       }
-                    } else {                          // Canvas is simpler,
-                      file.read(sdbuf, sizeof sdbuf); // just load sdbuf
-                    } // (destidx never resets)
-                    srcidx = 0; // Reset bmp buf index
+                    } // (canvas destidx never resets)
+                    srcidx = skip; // Reset bmp buf index
+                    skip = 0;
+                  }
+                  if (epd && (destidx >= destSize)) { // dest full?
+                    // sdbuf may hold more pixels than dest (e.g. 1-bit
+                    // data, or a caller buffer rounded to whole sectors).
+                    writeDest(epd, dest, destidx, x, y, loadWidth, loadHeight,
+                              epd_col, epd_row);
+                    destidx = 0;
                   }
+                  destStart = destidx;
                   if (depth == 24) {
-                    // Convert each pixel from BMP to 565 format, save in dest
-                    b = sdbuf[srcidx++];
-                    g = sdbuf[srcidx++];
-                    r = sdbuf[srcidx++];
-
-                    color = mapColorForDisplay(r, g, b, displayMode);
-                    dest[destidx++] = color;
+                    // Map as many pixels from BMP to EPD colors as the
+                    // row, sdbuf and dest allow, save in dest
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) / 3);
+                    if (epd)
+                      span = min(span, destSize - destidx);
+                    if (dither.mode)
+                      ditherColors(dither, &sdbuf[srcidx], &dest[destidx],
+                                   span);
+                    else
+                      mapColors(colorMap, &sdbuf[srcidx], &dest[destidx],
+                                span);
+                    srcidx += span * 3;
+                    destidx += span;
+                    col += span;
+                  } else if (depth == 4) {
+                    // Pixels available in sdbuf: two per byte, less one if
+                    // a byte's high nibble was consumed by the prior span
+                    span = min((uint32_t)(loadWidth - col),
+                               (sdbufSize - srcidx) * 2 - (bitIn ? 0 : 1));
+                    if (epd)
+                      span = min(span, destSize - destidx);
+                    col += span;
+                    if (epd) {
+                      // Unpack two pixels per byte through the palette
+                      if (!bitIn) { // Finish a split byte
+                        dest[destidx++] = quantized[sdbuf[srcidx++] & 0x0F];
+                        bitIn = 4;
+                        span--;
+                      }
+                      for (; span >= 2; span -= 2) {
+                        b = sdbuf[srcidx++];
+                        dest[destidx++] = quantized[b >> 4];
+                        dest[destidx++] = quantized[b & 0x0F];
+                      }
+                      if (span) { // Odd pixel out, low nibble next time
+                        dest[destidx++] = quantized[sdbuf[srcidx] >> 4];
+                        bitIn = 0;
+                      }
+                    } else {
+                      // Copy packed bytes to canvas (rows start on a byte)
+                      span = (span + 1) / 2;
+                      memcpy(&dest1[destidx], &sdbuf[srcidx], span);
+                      srcidx += span;
+                      destidx += span;
+                    }
                   } else {
                     // Extract 1-bit color index
                     uint8_t n = (sdbuf[srcidx] >> bitIn) & 1;
@@ -525,26 +1059,30 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
                         destidx++;
                       }
                     }
+                    col++;
+                  }
+                  if (dither.mode && (depth < 16)) {
+                    // Dither the palette colors of indices just unpacked
+                    for (; destStart < destidx; destStart++) {
+                      n = dest[destStart] * 3;
+                      dest[destStart] = ditherPixel(
+                          dither, palette[n + 2], palette[n + 1], palette[n]);
+                    }
                   }
                 } // end pixel loop
                 if (epd) {       // Drawing to TFT?
                   if (destidx) { // Any remainders?
-                    uint16_t index = 0;
-                    while (index < destidx && epd_row < y + loadHeight) {
-                      epd->writePixel(epd_col, epd_row, dest[index]);
-                      epd_col++;
-                      if (epd_col == x + loadWidth) {
-                        epd_col = x;
-                        epd_row++;
-                      }
-                      index++;
-                    };
+                    writeDest(epd, dest, destidx, x, y, loadWidth, loadHeight,
+                              epd_col, epd_row);
                     destidx = 0; // and reset dest index
                   }
                   epd->endWrite(); // End TFT (regardless of transact)
                 }
               } // end scanline loop
 
+              if (stats)
+                stats->pixels = (uint32_t)loadWidth * loadHeight;
+
               if (quantized) {
                 if (epd)
                   free(quantized); // Palette no longer needed
@@ -558,10 +1096,58 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(
     } // end planes/compression check
   } // end signature
 
+  free(dither.buf); // Error terms, if error diffusion
   file.close();
+  if (stats)
+    stats->totalTime = micros() - startTime;
   return status;
 }
 
+/*!
+    @brief   Writes a block of mapped EPD colors to the display, continuing
+             left-to-right, top-to-bottom from the current position within
+             the (clipped) image region. Pixels go out one writePixel()
+             each; Adafruit_EPD has no public call that takes a row (GFX's
+             line calls are per-pixel too), and its bit-plane buffers are
+             protected.
+    @param   epd
+             Screen to draw to (any Adafruit_EPD-derived class).
+    @param   dest
+             Buffer of EPD color values.
+    @param   len
+             Number of values in dest.
+    @param   x
+             Left edge of image region on screen.
+    @param   y
+             Top edge of image region on screen.
+    @param   w
+             Width of image region in pixels.
+    @param   h
+             Height of image region in pixels.
+    @param   col
+             Current column on screen; updated on return.
+    @param   row
+             Current row on screen; updated on return.
+    @return  None (void).
+*/
+void Adafruit_ImageReader_EPD::writeDest(Adafruit_EPD *epd, uint16_t *dest,
+                                         uint32_t len, int16_t x, int16_t y,
+                                         int16_t w, int16_t h, int16_t &col,
+                                         int16_t &row) {
+  uint32_t t = stats ? micros() : 0;
+  uint32_t index = 0;
+  while (index < len && row < y + h) {
+    epd->writePixel(col, row, dest[index]);
+    col++;
+    if (col == x + w) {
+      col = x;
+      row++;
+    }
+    index++;
+  };
+  if (stats)
+    stats->writeTime += micros() - t;
+}
 
 ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(const uint8_t *bmp,
                                                   size_t bmp_len,
@@ -598,22 +1184,23 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(const uint8_t *bmp,
     compression = readLE32(bmp + 30);
     colors = readLE32(bmp + 46);
   }
-  if (!colors)
+  if ((depth < 16) && (!colors || (colors > (1UL << depth))))
     colors = 1 << depth;
 
   // If bmpHeight is negative, image is in top-down order.
   // This is not canon but has been observed in the wild.
   boolean flip = true;
-  if (bmpHeight < 0) {
+  if ((bmpHeight < 0) && (bmpHeight >= -0x7FFF)) {
     bmpHeight = -bmpHeight;
     flip = false;
   }
 
-  // Only uncompressed BMPs are compatible
-  if ((planes != 1) || (compression != 0))
+  // Only uncompressed BMPs are compatible, at most 32767 pixels square
+  if ((planes != 1) || (compression != 0) || (bmpWidth <= 0) ||
+      (bmpWidth > 0x7FFF) || (bmpHeight <= 0) || (bmpHeight > 0x7FFF))
     return IMAGE_ERR_FORMAT;
-  // Only 1BPP and 24BPP BMPs are compatible
-  if ((depth != 24) && (depth != 1))
+  // Only 1BPP, 4BPP and 24BPP BMPs are compatible
+  if ((depth != 24) && (depth != 4) && (depth != 1))
     return IMAGE_ERR_FORMAT;
 
   // BMP rows are padded to a 4-byte boundary
@@ -646,35 +1233,82 @@ ImageReturnCode Adafruit_ImageReader_EPD::coreBMP(const uint8_t *bmp,
   if ((loadWidth <= 0) || (loadHeight <= 0))
     return IMAGE_SUCCESS;
 
-  // For 1-bit BMPs, quantize the 2-entry palette up front. Reading the actual
+  // For 1- and 4-bit BMPs, quantize the palette up front. Reading the actual
   // palette RGB makes inversion "just work" -- no do_invert heuristic needed.
-  uint16_t quantized[2] = {EPD_BLACK, EPD_WHITE};
-  if (depth == 1) {
+  // The palette's B, G, R are kept for dithering.
+  uint16_t quantized[16] = {EPD_BLACK, EPD_WHITE};
+  uint8_t palette[3 * 16];
+  memset(palette, 0xFF, sizeof palette);
+  memset(palette, 0x00, 3);
+  if (depth < 16) {
     const uint8_t *pal = bmp + 14 + headerSize; // BGRA entries
     if ((size_t)(14 + headerSize) + (size_t)colors * 4 <= bmp_len) {
-      for (uint32_t c = 0; (c < colors) && (c < 2); c++)
+      for (uint32_t c = 0; c < colors; c++) {
         quantized[c] = mapColorForDisplay(pal[c * 4 + 2], pal[c * 4 + 1],
                                           pal[c * 4], displayMode);
+        memcpy(&palette[c * 3], &pal[c * 4], 3);
+      }
     }
   }
 
+  // Mapped colors are gathered in dest and written out a block at a time
+  // (see writeDest()), as in the file-based coreBMP().
+  uint16_t dest[BUFPIXELS];
+  uint32_t destidx = 0, span;
+  int16_t epd_col = x, epd_row = y;
+  EPDColorMap colorMap;
+  EPDDither dither;
+  if ((depth == 24) || ditherMode)
+    initColorMap(colorMap, displayMode);
+  if (ditherMode && (initDither(dither, colorMap, loadWidth) != IMAGE_SUCCESS))
+    return IMAGE_ERR_MALLOC;
+
   epd->startWrite();
   for (int row = 0; row < loadHeight; row++) { // For each scanline...
     yield();                                   // Keep ESP8266 happy
+    if (dither.mode)
+      ditherRow(dither);
     uint32_t srcRow = flip ? (bmpHeight - 1 - (row + loadY)) : (row + loadY);
     const uint8_t *rowPtr = bmp + offset + (size_t)srcRow * rowSize;
-    for (int col = 0; col < loadWidth; col++) { // For each pixel...
-      uint8_t color;
-      if (depth == 24) {
-        const uint8_t *px = rowPtr + (size_t)(loadX + col) * 3; // BGR order
-        color = mapColorForDisplay(px[2], px[1], px[0], displayMode);
-      } else { // depth == 1, MSB-first
-        uint32_t bit = (uint32_t)(loadX + col);
-        color = quantized[(rowPtr[bit >> 3] >> (7 - (bit & 7))) & 1];
+    for (int col = 0; col < loadWidth;) { // For each pixel...
+      if (depth == 24) { // Map as much of the row as fits in dest
+        span = min((uint32_t)(loadWidth - col), BUFPIXELS - destidx);
+        if (dither.mode)
+          ditherColors(dither, rowPtr + (size_t)(loadX + col) * 3,
+                       &dest[destidx], span);
+        else
+          mapColors(colorMap, rowPtr + (size_t)(loadX + col) * 3,
+                    &dest[destidx], span);
+        col += span;
+        destidx += span;
+      } else {
+        uint8_t index;
+        if (depth == 4) { // High nibble first
+          uint32_t pix = (uint32_t)(loadX + col);
+          index = (rowPtr[pix >> 1] >> ((pix & 1) ? 0 : 4)) & 0x0F;
+        } else { // depth == 1, MSB-first
+          uint32_t bit = (uint32_t)(loadX + col);
+          index = (rowPtr[bit >> 3] >> (7 - (bit & 7))) & 1;
+        }
+        if (dither.mode)
+          dest[destidx++] = ditherPixel(dither, palette[index * 3 + 2],
+                                        palette[index * 3 + 1],
+                                        palette[index * 3]);
+        else
+          dest[destidx++] = quantized[index];
+        col++;
+      }
+      if (destidx == BUFPIXELS) { // dest full?
+        writeDest(epd, dest, destidx, x, y, loadWidth, loadHeight, epd_col,
+                  epd_row);
+        destidx = 0;
       }
-      epd->writePixel(x + col, y + row, color);
     }
   }
+  if (destidx) // Any remainders?
+    writeDest(epd, dest, destidx, x, y, loadWidth, loadHeight, epd_col,
+              epd_row);
   epd->endWrite();
+  free(dither.buf); // Error terms, if error diffusion
   return IMAGE_SUCCESS;
 }
\ No newline at end of file
@@ -20,6 +20,36 @@
 
 #define MIN_SZ_BMP_HEADER 54 ///< Minimum size of the BMP header, in bytes
 #define BMP_HEADER 0x4D42    ///< BMP signature (ASCII 'BM')
+#ifdef __AVR__
+#define EPD_COLORMAP 0 ///< No room for color lookup table, map each pixel
+#else
+#define EPD_COLORMAP 512 ///< Color lookup table entries (3:3:3 RGB)
+#endif
+
+/*!
+   @brief  RGB-to-EPD color lookup table for one display mode, filled in
+           by Adafruit_ImageReader_EPD::initColorMap() once per draw. All
+           mapColorForDisplay() thresholds fall on multiples of 0x20 per
+           channel (or of 0x40 for R+G+B, in modes that average the
+           channels), so the table's results are identical to it.
+*/
+typedef struct {
+  thinkinkmode_t mode; ///< Display mode table was built for
+  boolean sum;         ///< If set, index is (R+G+B)/64, else 3:3:3 RGB
+#if EPD_COLORMAP
+  uint8_t color[EPD_COLORMAP]; ///< EPD color for each index
+#endif
+} EPDColorMap;
+
+/** Dithering of image colors down to the EPD's colors, see setDither() */
+enum EPDDitherMode {
+  EPD_DITHER_NONE,            // Threshold each pixel (default)
+  EPD_DITHER_ORDERED,         // 4x4 Bayer ordered dither
+  EPD_DITHER_FLOYD_STEINBERG, // Floyd-Steinberg error diffusion
+  EPD_DITHER_ATKINSON         // Atkinson error diffusion
+};
+
+struct EPDDither; // Dithering state, internal to Adafruit_ImageReader_EPD
 
 /*!
    @brief  Data bundle returned with an image loaded to RAM. Used by
@@ -56,13 +86,48 @@ public:
 
   static uint8_t mapColorForDisplay(uint8_t r, uint8_t g, uint8_t b,
                                     thinkinkmode_t mode);
+  void setDither(EPDDitherMode mode);
+  static void initColorMap(EPDColorMap &map, thinkinkmode_t mode);
+  static void mapColors(const EPDColorMap &map, const uint8_t *bgr,
+                        uint16_t *dest, uint32_t n);
+  /*!
+      @brief   Maps RGB color values to an EPD display color through a
+               lookup table, same result as mapColorForDisplay().
+      @param   map
+               Table from initColorMap() for the display's mode.
+      @param   r
+               Red component of the color (0-255).
+      @param   g
+               Green component of the color (0-255).
+      @param   b
+               Blue component of the color (0-255).
+      @return  EPD color constant for the display mode.
+  */
+  static inline uint8_t mapColor(const EPDColorMap &map, uint8_t r, uint8_t g,
+                                 uint8_t b) {
+#if EPD_COLORMAP
+    return map.color[map.sum ? ((r + g + b) >> 6)
+                             : (((r >> 5) << 6) | ((g >> 5) << 3) | (b >> 5))];
+#else
+    return mapColorForDisplay(r, g, b, map.mode);
+#endif
+  }
 
 private:
+  uint8_t ditherMode; ///< EPDDitherMode for drawBMP()
   ImageReturnCode coreBMP(char *filename, Adafruit_EPD *epd, uint16_t *dest,
                           int16_t x, int16_t y, Adafruit_Image_EPD *img,
                           boolean transact);
   ImageReturnCode coreBMP(const uint8_t *bmp, size_t bmp_len, Adafruit_EPD *epd,
                           int16_t x, int16_t y);
+  void writeDest(Adafruit_EPD *epd, uint16_t *dest, uint32_t len, int16_t x,
+                 int16_t y, int16_t w, int16_t h, int16_t &col, int16_t &row);
+  ImageReturnCode initDither(EPDDither &d, const EPDColorMap &map,
+                             int16_t width);
+  void ditherRow(EPDDither &d);
+  uint8_t ditherPixel(EPDDither &d, uint8_t r, uint8_t g, uint8_t b);
+  void ditherColors(EPDDither &d, const uint8_t *bgr, uint16_t *dest,
+                    uint32_t n);
 };
 
 #endif // __ADAFRUIT_IMAGE_READER_EPD_H__
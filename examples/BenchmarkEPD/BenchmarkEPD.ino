@@ -0,0 +1,205 @@
+// Adafruit_ImageReader decode benchmark for Adafruit E-Ink FeatherWings.
+// Walks every folder on the SD card (or flash) and, for each BMP file
+// found, times drawBMP() into the EPD framebuffer, both from file and
+// from a RAM-resident copy of the file (when there's room), printing
+// per-image statistics: pixels/sec, bytes read, number of read() and
+// seek() calls, and time spent in header parsing, file reads, color
+// mapping and EPD writes. The display is never refreshed, only its
+// buffer is drawn to. Copy the contents of the library's images/ folder
+// (subfolders included) to the root directory of the SD card or flash.
+
+#include <Adafruit_GFX.h>         // Core graphics library
+#include "Adafruit_EPD.h"         // Hardware-specific library for EPD
+#include <SdFat_Adafruit_Fork.h>  // SD card & FAT filesystem library
+#include <Adafruit_SPIFlash.h>    // SPI / QSPI flash library
+#include <Adafruit_ImageReader_EPD.h> // Image-reading functions
+
+// Comment out the next line to load from SPI/QSPI flash instead of SD card:
+#define USE_SD_CARD
+
+#if defined(ESP8266)
+   #define SD_CS    2
+   #define SRAM_CS 16
+   #define EPD_CS   0
+   #define EPD_DC   15
+#elif defined(ESP32)
+  #define SD_CS       14
+  #define SRAM_CS     32
+  #define EPD_CS      15
+  #define EPD_DC      33  
+#elif defined(TEENSYDUINO)
+  #define SD_CS       8
+  #define SRAM_CS     3
+  #define EPD_CS      4
+  #define EPD_DC      10  
+#elif defined(ARDUINO_STM32_FEATHER)
+   #define TFT_DC   PB4
+   #define TFT_CS   PA15
+   #define STMPE_CS PC7
+   #define SD_CS    PC5
+#elif defined(ARDUINO_NRF52832_FEATHER) // BSP 0.6.5 and higher!
+  #define SD_CS       27
+  #define SRAM_CS     30
+  #define EPD_CS      31
+  #define EPD_DC      11
+#else // Anything else!
+  #define SD_CS       5
+  #define SRAM_CS     6
+  #define EPD_CS      9
+  #define EPD_DC      10  
+#endif
+
+#define EPD_RESET   -1 // can set to -1 and share with microcontroller Reset!
+#define EPD_BUSY    -1 // can set to -1 to not use a pin (will wait a fixed delay)
+
+/* Uncomment the following line if you are using 2.13" tricolor EPD */
+Adafruit_IL0373 display(212, 104, EPD_DC, EPD_RESET, EPD_CS, SRAM_CS, EPD_BUSY);
+
+/* Uncomment the following line if you are using 2.13" monochrome 250*122 EPD */
+//Adafruit_SSD1675 display(250, 122, EPD_DC, EPD_RESET, EPD_CS, SRAM_CS, EPD_BUSY);
+
+/* Uncomment the following line if you are using 2.9" EPD with E-Ink Feather Friend */
+//Adafruit_IL0373 display(296, 128, EPD_DC, EPD_RESET, EPD_CS, SRAM_CS, EPD_BUSY);
+
+#if defined(USE_SD_CARD)
+  SdFat                    SD;         // SD card filesystem
+  FatVolume               &filesys = SD;
+  Adafruit_ImageReader_EPD reader(SD); // Image-reader object, pass in SD filesys
+#else
+
+// SPI or QSPI flash filesystem (i.e. CIRCUITPY drive)
+  #if defined(__SAMD51__) || defined(NRF52840_XXAA)
+    Adafruit_FlashTransport_QSPI flashTransport(PIN_QSPI_SCK, PIN_QSPI_CS,
+      PIN_QSPI_IO0, PIN_QSPI_IO1, PIN_QSPI_IO2, PIN_QSPI_IO3);
+  #else
+    #if (SPI_INTERFACES_COUNT == 1 || defined(ADAFRUIT_CIRCUITPLAYGROUND_M0))
+      Adafruit_FlashTransport_SPI flashTransport(SS, &SPI);
+    #else
+      Adafruit_FlashTransport_SPI flashTransport(SS1, &SPI1);
+    #endif
+  #endif
+  Adafruit_SPIFlash         flash(&flashTransport);
+  FatVolume             filesys;
+  Adafruit_ImageReader_EPD  reader(filesys); // Image-reader, pass in flash filesys
+#endif
+
+ImageReaderStats           stats;      // Filled in by each reader call
+
+// Print one line of results for a single draw call
+void printStats(const char *what, const char *path, ImageReturnCode stat) {
+  Serial.print(what);
+  Serial.print(path);
+  if(stat != IMAGE_SUCCESS) {
+    Serial.print(F(": "));
+    reader.printStatus(stat);
+    return;
+  }
+  uint32_t other = stats.headerTime + stats.readTime + stats.writeTime;
+  uint32_t convert = (stats.totalTime > other) ? stats.totalTime - other : 0;
+  Serial.print(F(": "));
+  Serial.print(stats.totalTime);
+  Serial.print(F(" us, "));
+  Serial.print(stats.totalTime ?
+    (uint32_t)((uint64_t)stats.pixels * 1000000 / stats.totalTime) : 0);
+  Serial.print(F(" px/s, "));
+  Serial.print(stats.bytesRead);
+  Serial.print(F(" bytes, "));
+  Serial.print(stats.reads);
+  Serial.print(F(" reads, "));
+  Serial.print(stats.seeks);
+  Serial.print(F(" seeks, header "));
+  Serial.print(stats.headerTime);
+  Serial.print(F(" us, read "));
+  Serial.print(stats.readTime);
+  Serial.print(F(" us, convert "));
+  Serial.print(convert);
+  Serial.print(F(" us, write "));
+  Serial.print(stats.writeTime);
+  Serial.println(F(" us"));
+}
+
+// Run file & in-memory draw benchmarks on one BMP file
+void benchmark(char *path) {
+  ImageReturnCode stat;
+
+  display.clearBuffer();
+  stat = reader.drawBMP(path, display, 0, 0);
+  printStats("drawBMP ", path, stat);
+
+  // In-memory variant: copy whole file to RAM first (if it fits)
+  File32   file = filesys.open(path);
+  uint32_t len  = file.fileSize();
+  uint8_t *bmp  = (uint8_t *)malloc(len);
+  if(bmp) {
+    file.read(bmp, len);
+    display.clearBuffer();
+    uint32_t t = micros();
+    stat = reader.drawBMP(bmp, len, display, 0, 0);
+    t = micros() - t;
+    free(bmp);
+    Serial.print(F("drawBMP (RAM) "));
+    Serial.print(path);
+    Serial.print(F(": "));
+    Serial.print(t);
+    Serial.println(F(" us"));
+  }
+  file.close();
+}
+
+// Recursively visit every .bmp file in a folder
+void walk(const char *dirPath) {
+  File32 dir = filesys.open(dirPath);
+  File32 entry;
+  char   name[48], path[96];
+
+  if(!dir) return;
+  while(entry.openNext(&dir, O_RDONLY)) {
+    entry.getName(name, sizeof name);
+    snprintf(path, sizeof path, "%s%s%s", dirPath,
+      strcmp(dirPath, "/") ? "/" : "", name);
+    bool isDir = entry.isDir();
+    entry.close();
+    if(isDir) {
+      walk(path);
+    } else {
+      int len = strlen(name);
+      if((len > 4) && !strcasecmp(&name[len - 4], ".bmp")) {
+        benchmark(path);
+      }
+    }
+  }
+  dir.close();
+}
+
+void setup(void) {
+
+  Serial.begin(9600);
+  while(!Serial)  delay(100);       // Wait for Serial Monitor before continuing
+
+  display.begin();
+
+  Serial.print(F("Initializing filesystem..."));
+#if defined(USE_SD_CARD)
+  if(!SD.begin(SD_CS, SD_SCK_MHZ(10))) {
+    Serial.println(F("SD begin() failed"));
+    for(;;); // Fatal error, do not continue
+  }
+#else
+  if(!flash.begin()) {
+    Serial.println(F("flash begin() failed"));
+    for(;;);
+  }
+  if(!filesys.begin(&flash)) {
+    Serial.println(F("filesys begin() failed"));
+    for(;;);
+  }
+#endif
+  Serial.println(F("OK!"));
+
+  reader.setStats(&stats); // Enable statistics collection
+  walk("/");
+  Serial.println(F("Done."));
+}
+
+void loop() {
+}
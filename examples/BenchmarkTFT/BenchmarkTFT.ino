@@ -0,0 +1,196 @@
+// Adafruit_ImageReader decode benchmark for 2.4" TFT FeatherWing. Walks
+// every folder on the SD card (or flash) and, for each BMP file found,
+// times drawBMP() to the screen and loadBMP() to RAM, printing per-image
+// statistics: pixels/sec, bytes read, number of read() and seek() calls,
+// and time spent in header parsing, file reads, pixel conversion and
+// display writes. If a QOI file of the same name sits alongside (made with
+// extras/bmp2rgb565 -q), drawQOI() and loadQOI() are timed too, for a
+// direct comparison. OPEN THE ARDUINO SERIAL MONITOR WINDOW TO START PROGRAM.
+// Copy the contents of the library's images/ folder (subfolders included)
+// to the root directory of the SD card or flash.
+
+#include <Adafruit_GFX.h>         // Core graphics library
+#include <Adafruit_ILI9341.h>     // Hardware-specific library
+#include <SdFat_Adafruit_Fork.h>  // SD card & FAT filesystem library
+#include <Adafruit_SPIFlash.h>    // SPI / QSPI flash library
+#include <Adafruit_ImageReader.h> // Image-reading functions
+
+// Comment out the next line to load from SPI/QSPI flash instead of SD card:
+#define USE_SD_CARD
+
+// Pin definitions for 2.4" TFT FeatherWing vary among boards...
+
+#if defined(ESP8266)
+  #define TFT_CS   0
+  #define TFT_DC   15
+  #define SD_CS    2
+#elif defined(ESP32) && !defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S2)
+  #define TFT_CS   15
+  #define TFT_DC   33
+  #define SD_CS    14
+#elif defined(TEENSYDUINO)
+  #define TFT_DC   10
+  #define TFT_CS   4
+  #define SD_CS    8
+#elif defined(ARDUINO_STM32_FEATHER)
+  #define TFT_DC   PB4
+  #define TFT_CS   PA15
+  #define SD_CS    PC5
+#elif defined(ARDUINO_NRF52832_FEATHER) // BSP 0.6.5 and higher!
+  #define TFT_DC   11
+  #define TFT_CS   31
+  #define SD_CS    27
+#elif defined(ARDUINO_MAX32620FTHR) || defined(ARDUINO_MAX32630FTHR)
+  #define TFT_DC   P5_4
+  #define TFT_CS   P5_3
+  #define STMPE_CS P3_3
+  #define SD_CS    P3_2
+#elif defined(ARDUINO_ADAFRUIT_FEATHER_RP2040)
+  #define TFT_CS   9
+  #define TFT_DC   10
+  #define SD_CS    7 // "pin 5" on original rp2040 feather ONLY
+#else // Anything else!
+  #define TFT_CS   9
+  #define TFT_DC   10
+  #define SD_CS    5
+#endif
+
+#if defined(USE_SD_CARD)
+  SdFat                SD;         // SD card filesystem
+  FatVolume           &filesys = SD;
+  Adafruit_ImageReader reader(SD); // Image-reader object, pass in SD filesys
+#else
+  // SPI or QSPI flash filesystem (i.e. CIRCUITPY drive)
+  #if defined(__SAMD51__) || defined(NRF52840_XXAA)
+    Adafruit_FlashTransport_QSPI flashTransport(PIN_QSPI_SCK, PIN_QSPI_CS,
+      PIN_QSPI_IO0, PIN_QSPI_IO1, PIN_QSPI_IO2, PIN_QSPI_IO3);
+  #else
+    #if (SPI_INTERFACES_COUNT == 1)
+      Adafruit_FlashTransport_SPI flashTransport(SS, &SPI);
+    #else
+      Adafruit_FlashTransport_SPI flashTransport(SS1, &SPI1);
+    #endif
+  #endif
+  Adafruit_SPIFlash    flash(&flashTransport);
+  FatVolume            filesys;
+  Adafruit_ImageReader reader(filesys); // Image-reader, pass in flash filesys
+#endif
+
+Adafruit_ILI9341       tft = Adafruit_ILI9341(TFT_CS, TFT_DC);
+ImageReaderStats       stats;      // Filled in by each reader call
+
+// Print one line of results for a single draw or load call
+void printStats(const char *what, const char *path, ImageReturnCode stat) {
+  Serial.print(what);
+  Serial.print(path);
+  if(stat != IMAGE_SUCCESS) {
+    Serial.print(F(": "));
+    reader.printStatus(stat);
+    return;
+  }
+  uint32_t other = stats.headerTime + stats.readTime + stats.writeTime;
+  uint32_t convert = (stats.totalTime > other) ? stats.totalTime - other : 0;
+  Serial.print(F(": "));
+  Serial.print(stats.totalTime);
+  Serial.print(F(" us, "));
+  Serial.print(stats.totalTime ?
+    (uint32_t)((uint64_t)stats.pixels * 1000000 / stats.totalTime) : 0);
+  Serial.print(F(" px/s, "));
+  Serial.print(stats.bytesRead);
+  Serial.print(F(" bytes, "));
+  Serial.print(stats.reads);
+  Serial.print(F(" reads, "));
+  Serial.print(stats.seeks);
+  Serial.print(F(" seeks, header "));
+  Serial.print(stats.headerTime);
+  Serial.print(F(" us, read "));
+  Serial.print(stats.readTime);
+  Serial.print(F(" us, convert "));
+  Serial.print(convert);
+  Serial.print(F(" us, write "));
+  Serial.print(stats.writeTime);
+  Serial.println(F(" us"));
+}
+
+// Run draw & load benchmarks on one BMP file, and its QOI twin if present
+void benchmark(const char *path) {
+  Adafruit_Image img;
+  ImageReturnCode stat;
+  char qoiPath[96];
+
+  tft.fillScreen(0);
+  stat = reader.drawBMP(path, tft, 0, 0);
+  printStats("drawBMP ", path, stat);
+
+  stat = reader.loadBMP(path, img); // May fail on small devices, that's OK
+  printStats("loadBMP ", path, stat);
+
+  strcpy(qoiPath, path); // Same name, .bmp -> .qoi
+  strcpy(&qoiPath[strlen(qoiPath) - 4], ".qoi");
+  if(!filesys.exists(qoiPath)) return;
+
+  tft.fillScreen(0);
+  stat = reader.drawQOI(qoiPath, tft, 0, 0);
+  printStats("drawQOI ", qoiPath, stat);
+
+  stat = reader.loadQOI(qoiPath, img);
+  printStats("loadQOI ", qoiPath, stat);
+}
+
+// Recursively visit every .bmp file in a folder
+void walk(const char *dirPath) {
+  File32 dir = filesys.open(dirPath);
+  File32 entry;
+  char   name[48], path[96];
+
+  if(!dir) return;
+  while(entry.openNext(&dir, O_RDONLY)) {
+    entry.getName(name, sizeof name);
+    snprintf(path, sizeof path, "%s%s%s", dirPath,
+      strcmp(dirPath, "/") ? "/" : "", name);
+    bool isDir = entry.isDir();
+    entry.close();
+    if(isDir) {
+      walk(path);
+    } else {
+      int len = strlen(name);
+      if((len > 4) && !strcasecmp(&name[len - 4], ".bmp")) {
+        benchmark(path);
+      }
+    }
+  }
+  dir.close();
+}
+
+void setup(void) {
+
+  Serial.begin(9600);
+  while(!Serial)  delay(100);       // Wait for Serial Monitor before continuing
+
+  tft.begin();          // Initialize screen
+
+  Serial.print(F("Initializing filesystem..."));
+#if defined(USE_SD_CARD)
+  if(!SD.begin(SD_CS, SD_SCK_MHZ(12))) {
+    Serial.println(F("SD begin() failed"));
+    for(;;); // Fatal error, do not continue
+  }
+#else
+  if(!flash.begin()) {
+    Serial.println(F("flash begin() failed"));
+    for(;;);
+  }
+  if(!filesys.begin(&flash)) {
+    Serial.println(F("filesys begin() failed"));
+    for(;;);
+  }
+#endif
+  Serial.println(F("OK!"));
+
+  reader.setStats(&stats); // Enable statistics collection
+  walk("/");
+  Serial.println(F("Done."));
+}
+
+void loop() {
+}
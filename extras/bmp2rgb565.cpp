@@ -0,0 +1,367 @@
+/*!
+ * @file bmp2rgb565.cpp
+ *
+ * Host-side (desktop) tool to convert BMP images to the raw RGB565 format
+ * read by Adafruit_ImageReader::drawRGB565() and loadRGB565(). Not part
+ * of the Arduino library build. Compile with any C++11 compiler, e.g.:
+ *
+ *   g++ -O2 -o bmp2rgb565 bmp2rgb565.cpp
+ *
+ * Usage:
+ *
+ *   bmp2rgb565 [-z] [-r rows] [-w window] [-q] file.bmp [file.bmp ...]
+ *
+ * Each input is written alongside as a .565 file (e.g. images/adabot.bmp
+ * becomes images/adabot.565). Uncompressed 24- and 32-bit BMPs and 1-,
+ * 4- and 8-bit palettized BMPs are handled; colors are reduced to 565 the
+ * same way drawBMP() does, so either file draws identically.
+ *
+ * File format: "R565", then width and height as 16-bit little-endian
+ * values, then top-to-bottom rows of big-endian 565 pixels, no padding.
+ *
+ * With -z, output is instead LZ4-compressed (.lz565 file) for
+ * drawLZ565() and loadLZ565(). Every 'rows' rows (default 16) are
+ * compressed as a separate block, so a clipped draw can skip blocks
+ * off-screen. 'window' (default 1024) is the farthest back, in bytes,
+ * that a match may copy from; the decoder needs a ring buffer at least
+ * this big, so keep it small for small microcontrollers (the default
+ * suits everything but AVR, where 256 is safe).
+ *
+ * With -q, output is instead a QOI image (.qoi file, see qoiformat.org)
+ * for drawQOI() and loadQOI(). Full 8-bit color is kept (it's reduced to
+ * 565 when drawn), as is alpha from 32-bit BMPs. The size relative to
+ * the BMP is printed, as it's the main factor in load time from SD.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static uint32_t le(const std::vector<uint8_t> &d, size_t pos, int bytes) {
+  uint32_t v = 0;
+  for (int i = bytes - 1; i >= 0; i--)
+    v = (v << 8) | d[pos + i];
+  return v;
+}
+
+static bool compress = false; // -z: write .lz565
+static bool qoi = false;      // -q: write .qoi
+static uint32_t blockRows = 16;  // -r: rows per LZ4 block
+static uint32_t window = 1024;   // -w: max. match offset in bytes
+
+static void put16(std::vector<uint8_t> &d, uint32_t v) {
+  d.push_back(v);
+  d.push_back(v >> 8);
+}
+
+static void put32(std::vector<uint8_t> &d, uint32_t v) {
+  put16(d, v);
+  put16(d, v >> 16);
+}
+
+// Append LZ4 length continuation bytes (for lengths of 15 and up)
+static void putLength(std::vector<uint8_t> &d, uint32_t len) {
+  for (len -= 15; len >= 255; len -= 255)
+    d.push_back(255);
+  d.push_back(len);
+}
+
+// Compress 'len' bytes at 'src' as one raw LZ4 block, appended to 'out'.
+// Greedy hash-chain search; matches reach back at most 'window' bytes.
+static void lz4Block(const uint8_t *src, uint32_t len,
+                     std::vector<uint8_t> &out) {
+  const int hashBits = 14, maxChain = 64;
+  std::vector<int32_t> head(1 << hashBits, -1), prev(len, -1);
+  uint32_t anchor = 0, pos = 0;
+  // Per LZ4 rules, the last 5 bytes are literals and no match may start
+  // in the last 12.
+  uint32_t matchLimit = (len > 12) ? len - 12 : 0;
+  auto hash = [&](uint32_t p) {
+    uint32_t v = src[p] | (src[p + 1] << 8) | (src[p + 2] << 16) |
+                 ((uint32_t)src[p + 3] << 24);
+    return (v * 2654435761u) >> (32 - hashBits);
+  };
+  auto insert = [&](uint32_t p) {
+    uint32_t h = hash(p);
+    prev[p] = head[h];
+    head[h] = p;
+  };
+
+  while (pos < matchLimit) {
+    uint32_t bestLen = 0, bestOff = 0;
+    int chain = maxChain;
+    for (int32_t cand = head[hash(pos)];
+         (cand >= 0) && (pos - cand <= window) && chain--; cand = prev[cand]) {
+      uint32_t n = 0;
+      while ((pos + n < len - 5) && (src[cand + n] == src[pos + n]))
+        n++;
+      if (n > bestLen) {
+        bestLen = n;
+        bestOff = pos - cand;
+      }
+    }
+    if (bestLen < 4) {
+      insert(pos++);
+      continue;
+    }
+    // Sequence: token, literals, offset, match length
+    uint32_t lit = pos - anchor, ml = bestLen - 4;
+    out.push_back(((lit < 15) ? lit : 15) << 4 | ((ml < 15) ? ml : 15));
+    if (lit >= 15)
+      putLength(out, lit);
+    out.insert(out.end(), src + anchor, src + pos);
+    put16(out, bestOff);
+    if (ml >= 15)
+      putLength(out, ml);
+    for (uint32_t end = pos + bestLen; pos < end; pos++) {
+      if (pos < matchLimit)
+        insert(pos);
+    }
+    anchor = pos;
+  }
+  // Final sequence: literals only
+  uint32_t lit = len - anchor;
+  out.push_back(((lit < 15) ? lit : 15) << 4);
+  if (lit >= 15)
+    putLength(out, lit);
+  out.insert(out.end(), src + anchor, src + len);
+}
+
+// Encode 'w' x 'h' R,G,B,A pixels as a QOI image, appended to 'out'.
+// 'channels' (3 or 4) goes in the header; alpha is encoded either way.
+static void qoiImage(const std::vector<uint8_t> &rgba, uint32_t w, uint32_t h,
+                     uint8_t channels, std::vector<uint8_t> &out) {
+  uint8_t index[64][4] = {{0}}, prev[4] = {0, 0, 0, 255};
+  uint32_t run = 0, n = w * h;
+  const char magic[] = "qoif";
+  out.insert(out.end(), magic, magic + 4);
+  for (int i = 24; i >= 0; i -= 8)
+    out.push_back(w >> i);
+  for (int i = 24; i >= 0; i -= 8)
+    out.push_back(h >> i);
+  out.push_back(channels);
+  out.push_back(0); // sRGB with linear alpha
+  for (uint32_t i = 0; i < n; i++) {
+    const uint8_t *px = &rgba[i * 4];
+    if (!memcmp(px, prev, 4)) {
+      if ((++run == 62) || (i == n - 1)) {
+        out.push_back(0xC0 | (run - 1)); // QOI_OP_RUN
+        run = 0;
+      }
+      continue;
+    }
+    if (run) {
+      out.push_back(0xC0 | (run - 1));
+      run = 0;
+    }
+    uint8_t h = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) & 63;
+    if (!memcmp(index[h], px, 4)) {
+      out.push_back(h); // QOI_OP_INDEX
+    } else {
+      memcpy(index[h], px, 4);
+      int8_t dr = px[0] - prev[0], dg = px[1] - prev[1], db = px[2] - prev[2];
+      int8_t dr_dg = dr - dg, db_dg = db - dg;
+      if (px[3] != prev[3]) { // QOI_OP_RGBA
+        out.push_back(0xFF);
+        out.insert(out.end(), px, px + 4);
+      } else if ((dr >= -2) && (dr <= 1) && (dg >= -2) && (dg <= 1) &&
+                 (db >= -2) && (db <= 1)) { // QOI_OP_DIFF
+        out.push_back(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+      } else if ((dg >= -32) && (dg <= 31) && (dr_dg >= -8) && (dr_dg <= 7) &&
+                 (db_dg >= -8) && (db_dg <= 7)) { // QOI_OP_LUMA
+        out.push_back(0x80 | (dg + 32));
+        out.push_back(((dr_dg + 8) << 4) | (db_dg + 8));
+      } else { // QOI_OP_RGB
+        out.push_back(0xFE);
+        out.insert(out.end(), px, px + 3);
+      }
+    }
+    memcpy(prev, px, 4);
+  }
+  static const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+  out.insert(out.end(), end, end + 8);
+}
+
+// Convert one BMP file, return true on success
+static bool convert(const char *inName) {
+  std::vector<uint8_t> d;
+  FILE *in = fopen(inName, "rb");
+  if (!in) {
+    fprintf(stderr, "%s: can't open\n", inName);
+    return false;
+  }
+  int c;
+  while ((c = fgetc(in)) != EOF)
+    d.push_back(c);
+  fclose(in);
+
+  if ((d.size() < 54) || (le(d, 0, 2) != 0x4D42)) {
+    fprintf(stderr, "%s: not a BMP file\n", inName);
+    return false;
+  }
+  uint32_t offset = le(d, 10, 4), headerSize = le(d, 14, 4);
+  int32_t width = (int32_t)le(d, 18, 4), height = (int32_t)le(d, 22, 4);
+  uint32_t depth = le(d, 28, 2), compression = le(d, 30, 4);
+  uint32_t colors = le(d, 46, 4);
+  bool flip = true; // BMP is stored bottom-to-top
+  if (height < 0) {
+    height = -height;
+    flip = false;
+  }
+  // BI_BITFIELDS is accepted for 32-bit if masks are standard BGRA
+  if ((compression == 3) && (depth == 32) && (d.size() >= 66) &&
+      (le(d, 54, 4) == 0xFF0000) && (le(d, 58, 4) == 0xFF00) &&
+      (le(d, 62, 4) == 0xFF))
+    compression = 0;
+  if ((compression != 0) || ((depth != 32) && (depth != 24) && (depth != 8) &&
+                             (depth != 4) && (depth != 1))) {
+    fprintf(stderr, "%s: unsupported BMP format (%u-bit, compression %u)\n",
+            inName, depth, compression);
+    return false;
+  }
+  if ((width < 1) || (width > 65535) || (height < 1) || (height > 65535)) {
+    fprintf(stderr, "%s: unsupported size %dx%d\n", inName, width, height);
+    return false;
+  }
+  uint32_t rowSize = ((depth * width + 31) / 32) * 4;
+  if (offset + (uint64_t)rowSize * height > d.size()) {
+    fprintf(stderr, "%s: file is truncated\n", inName);
+    return false;
+  }
+
+  // Palette, if any (B, G, R, ignore 4th byte)
+  uint8_t palette[256][4] = {{0}};
+  if (depth <= 8) {
+    if (!colors || (colors > (1u << depth)))
+      colors = 1u << depth;
+    for (uint32_t i = 0; i < colors; i++) {
+      size_t p = 14 + headerSize + i * 4;
+      if (p + 3 <= d.size())
+        memcpy(palette[i], &d[p], 3);
+    }
+  }
+
+  std::vector<uint8_t> out = {'R', '5', '6', '5', (uint8_t)width,
+                              (uint8_t)(width >> 8), (uint8_t)height,
+                              (uint8_t)(height >> 8)};
+  out.reserve(out.size() + (size_t)width * height * 2);
+  std::vector<uint8_t> rgba; // For QOI
+  bool alpha = false;        // Any pixel not opaque (32-bit BMP only)
+  const char *ext = ".565";
+  for (int32_t row = 0; row < height; row++) {
+    const uint8_t *src =
+        &d[offset + (flip ? (height - 1 - row) : row) * rowSize];
+    for (int32_t col = 0; col < width; col++) {
+      const uint8_t *p; // B, G, R (, A)
+      uint8_t a = 255;
+      if (depth >= 24) {
+        p = &src[col * (depth / 8)];
+        if (depth == 32)
+          a = p[3];
+      } else { // Palette index, leftmost pixel in most significant bits
+        uint32_t bit = col * depth;
+        uint8_t idx = (src[bit / 8] >> (8 - depth - (bit & 7))) &
+                      ((1 << depth) - 1);
+        p = palette[idx];
+      }
+      if (qoi) {
+        uint8_t px[4] = {p[2], p[1], p[0], a};
+        rgba.insert(rgba.end(), px, px + 4);
+        alpha |= (a != 255);
+      } else {
+        uint16_t rgb =
+            ((p[2] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[0] >> 3);
+        out.push_back(rgb >> 8); // Big-endian, as sent to the display
+        out.push_back(rgb & 0xFF);
+      }
+    }
+  }
+
+  if (qoi) {
+    out.clear();
+    qoiImage(rgba, width, height, alpha ? 4 : 3, out);
+    ext = ".qoi";
+  } else if (compress) {
+    // Header, block table (filled in below), then the blocks
+    std::vector<uint8_t> z = {'L', '5', '6', '5'};
+    uint32_t blocks = (height + blockRows - 1) / blockRows;
+    put16(z, width);
+    put16(z, height);
+    put16(z, blockRows);
+    put16(z, window);
+    z.resize(z.size() + blocks * 4);
+    for (uint32_t b = 0; b < blocks; b++) {
+      size_t start = 8 + (size_t)b * blockRows * width * 2;
+      size_t end = std::min(start + (size_t)blockRows * width * 2, out.size());
+      uint32_t pos = z.size();
+      z[12 + b * 4] = pos;
+      z[13 + b * 4] = pos >> 8;
+      z[14 + b * 4] = pos >> 16;
+      z[15 + b * 4] = pos >> 24;
+      put32(z, 0); // Compressed size, filled in after
+      lz4Block(&out[start], end - start, z);
+      uint32_t size = z.size() - pos - 4;
+      for (int i = 0; i < 4; i++)
+        z[pos + i] = size >> (i * 8);
+    }
+    out.swap(z);
+    ext = ".lz565";
+  }
+
+  std::string outName = inName;
+  size_t dot = outName.find_last_of('.');
+  size_t slash = outName.find_last_of("/\\");
+  if ((dot != std::string::npos) &&
+      ((slash == std::string::npos) || (dot > slash)))
+    outName.erase(dot);
+  outName += ext;
+  FILE *outFile = fopen(outName.c_str(), "wb");
+  if (!outFile || (fwrite(out.data(), 1, out.size(), outFile) != out.size())) {
+    fprintf(stderr, "%s: can't write\n", outName.c_str());
+    if (outFile)
+      fclose(outFile);
+    return false;
+  }
+  fclose(outFile);
+  printf("%s -> %s (%dx%d", inName, outName.c_str(), width, height);
+  if (qoi)
+    printf(", %.1f%% of BMP size", 100.0 * out.size() / d.size());
+  printf(")\n");
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int i, errors = 0;
+  for (i = 1; (i < argc) && (argv[i][0] == '-'); i++) {
+    if (!strcmp(argv[i], "-z")) {
+      compress = true;
+    } else if (!strcmp(argv[i], "-q")) {
+      qoi = true;
+    } else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) {
+      blockRows = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-w") && (i + 1 < argc)) {
+      window = atoi(argv[++i]);
+    } else {
+      break;
+    }
+  }
+  if ((i >= argc) || (argv[i][0] == '-') || (blockRows < 1) ||
+      (blockRows > 65535) || (window < 1) || (window > 65535)) {
+    fprintf(stderr,
+            "Usage: %s [-z] [-r rows] [-w window] [-q] file.bmp "
+            "[file.bmp ...]\n",
+            argv[0]);
+    return 1;
+  }
+  for (; i < argc; i++) {
+    if (!convert(argv[i]))
+      errors++;
+  }
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*!
+ * @file benchmark.cpp
+ *
+ * Host decode benchmark for Adafruit_ImageReader. Every BMP in a folder
+ * (subfolders included) goes through drawBMP() to a TFT, loadBMP() to
+ * RAM, and the EPD drawBMP() from file and from memory; if there's a .qoi
+ * copy of it (bmp2rgb565 -q, as in the CMake build's images folder), that
+ * goes through drawQOI() and loadQOI() for comparison. Each call is
+ * repeated and the fastest run is reported, one line per image and path:
+ * microseconds, megapixels/second, bytes read, file read() and seek()
+ * calls, time spent in header parsing, file reads, pixel conversion and
+ * display writes (from ImageReaderStats; the in-memory EPD path has no
+ * file and keeps no statistics), and calls into the display object. Host
+ * times are only comparable with each other, not with a board, but the
+ * read, seek and display call counts are the same as on hardware.
+ * See CMakeLists.txt.
+ *
+ * Usage: benchmark [-n repeats] [-m epdmode] folder
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "Adafruit_ImageReader.h"
+#include "Adafruit_ImageReader_EPD.h"
+#include <dirent.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+static FatVolume filesys;
+static int repeats = 5;                            // -n
+static thinkinkmode_t epdMode = THINKINK_TRICOLOR; // -m
+
+// List .bmp files in folder and subfolders, relative to folder
+static void findBMPs(const std::string &root, const std::string &sub,
+                     std::vector<std::string> &names) {
+  DIR *dir = opendir((root + "/" + sub).c_str());
+  if (!dir)
+    return;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    std::string name = entry->d_name;
+    if (name[0] == '.')
+      continue;
+    std::string path = sub.empty() ? name : sub + "/" + name;
+    if ((name.size() > 4) && (name.substr(name.size() - 4) == ".bmp"))
+      names.push_back(path);
+    else
+      findBMPs(root, path, names); // Fails harmlessly if not a folder
+  }
+  closedir(dir);
+}
+
+// Run one call 'repeats' times and print the fastest. The call fills in
+// 'stats' (if that path keeps them) and returns how many calls it made
+// into the display object.
+static void bench(const char *path, const std::string &image,
+                  uint32_t pixels, ImageReaderStats &stats,
+                  std::function<uint32_t(void)> call) {
+  ImageReaderStats best;
+  uint32_t bestTime = 0xFFFFFFFF, bestCalls = 0;
+  for (int i = 0; i < repeats; i++) {
+    memset(&stats, 0, sizeof stats);
+    uint32_t t = micros();
+    uint32_t calls = call();
+    t = micros() - t;
+    if (t < bestTime) {
+      bestTime = t;
+      best = stats;
+      bestCalls = calls;
+    }
+  }
+  uint32_t other = best.headerTime + best.readTime + best.writeTime;
+  uint32_t convert = (best.totalTime > other) ? best.totalTime - other : 0;
+  printf("%-11s %8u %7.2f %8u %6u %6u %7u %7u %7u %7u %8u  %s\n", path,
+         bestTime, bestTime ? (double)pixels / bestTime : 0.0,
+         best.bytesRead, best.reads, best.seeks, best.headerTime,
+         best.readTime, convert, best.writeTime, bestCalls, image.c_str());
+}
+
+int main(int argc, char *argv[]) {
+  int i;
+  for (i = 1; (i < argc - 1) && (argv[i][0] == '-'); i += 2) {
+    if (!strcmp(argv[i], "-n"))
+      repeats = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-m"))
+      epdMode = (thinkinkmode_t)atoi(argv[i + 1]);
+    else
+      break;
+  }
+  if ((i != argc - 1) || (repeats < 1)) {
+    fprintf(stderr, "Usage: %s [-n repeats] [-m epdmode] folder\n",
+            argv[0]);
+    return 2;
+  }
+  std::string root = argv[i];
+  std::vector<std::string> names;
+  filesys.begin(argv[i]);
+  findBMPs(root, "", names);
+  std::sort(names.begin(), names.end());
+  if (names.empty()) {
+    fprintf(stderr, "%s: no BMP files\n", argv[i]);
+    return 1;
+  }
+
+  ImageReaderStats stats;
+  Adafruit_ImageReader_EPD reader(filesys);
+  reader.setStats(&stats);
+  printf("%-11s %8s %7s %8s %6s %6s %7s %7s %7s %7s %8s  %s\n", "path", "us",
+         "Mpx/s", "bytes", "reads", "seeks", "header", "read", "convert",
+         "write", "calls", "image");
+  for (const std::string &name : names) {
+    int32_t w, h;
+    if ((reader.bmpDimensions(name.c_str(), &w, &h) != IMAGE_SUCCESS) ||
+        (w < 1) || (h < 1)) {
+      printf("%-11s %s: not a supported BMP\n", "", name.c_str());
+      continue;
+    }
+    uint32_t pixels = w * h;
+    std::vector<char> filename(name.begin(), name.end());
+    filename.push_back(0);
+    std::vector<uint8_t> bmp;
+    FILE *f = fopen((root + "/" + name).c_str(), "rb");
+    if (f) {
+      int c;
+      while ((c = fgetc(f)) != EOF)
+        bmp.push_back(c);
+      fclose(f);
+    }
+
+    Adafruit_SPITFT tft(w, h);
+    bench("drawBMP", name, pixels, stats, [&]() {
+      uint32_t before = tft.windows + tft.pixelWrites + tft.colorWrites;
+      reader.Adafruit_ImageReader::drawBMP(name.c_str(), tft, 0, 0);
+      return tft.windows + tft.pixelWrites + tft.colorWrites - before;
+    });
+    bench("loadBMP", name, pixels, stats, [&]() {
+      Adafruit_Image img;
+      reader.loadBMP(name.c_str(), img);
+      return (uint32_t)0;
+    });
+    // QOI copy made by bmp2rgb565 -q, same pixels as the BMP
+    std::string qoi = name.substr(0, name.size() - 4) + ".qoi";
+    if (filesys.exists(qoi.c_str())) {
+      bench("drawQOI", qoi, pixels, stats, [&]() {
+        uint32_t before = tft.windows + tft.pixelWrites + tft.colorWrites;
+        reader.drawQOI(qoi.c_str(), tft, 0, 0);
+        return tft.windows + tft.pixelWrites + tft.colorWrites - before;
+      });
+      bench("loadQOI", qoi, pixels, stats, [&]() {
+        Adafruit_Image img;
+        reader.loadQOI(qoi.c_str(), img);
+        return (uint32_t)0;
+      });
+    }
+    Adafruit_EPD epd(w, h, epdMode);
+    bench("EPD file", name, pixels, stats, [&]() {
+      uint32_t before = epd.pixelWrites;
+      reader.drawBMP(filename.data(), epd, 0, 0);
+      return epd.pixelWrites - before;
+    });
+    bench("EPD memory", name, pixels, stats, [&]() {
+      uint32_t before = epd.pixelWrites;
+      reader.drawBMP(bmp.data(), bmp.size(), epd, 0, 0);
+      return epd.pixelWrites - before;
+    });
+  }
+  return 0;
+}
@@ -0,0 +1,57 @@
+/*!
+ * @file colormap_test.cpp
+ *
+ * Host check that the EPD color lookup table is exact: for every display
+ * mode, mapColor() and mapColors() with a table from initColorMap() must
+ * give the same EPD color as mapColorForDisplay() for all 2^24 RGB colors.
+ * See CMakeLists.txt.
+ *
+ * Usage: colormap_test
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "Adafruit_ImageReader_EPD.h"
+
+int main(void) {
+  static const thinkinkmode_t modes[] = {THINKINK_MONO, THINKINK_TRICOLOR,
+                                         THINKINK_GRAYSCALE4,
+                                         THINKINK_QUADCOLOR,
+                                         THINKINK_MONO_PARTIAL};
+  uint8_t bgr[256 * 3];
+  uint16_t dest[256];
+  int failures = 0;
+
+  for (thinkinkmode_t mode : modes) {
+    EPDColorMap map;
+    uint32_t wrong = 0;
+    Adafruit_ImageReader_EPD::initColorMap(map, mode);
+    for (int r = 0; r < 256; r++) {
+      for (int g = 0; g < 256; g++) {
+        for (int b = 0; b < 256; b++) { // One row of all blues for mapColors()
+          bgr[b * 3] = b;
+          bgr[b * 3 + 1] = g;
+          bgr[b * 3 + 2] = r;
+        }
+        Adafruit_ImageReader_EPD::mapColors(map, bgr, dest, 256);
+        for (int b = 0; b < 256; b++) {
+          uint8_t expect =
+              Adafruit_ImageReader_EPD::mapColorForDisplay(r, g, b, mode);
+          if ((Adafruit_ImageReader_EPD::mapColor(map, r, g, b) != expect) ||
+              (dest[b] != expect)) {
+            if (!wrong++)
+              printf("FAIL: mode %d, RGB %02X%02X%02X: expected %d, "
+                     "mapColor() %d, mapColors() %d\n",
+                     mode, r, g, b, expect,
+                     Adafruit_ImageReader_EPD::mapColor(map, r, g, b),
+                     dest[b]);
+          }
+        }
+      }
+    }
+    printf("%s  mode %d (%u colors wrong)\n", wrong ? "FAIL" : "ok  ", mode,
+           wrong);
+    failures += !!wrong;
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,919 @@
+/*!
+ * @file decode_test.cpp
+ *
+ * Host regression test for Adafruit_ImageReader. Every BMP in a folder
+ * (subfolders included), along with any .565, .lz565 and .qoi copy of it
+ * made by extras/bmp2rgb565 and a PNG copy written here, is drawn to a TFT
+ * and loaded to RAM and drawn from there, at the top-left corner and
+ * clipped across the left and bottom edges; the pixels must match a simple
+ * reference BMP reader. BMPs are also drawn with the TFT's scan reversed,
+ * on panels at different offsets in controller RAM. Each BMP is drawn to
+ * an EPD in every display mode, from file and from memory, and must match
+ * mapColorForDisplay(); with dithering, file and memory must agree; and
+ * loaded and drawn to an EPD. BMPs generated here cover what images/
+ * lacks (4- and 8-bit palettes, 16-bit 555 and 565, 32-bit BGRA in each
+ * alpha mode, RLE), compared the same way against the generator's own
+ * pixels. Draws and loads are repeated with a small, misaligned
+ * setBuffer() buffer and a large one, which must also make drawBMP() use
+ * fewer reads (and for bottom-up BMPs, fewer seeks), and with run fills
+ * on, which must send long runs with writeColor(). BMP headers with
+ * out-of-range sizes must be rejected by every path. Every call must
+ * close its files, end its display transaction and stay off the SD card
+ * while the transaction is open. See CMakeLists.txt.
+ *
+ * Usage: decode_test folder
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "Adafruit_ImageReader_EPD.h"
+#include "host_test.h"
+#include <dirent.h>
+#include <functional>
+
+static uint32_t le(const std::vector<uint8_t> &d, size_t pos, int bytes) {
+  uint32_t v = 0;
+  for (int i = bytes - 1; i >= 0; i--)
+    v = (v << 8) | d[pos + i];
+  return v;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  int c;
+  data.clear();
+  while ((c = fgetc(f)) != EOF)
+    data.push_back(c);
+  fclose(f);
+  return true;
+}
+
+// Decode an uncompressed 1-, 4-, 8-, 24- or 32-bit BMP, independently of
+// the library. Returns false for anything else.
+static bool readBMP(const std::vector<uint8_t> &d, Reference &ref) {
+  if ((d.size() < 54) || (le(d, 0, 2) != 0x4D42) || le(d, 30, 4))
+    return false;
+  uint32_t offset = le(d, 10, 4), headerSize = le(d, 14, 4);
+  uint32_t depth = le(d, 28, 2), colors = le(d, 46, 4);
+  int32_t height = (int32_t)le(d, 22, 4);
+  bool flip = height > 0; // Bottom-to-top
+  ref.width = (int32_t)le(d, 18, 4);
+  ref.height = flip ? height : -height;
+  if ((ref.width < 1) || (ref.height < 1) ||
+      ((depth != 1) && (depth != 4) && (depth != 8) && (depth != 24) &&
+       (depth != 32)))
+    return false;
+  uint32_t rowSize = ((depth * ref.width + 31) / 32) * 4;
+  if (offset + (uint64_t)rowSize * ref.height > d.size())
+    return false;
+  if (!colors || (colors > (1u << depth)))
+    colors = 1u << depth;
+  ref.rgb.resize((size_t)ref.width * ref.height * 3);
+  for (int32_t row = 0; row < ref.height; row++) {
+    size_t src = offset + (flip ? ref.height - 1 - row : row) * rowSize;
+    for (int32_t col = 0; col < ref.width; col++) {
+      size_t p; // Position of B, G, R in file
+      if (depth >= 24) {
+        p = src + col * (depth / 8);
+      } else {
+        uint32_t bit = col * depth;
+        uint32_t idx = (d[src + bit / 8] >> (8 - depth - (bit & 7))) &
+                       ((1 << depth) - 1);
+        if (idx >= colors)
+          idx = 0;
+        p = 14 + headerSize + idx * 4;
+      }
+      uint8_t *out = &ref.rgb[(row * ref.width + col) * 3];
+      out[0] = d[p + 2];
+      out[1] = d[p + 1];
+      out[2] = d[p];
+    }
+  }
+  return true;
+}
+
+// PNG chunk: length, type, data, CRC-32 of type and data
+static void pngChunk(std::vector<uint8_t> &png, const char *type,
+                     const uint8_t *data, uint32_t len) {
+  for (int i = 24; i >= 0; i -= 8)
+    png.push_back(len >> i);
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data, data + len);
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = start; i < png.size(); i++) {
+    crc ^= png[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+  }
+  crc = ~crc;
+  for (int i = 24; i >= 0; i -= 8)
+    png.push_back(crc >> i);
+}
+
+// Write reference as an 8-bit RGB PNG, deflate 'stored' (uncompressed)
+// blocks split over many small IDAT chunks, so chunk boundaries and CRCs
+// fall all over the decoder's read buffer
+static bool writePNG(const Reference &ref, const std::string &path) {
+  std::vector<uint8_t> raw, z = {0x78, 0x01}, png = {0x89, 'P',  'N',  'G',
+                                                     0x0D, 0x0A, 0x1A, 0x0A};
+  for (int32_t row = 0; row < ref.height; row++) {
+    raw.push_back(0); // Filter type: none
+    raw.insert(raw.end(), &ref.rgb[row * ref.width * 3],
+               &ref.rgb[(row + 1) * ref.width * 3]);
+  }
+  uint32_t a = 1, b = 0; // Adler-32
+  for (size_t i = 0; i < raw.size(); i += 65535) {
+    uint32_t n = std::min(raw.size() - i, (size_t)65535);
+    z.push_back(i + n == raw.size()); // Final block flag, type 0 (stored)
+    uint8_t len[] = {(uint8_t)n, (uint8_t)(n >> 8), (uint8_t)~n,
+                     (uint8_t)(~n >> 8)};
+    z.insert(z.end(), len, len + 4);
+    z.insert(z.end(), &raw[i], &raw[i] + n);
+  }
+  for (uint8_t c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  for (int i = 24; i >= 0; i -= 8)
+    z.push_back(((b << 16) | a) >> i);
+  uint8_t ihdr[13] = {0};
+  for (int i = 0; i < 4; i++) {
+    ihdr[i] = ref.width >> (24 - i * 8);
+    ihdr[4 + i] = ref.height >> (24 - i * 8);
+  }
+  ihdr[8] = 8; // Bit depth
+  ihdr[9] = 2; // Color type: RGB
+  pngChunk(png, "IHDR", ihdr, sizeof ihdr);
+  for (size_t i = 0; i < z.size(); i += 61)
+    pngChunk(png, "IDAT", &z[i], std::min(z.size() - i, (size_t)61));
+  pngChunk(png, "IEND", NULL, 0);
+  return writeFile(path, png);
+}
+
+typedef std::function<ImageReturnCode(Adafruit_ImageReader &, const char *,
+                                      Adafruit_SPITFT &, int16_t, int16_t)>
+    DrawFunction;
+typedef std::function<ImageReturnCode(Adafruit_ImageReader &, const char *,
+                                      Adafruit_Image &)>
+    LoadFunction;
+
+// One file format: extension, draw and load functions
+typedef struct {
+  const char *extension;
+  DrawFunction draw;
+  LoadFunction load;
+} Format;
+
+static const Format formats[] = {
+    {".bmp",
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_SPITFT &t, int16_t x,
+        int16_t y) { return r.drawBMP(f, t, x, y); },
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_Image &i) {
+       return r.loadBMP(f, i);
+     }},
+    {".565",
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_SPITFT &t, int16_t x,
+        int16_t y) { return r.drawRGB565(f, t, x, y); },
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_Image &i) {
+       return r.loadRGB565(f, i);
+     }},
+    {".lz565",
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_SPITFT &t, int16_t x,
+        int16_t y) { return r.drawLZ565(f, t, x, y); },
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_Image &i) {
+       return r.loadLZ565(f, i);
+     }},
+    {".qoi",
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_SPITFT &t, int16_t x,
+        int16_t y) { return r.drawQOI(f, t, x, y); },
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_Image &i) {
+       return r.loadQOI(f, i);
+     }},
+    {".png", // Written by writePNG() for the duration of the test
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_SPITFT &t, int16_t x,
+        int16_t y) { return r.drawPNG(f, t, x, y); },
+     [](Adafruit_ImageReader &r, const char *f, Adafruit_Image &i) {
+       return r.loadPNG(f, i);
+     }},
+};
+
+// Draw and load one file at both positions, compare with reference (or
+// for the loaded image, 'loaded' if given: alpha masks leave pixels
+// undrawn, given in it as BACKGROUND's color)
+static void testTFT(Adafruit_ImageReader &reader, const Format &format,
+                    const std::string &name, const Reference &ref,
+                    const Reference *loaded = NULL) {
+  int16_t pos[2][2] = {{0, 0}, {(int16_t)(-ref.width / 3),
+                                (int16_t)(ref.height / 4)}};
+  for (int i = 0; i < 2; i++) {
+    int16_t x = pos[i][0], y = pos[i][1];
+    char at[24];
+    snprintf(at, sizeof at, " at %d,%d", x, y);
+    Adafruit_SPITFT tft(ref.width, ref.height);
+    std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+    std::string what = name + " draw" + at;
+    ImageReturnCode stat = format.draw(reader, name.c_str(), tft, x, y);
+    checkHost(what);
+    check(stat == IMAGE_SUCCESS, what + ": failed");
+    if (stat == IMAGE_SUCCESS)
+      checkTFT(tft, ref, x, y, what);
+
+    Adafruit_Image img;
+    std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+    what = name + " load" + at;
+    stat = format.load(reader, name.c_str(), img);
+    checkHost(what);
+    check(stat == IMAGE_SUCCESS, what + ": failed");
+    if (stat == IMAGE_SUCCESS) {
+      img.draw(tft, x, y);
+      checkHost(what);
+      checkTFT(tft, loaded ? *loaded : ref, x, y, what);
+    }
+  }
+}
+
+// Near the least setBuffer() memory every format draws with: 3/4 of it,
+// after alignment, must hold a .lz565 file's 1024-byte match window
+#define SMALL_BUFFER 1501
+// setBuffer() memory for several rows of the widest test image at once
+#define LARGE_BUFFER 65536
+// setRunFill() minimum, short so most images have runs
+#define RUN_FILL 4
+
+// As testTFT(), with a working buffer given to setBuffer(): 'size' bytes,
+// 'offset' bytes into an allocation so it needn't be 32-bit aligned
+static void testSetBuffer(const Format &format, const std::string &name,
+                          const Reference &ref, uint32_t size,
+                          uint32_t offset) {
+  std::vector<uint8_t> buf(size + offset);
+  Adafruit_ImageReader reader(filesys);
+  int failed = failures;
+  reader.setBuffer(&buf[offset], size);
+  testTFT(reader, format, name, ref);
+  if (failures > failed)
+    printf("  (with %u-byte buffer at offset %u)\n", (unsigned)size,
+           (unsigned)offset);
+}
+
+// drawBMP() with a buffer holding whole rows reads them in bulk: same
+// pixels (see testSetBuffer()), in fewer reads than the default buffer.
+// Bottom-up BMPs are read in blocks backwards, so also in fewer seeks.
+static void testBulkReads(const std::string &name, const Reference &ref,
+                          bool bottomUp) {
+  ImageReaderStats normal, bulk;
+  std::vector<uint8_t> buf(LARGE_BUFFER);
+  Adafruit_ImageReader reader(filesys);
+  Adafruit_SPITFT tft(ref.width, ref.height);
+  std::string what = name + " bulk reads";
+  reader.setStats(&normal);
+  check(reader.drawBMP(name.c_str(), tft, 0, 0) == IMAGE_SUCCESS,
+        what + ": failed");
+  reader.setStats(&bulk);
+  reader.setBuffer(buf.data(), buf.size());
+  check(reader.drawBMP(name.c_str(), tft, 0, 0) == IMAGE_SUCCESS,
+        what + ": failed with buffer");
+  checkHost(what);
+  check(bulk.reads < normal.reads, what + ": no fewer reads");
+  check(bulk.reads < (uint32_t)ref.height, what + ": not several rows a read");
+  if (bottomUp) {
+    check(bulk.seeks < normal.seeks, what + ": no fewer seeks");
+    check(bulk.seeks < (uint32_t)ref.height, what + ": seek per row");
+  }
+}
+
+// True if a row of ref has n pixels of one 565 color in a row
+static bool hasRun(const Reference &ref, int32_t n) {
+  for (int32_t y = 0; y < ref.height; y++) {
+    int32_t run = 0;
+    uint16_t prev = 0;
+    for (int32_t x = 0; x < ref.width; x++) {
+      const uint8_t *p = &ref.rgb[(y * ref.width + x) * 3];
+      uint16_t c = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+      run = (x && (c == prev)) ? run + 1 : 1;
+      prev = c;
+      if (run >= n)
+        return true;
+    }
+  }
+  return false;
+}
+
+// As testTFT(), with setRunFill() on. Formats that convert pixels must
+// then send an image's long runs with writeColor(); a run of 2 * RUN_FILL
+// - 1 has RUN_FILL in one block wherever a block boundary splits it.
+// .565 and .lz565 data goes to the TFT as is, without fills.
+static void testRunFill(const Format &format, const std::string &name,
+                        const Reference &ref) {
+  Adafruit_ImageReader reader(filesys);
+  int failed = failures;
+  reader.setRunFill(RUN_FILL);
+  testTFT(reader, format, name, ref);
+  if (failures > failed)
+    printf("  (with run fills)\n");
+  if (strcmp(format.extension, ".565") &&
+      strcmp(format.extension, ".lz565") && hasRun(ref, 2 * RUN_FILL - 1)) {
+    Adafruit_SPITFT tft(ref.width, ref.height);
+    check(format.draw(reader, name.c_str(), tft, 0, 0) == IMAGE_SUCCESS,
+          name + " run fill: failed");
+    checkHost(name + " run fill");
+    check(tft.colorWrites > 0, name + " run fill: no writeColor()");
+  }
+}
+
+// Draw BMP with the TFT's scan reversed, on panels filling controller
+// RAM, centered in it, and at either end of it (offset needed)
+static void testReverseScan(const std::string &name, const Reference &ref) {
+  static const int16_t panels[][3] = {// Extra RAM rows, row start, offset
+                                      {0, 0, 0},
+                                      {2, 1, 0},
+                                      {80, 0, 80},
+                                      {80, 80, -80}};
+  int16_t pos[2][2] = {{0, 0}, {(int16_t)(-ref.width / 3),
+                                (int16_t)(ref.height / 4)}};
+  for (const int16_t *panel : panels) {
+    Adafruit_ImageReader reader(filesys);
+    reader.setReverseScan(0x48, panel[2]);
+    for (int i = 0; i < 2; i++) {
+      int16_t x = pos[i][0], y = pos[i][1];
+      char at[48];
+      snprintf(at, sizeof at, " reverse scan at %d,%d, RAM +%d@%d", x, y,
+               panel[0], panel[1]);
+      Adafruit_SPITFT tft(ref.width, ref.height);
+      tft.ramHeight = ref.height + panel[0];
+      tft.rowStart = panel[1];
+      std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+      std::string what = name + " draw" + at;
+      ImageReturnCode stat = reader.drawBMP(name.c_str(), tft, x, y);
+      checkHost(what);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      check(tft.madctl == 0x48, what + ": MADCTL not restored");
+      if (stat == IMAGE_SUCCESS)
+        checkTFT(tft, ref, x, y, what);
+    }
+  }
+}
+
+// Load BMP to RAM and draw it to an EPD, in every mode. Loaded images
+// hold 565 color, so that's what the display's colors are mapped from.
+static void testEPDLoad(const std::string &name, const Reference &ref) {
+  static const thinkinkmode_t modes[] = {THINKINK_MONO, THINKINK_TRICOLOR,
+                                         THINKINK_GRAYSCALE4,
+                                         THINKINK_QUADCOLOR,
+                                         THINKINK_MONO_PARTIAL};
+  Adafruit_ImageReader_EPD reader(filesys);
+  Adafruit_Image_EPD img;
+  int16_t x = -ref.width / 3, y = ref.height / 4;
+  std::string what = name + " EPD load";
+  ImageReturnCode stat = reader.loadBMP(name.c_str(), img);
+  checkHost(what);
+  check(stat == IMAGE_SUCCESS, what + ": failed");
+  if (stat != IMAGE_SUCCESS)
+    return;
+
+  for (thinkinkmode_t mode : modes) {
+    std::string how = what + " mode " + std::to_string(mode);
+    std::vector<uint8_t> expect((size_t)ref.width * ref.height, EPD_WHITE);
+    for (int32_t row = y; row < ref.height; row++) {
+      for (int32_t col = 0; col < ref.width + x; col++) {
+        const uint8_t *p = &ref.rgb[((row - y) * ref.width + col - x) * 3];
+        expect[row * ref.width + col] = reader.mapColorForDisplay(
+            p[0] & 0xF8, p[1] & 0xFC, p[2] & 0xF8, mode);
+      }
+    }
+    Adafruit_EPD epd(ref.width, ref.height, mode);
+    img.draw(epd, x, y);
+    check(epd.framebuffer == expect, how + ": wrong colors");
+  }
+}
+
+// Draw BMP to EPD from file and from memory, in every mode
+static void testEPD(const std::string &name, const std::vector<uint8_t> &bmp,
+                    const Reference &ref) {
+  static const thinkinkmode_t modes[] = {THINKINK_MONO, THINKINK_TRICOLOR,
+                                         THINKINK_GRAYSCALE4,
+                                         THINKINK_QUADCOLOR,
+                                         THINKINK_MONO_PARTIAL};
+  Adafruit_ImageReader_EPD reader(filesys);
+  std::vector<char> filename(name.begin(), name.end());
+  filename.push_back(0);
+  int16_t x = -ref.width / 3, y = ref.height / 4;
+
+  for (thinkinkmode_t mode : modes) {
+    char what[32];
+    snprintf(what, sizeof what, " EPD mode %d", mode);
+    std::vector<uint8_t> expect((size_t)ref.width * ref.height, EPD_WHITE);
+    for (int32_t row = y; row < ref.height; row++) {
+      for (int32_t col = 0; col < ref.width + x; col++) {
+        const uint8_t *p = &ref.rgb[((row - y) * ref.width + col - x) * 3];
+        expect[row * ref.width + col] =
+            reader.mapColorForDisplay(p[0], p[1], p[2], mode);
+      }
+    }
+    for (int d = EPD_DITHER_NONE; d <= EPD_DITHER_ATKINSON; d++) {
+      Adafruit_EPD fromFile(ref.width, ref.height, mode);
+      Adafruit_EPD fromMemory(ref.width, ref.height, mode);
+      std::string how = name + what + " dither " + std::to_string(d);
+      reader.setDither((EPDDitherMode)d);
+      check(reader.drawBMP(filename.data(), fromFile, x, y) == IMAGE_SUCCESS,
+            how + " file: failed");
+      checkHost(how + " file");
+      check(reader.drawBMP(bmp.data(), bmp.size(), fromMemory, x, y) ==
+                IMAGE_SUCCESS,
+            how + " memory: failed");
+      checkHost(how + " memory");
+      check(fromFile.framebuffer == fromMemory.framebuffer,
+            how + ": file and memory differ");
+      if (d == EPD_DITHER_NONE)
+        check(fromFile.framebuffer == expect, how + ": wrong colors");
+    }
+  }
+}
+
+// BMP file with a 40-byte header: 'table' (palette or color masks)
+// follows the header, then 'gap' unused bytes, then 'pixels' as given.
+// Width and height are stored as-is (negative height is top-down).
+static std::vector<uint8_t> bmpFile(uint32_t width, uint32_t height,
+                                    uint16_t depth, uint32_t compression,
+                                    const std::vector<uint8_t> &table,
+                                    const std::vector<uint8_t> &pixels,
+                                    uint32_t gap = 0) {
+  uint32_t offset = 54 + table.size() + gap;
+  uint32_t colors = (depth <= 8) ? table.size() / 4 : 0;
+  std::vector<uint8_t> bmp(offset, 0);
+  uint32_t fields[][3] = {
+      {2, 4, (uint32_t)(offset + pixels.size())},
+      {10, 4, offset},
+      {14, 4, 40},
+      {18, 4, width},
+      {22, 4, height},
+      {26, 2, 1},
+      {28, 2, depth},
+      {30, 4, compression},
+      {34, 4, (uint32_t)pixels.size()},
+      {46, 4, colors}};
+  bmp[0] = 'B';
+  bmp[1] = 'M';
+  for (const uint32_t *f : fields)
+    for (uint32_t i = 0; i < f[1]; i++)
+      bmp[f[0] + i] = f[2] >> (i * 8);
+  std::copy(table.begin(), table.end(), bmp.begin() + 54);
+  bmp.insert(bmp.end(), pixels.begin(), pixels.end());
+  return bmp;
+}
+
+// A palettized test image: flat areas (for RLE runs) crossed by noise
+// (for literal runs), one palette index per pixel
+typedef struct {
+  int32_t width, height;
+  std::vector<uint8_t> index;   // Row-major, top row first
+  std::vector<uint8_t> palette; // B, G, R, 0 for each color
+} Indexed;
+
+static Indexed makeIndexed(int32_t width, int32_t height, int colors) {
+  Indexed im = {width, height, {}, {}};
+  for (int c = 0; c < colors; c++) {
+    uint8_t bgr0[] = {(uint8_t)(c * 37 + 11), (uint8_t)(255 - c * 53),
+                      (uint8_t)(c * 101 + 7), 0};
+    im.palette.insert(im.palette.end(), bgr0, bgr0 + 4);
+  }
+  for (int32_t row = 0; row < height; row++) {
+    for (int32_t col = 0; col < width; col++) {
+      int i = (row / 3 + col / 9) % colors;
+      if ((col + row) % 13 < 5) // Noise
+        i = (col * 7 + row * 13 + col * row) % colors;
+      im.index.push_back(i);
+    }
+  }
+  return im;
+}
+
+static Reference indexedReference(const Indexed &im) {
+  Reference ref = {im.width, im.height, {}};
+  for (uint8_t i : im.index) {
+    ref.rgb.push_back(im.palette[i * 4 + 2]);
+    ref.rgb.push_back(im.palette[i * 4 + 1]);
+    ref.rgb.push_back(im.palette[i * 4]);
+  }
+  return ref;
+}
+
+// Indexed image as uncompressed 1-, 4- or 8-bit BMP rows, bottom row
+// first (or top row, for a negative-height BMP), each padded to 4 bytes
+static std::vector<uint8_t> packRows(const Indexed &im, int depth,
+                                     bool topDown = false) {
+  uint32_t rowSize = ((depth * im.width + 31) / 32) * 4;
+  std::vector<uint8_t> px(rowSize * im.height, 0);
+  for (int32_t row = 0; row < im.height; row++) {
+    int32_t pos = topDown ? row : im.height - 1 - row;
+    for (int32_t col = 0; col < im.width; col++) {
+      uint32_t bit = col * depth;
+      px[pos * rowSize + bit / 8] |=
+          im.index[row * im.width + col] << (8 - depth - (bit & 7));
+    }
+  }
+  return px;
+}
+
+// Indexed image as RLE8 (depth 8) or RLE4 (depth 4) data, bottom row
+// first: repeats of 3+ pixels as runs, the rest as literals (absolute
+// mode, or single-pixel runs when shorter than 3)
+static std::vector<uint8_t> packRLE(const Indexed &im, int depth) {
+  std::vector<uint8_t> px;
+  for (int32_t row = im.height - 1; row >= 0; row--) {
+    const uint8_t *index = &im.index[row * im.width];
+    int32_t col = 0;
+    while (col < im.width) {
+      int32_t run = 1, lit = 0;
+      while ((col + run < im.width) && (run < 255) &&
+             (index[col + run] == index[col]))
+        run++;
+      if (run >= 3) {
+        px.push_back(run);
+        px.push_back((depth == 8) ? index[col] : index[col] * 0x11);
+        col += run;
+        continue;
+      }
+      // Literal up to the next run of 3 (or the end of the row)
+      while ((col + lit < im.width) && (lit < 255) &&
+             !((col + lit + 2 < im.width) &&
+               (index[col + lit] == index[col + lit + 1]) &&
+               (index[col + lit] == index[col + lit + 2])))
+        lit++;
+      if (lit < 3) {
+        for (int32_t i = 0; i < lit; i++) {
+          px.push_back(1);
+          px.push_back(index[col + i] << (8 - depth));
+        }
+      } else {
+        uint32_t bytes = (lit * depth + 7) / 8, start = px.size() + 2;
+        px.push_back(0);
+        px.push_back(lit);
+        px.resize(start + bytes + (bytes & 1), 0); // Pad to 16 bits
+        for (int32_t i = 0; i < lit; i++)
+          px[start + i * depth / 8] |= index[col + i]
+                                       << (8 - depth - ((i * depth) & 7));
+      }
+      col += lit;
+    }
+    px.push_back(0); // End of line
+    px.push_back(row ? 0 : 1); // End of bitmap after the top row
+  }
+  return px;
+}
+
+// Indexed image's colors as 16-bit BMP rows (565, or 555 if 'is555'),
+// bottom row first (or top row), each padded to 4 bytes. 'ref' is set to
+// 8-bit colors that come back to the same 565 values (555 green widened
+// by repeating its top bit, as the library does).
+static std::vector<uint8_t> pack16(const Indexed &im, bool is555,
+                                   bool topDown, Reference &ref) {
+  uint32_t rowSize = ((16 * im.width + 31) / 32) * 4;
+  std::vector<uint8_t> px(rowSize * im.height, 0);
+  ref = {im.width, im.height, {}};
+  for (int32_t row = 0; row < im.height; row++) {
+    int32_t pos = topDown ? row : im.height - 1 - row;
+    for (int32_t col = 0; col < im.width; col++) {
+      const uint8_t *bgr = &im.palette[im.index[row * im.width + col] * 4];
+      uint8_t r = bgr[2] >> 3, g = bgr[1] >> 2, b = bgr[0] >> 3;
+      uint16_t c = (r << 11) | (g << 5) | b;
+      if (is555) {
+        g = (g & 0x3E) | (g >> 5);
+        c = (r << 10) | ((g >> 1) << 5) | b;
+      }
+      px[pos * rowSize + col * 2] = c;
+      px[pos * rowSize + col * 2 + 1] = c >> 8;
+      ref.rgb.push_back(r << 3);
+      ref.rgb.push_back(g << 2);
+      ref.rgb.push_back(b << 3);
+    }
+  }
+  return px;
+}
+
+// BI_BITFIELDS color masks (R, G, B) as they follow the header
+static std::vector<uint8_t> masks(uint32_t r, uint32_t g, uint32_t b) {
+  std::vector<uint8_t> m;
+  for (uint32_t mask : {r, g, b})
+    for (int i = 0; i < 32; i += 8)
+      m.push_back(mask >> i);
+  return m;
+}
+
+// A generated BMP the library doesn't handle must be refused by draw and
+// load alike
+static void testUnsupported(const std::string &root, const std::string &name,
+                            const std::vector<uint8_t> &bmp) {
+  Adafruit_ImageReader reader(filesys);
+  Adafruit_SPITFT tft(16, 16);
+  Adafruit_Image img;
+  int failed = failures;
+  if (!writeFile(root + "/" + name, bmp)) {
+    check(false, "can't write " + name);
+    return;
+  }
+  check(reader.drawBMP(name.c_str(), tft, 0, 0) == IMAGE_ERR_FORMAT,
+        name + " draw: not rejected");
+  checkHost(name + " draw");
+  check(reader.loadBMP(name.c_str(), img) == IMAGE_ERR_FORMAT,
+        name + " load: not rejected");
+  checkHost(name + " load");
+  remove((root + "/" + name).c_str());
+  printf("%s  %s (unsupported)\n", (failures > failed) ? "FAIL" : "ok  ",
+         name.c_str());
+}
+
+// Write a generated BMP, run the TFT tests on it (and the EPD ones where
+// the EPD reader handles it), then remove it
+static void testFixture(const std::string &root, const std::string &name,
+                        const std::vector<uint8_t> &bmp, const Reference &ref,
+                        bool epdDraw, bool epdLoad) {
+  int failed = failures;
+  if (!writeFile(root + "/" + name, bmp)) {
+    check(false, "can't write " + name);
+    return;
+  }
+  Adafruit_ImageReader reader(filesys);
+  testTFT(reader, formats[0], name, ref);
+  testSetBuffer(formats[0], name, ref, SMALL_BUFFER, 1);
+  testSetBuffer(formats[0], name, ref, LARGE_BUFFER, 0);
+  testRunFill(formats[0], name, ref);
+  testReverseScan(name, ref);
+  if (epdDraw)
+    testEPD(name, bmp, ref);
+  if (epdLoad)
+    testEPDLoad(name, ref);
+  remove((root + "/" + name).c_str());
+  printf("%s  %s\n", (failures > failed) ? "FAIL" : "ok  ", name.c_str());
+}
+
+// Indexed image's colors as 32-bit BGRA BMP rows, bottom row first, with
+// alpha values from a pattern that has runs of opaque pixels, fully
+// transparent ones and values either side of the mask threshold used
+// below. 'rgb' and 'alpha' are set to what was stored.
+static std::vector<uint8_t> pack32(const Indexed &im, Reference &rgb,
+                                   std::vector<uint8_t> &alpha) {
+  static const uint8_t pattern[] = {255, 255, 255, 0,   100, 99,
+                                    1,   254, 128, 127, 60,  200};
+  std::vector<uint8_t> px((size_t)im.width * im.height * 4);
+  rgb = indexedReference(im);
+  alpha.clear();
+  for (int32_t row = 0; row < im.height; row++) {
+    uint8_t *p = &px[(im.height - 1 - row) * im.width * 4];
+    for (int32_t col = 0; col < im.width; col++, p += 4) {
+      memcpy(p, &im.palette[im.index[row * im.width + col] * 4], 3);
+      p[3] = (col < 9) ? 255 : pattern[(col + row * 5) % sizeof pattern];
+      alpha.push_back(p[3]);
+    }
+  }
+  return px;
+}
+
+// Draw & load a 32-bit BMP in each alpha mode (see setAlpha()): ignored,
+// thresholded (drawn in the background color, or masked out when
+// loaded), or blended with the background color
+static void testAlpha(const std::string &root, const std::string &name,
+                      const std::vector<uint8_t> &bmp, const Reference &rgb,
+                      const std::vector<uint8_t> &alpha) {
+  static const uint8_t threshold = 100;
+  static const uint16_t background = 0x867D;
+  static const uint8_t bg[3] = { // 8-bit, low bits repeating high bits
+      (uint8_t)(((background >> 8) & 0xF8) | (background >> 13)),
+      (uint8_t)(((background >> 3) & 0xFC) | ((background >> 9) & 3)),
+      (uint8_t)(((background << 3) & 0xF8) | ((background >> 2) & 7))};
+  static const uint8_t hole[3] = {0xF8, 0x00, 0xF8}; // BACKGROUND
+  int failed = failures;
+  if (!writeFile(root + "/" + name, bmp)) {
+    check(false, "can't write " + name);
+    return;
+  }
+  for (ImageAlphaMode mode :
+       {IMAGE_ALPHA_IGNORE, IMAGE_ALPHA_MASK, IMAGE_ALPHA_BLEND}) {
+    Reference drawn = rgb, loaded = rgb;
+    for (size_t i = 0; i < alpha.size(); i++) {
+      uint8_t a = alpha[i];
+      for (int c = 0; c < 3; c++) {
+        uint8_t &d = drawn.rgb[i * 3 + c], &l = loaded.rgb[i * 3 + c];
+        if ((mode == IMAGE_ALPHA_MASK) && (a < threshold)) {
+          d = bg[c];
+          l = hole[c];
+        } else if (mode == IMAGE_ALPHA_BLEND) { // Rounded
+          d = l = (2 * (d * a + bg[c] * (255 - a)) + 255) / 510;
+        }
+      }
+    }
+    Adafruit_ImageReader reader(filesys);
+    reader.setAlpha(mode, background, threshold);
+    testTFT(reader, formats[0], name, drawn, &loaded);
+  }
+  remove((root + "/" + name).c_str());
+  printf("%s  %s (3 alpha modes)\n", (failures > failed) ? "FAIL" : "ok  ",
+         name.c_str());
+}
+
+// Generated BMPs in the formats images/ doesn't have. Names start with
+// '.' so findBMPs() skips any left behind.
+static void testFixtures(const std::string &root) {
+  Indexed im16 = makeIndexed(37, 23, 16), im256 = makeIndexed(37, 23, 256);
+  testFixture(root, ".4bit.bmp",
+              bmpFile(37, 23, 4, 0, im16.palette, packRows(im16, 4)),
+              indexedReference(im16), true, true);
+  testFixture(root, ".8bit.bmp",
+              bmpFile(37, 23, 8, 0, im256.palette, packRows(im256, 8)),
+              indexedReference(im256), false, true);
+  // Palette shorter than 256 (header gives the count), and top-down rows
+  Indexed im100 = makeIndexed(37, 23, 100);
+  testFixture(root, ".8bit-100.bmp",
+              bmpFile(37, 23, 8, 0, im100.palette, packRows(im100, 8)),
+              indexedReference(im100), false, true);
+  testFixture(root, ".8bit-topdown.bmp",
+              bmpFile(37, (uint32_t)-23, 8, 0, im256.palette,
+                      packRows(im256, 8, true)),
+              indexedReference(im256), false, true);
+  // 16-bit: 555 (the default), and 565 or 555 given as BI_BITFIELDS
+  // masks, bottom-up and top-down; other masks aren't handled
+  Reference ref16;
+  std::vector<uint8_t> px16;
+  px16 = pack16(im256, true, false, ref16);
+  testFixture(root, ".16bit-555.bmp", bmpFile(37, 23, 16, 0, {}, px16),
+              ref16, false, true);
+  testFixture(root, ".16bit-555-masks.bmp",
+              bmpFile(37, 23, 16, 3, masks(0x7C00, 0x03E0, 0x001F), px16),
+              ref16, false, true);
+  px16 = pack16(im256, false, false, ref16);
+  testFixture(root, ".16bit-565.bmp",
+              bmpFile(37, 23, 16, 3, masks(0xF800, 0x07E0, 0x001F), px16),
+              ref16, false, true);
+  testUnsupported(root, ".16bit-444.bmp",
+                  bmpFile(37, 23, 16, 3, masks(0x0F00, 0x00F0, 0x000F), px16));
+  px16 = pack16(im256, false, true, ref16);
+  testFixture(root, ".16bit-565-topdown.bmp",
+              bmpFile(37, (uint32_t)-23, 16, 3,
+                      masks(0xF800, 0x07E0, 0x001F), px16),
+              ref16, false, true);
+  // 32-bit BGRA, also as BI_BITFIELDS masks
+  Reference rgb32;
+  std::vector<uint8_t> alpha32, px32 = pack32(im256, rgb32, alpha32);
+  testAlpha(root, ".32bit.bmp", bmpFile(37, 23, 32, 0, {}, px32), rgb32,
+            alpha32);
+  testAlpha(root, ".32bit-masks.bmp",
+            bmpFile(37, 23, 32, 3, masks(0xFF0000, 0xFF00, 0xFF), px32),
+            rgb32, alpha32);
+  // Pixel data not right after the palette must still be reached
+  // before the TFT transaction starts
+  for (uint32_t gap : {0, 16}) {
+    std::string suffix = gap ? "-gap.bmp" : ".bmp";
+    testFixture(root, ".rle8" + suffix,
+                bmpFile(37, 23, 8, 1, im256.palette, packRLE(im256, 8), gap),
+                indexedReference(im256), false, false);
+    testFixture(root, ".rle4" + suffix,
+                bmpFile(37, 23, 4, 2, im16.palette, packRLE(im16, 4), gap),
+                indexedReference(im16), false, false);
+  }
+}
+
+// BMP headers with sizes that don't fit GFX canvases (or are empty).
+// Each is written to a scratch file and must be rejected by every path,
+// not decoded into a canvas or window truncated to 16 bits.
+typedef struct {
+  uint16_t depth;
+  uint32_t compression, width, height;
+} CorruptHeader;
+
+static const CorruptHeader corrupt[] = {
+    {8, 0, 1, 0x40000001},  {8, 0, 0x40000001, 1},  {8, 0, 0x10001, 2},
+    {8, 0, 0, 4},           {8, 0, 4, 0x80000000},  {16, 0, 1, 0x40000001},
+    {16, 0, 0x40000001, 1}, {16, 3, 1, 0x40000001}, {16, 3, 0x10001, 2},
+    {32, 0, 0x40000001, 1}, {24, 0, 0xFFFFFFFF, 1}, {4, 2, 1, 0x40000001},
+    {4, 2, 0x40000001, 1},  {4, 2, 0x10000, 1},     {8, 1, 1, 0x40000001},
+    {8, 1, 0x8001, 0x8001},
+};
+
+static void testCorrupt(const std::string &root) {
+  const char *name = ".corrupt.bmp"; // Hidden, findBMPs() skips it
+  for (const CorruptHeader &h : corrupt) {
+    std::vector<uint8_t> bmp(54 + 256 * 4 + 64, 0);
+    uint32_t fields[][3] = {{10, 4, 54 + 256 * 4}, {14, 4, 40},
+                            {18, 4, h.width},      {22, 4, h.height},
+                            {26, 2, 1},            {28, 2, h.depth},
+                            {30, 4, h.compression}};
+    bmp[0] = 'B';
+    bmp[1] = 'M';
+    for (const uint32_t *f : fields)
+      for (uint32_t i = 0; i < f[1]; i++)
+        bmp[f[0] + i] = f[2] >> (i * 8);
+    if (h.compression == 3) { // BI_BITFIELDS RGB565 masks follow header
+      bmp[55] = 0xF8;
+      bmp[58] = 0xE0;
+      bmp[59] = 0x07;
+      bmp[62] = 0x1F;
+    }
+    FILE *out = fopen((root + "/" + name).c_str(), "wb");
+    if (!out) {
+      check(false, "can't write corrupt BMP");
+      return;
+    }
+    fwrite(bmp.data(), 1, bmp.size(), out);
+    fclose(out);
+
+    char what[64];
+    snprintf(what, sizeof what, "corrupt %u-bit %ux%u compression %u",
+             h.depth, h.width, h.height, h.compression);
+    Adafruit_ImageReader_EPD reader(filesys);
+    Adafruit_SPITFT tft(16, 16);
+    Adafruit_EPD epd(16, 16);
+    Adafruit_Image img;
+    std::string s = what;
+    check(reader.Adafruit_ImageReader::drawBMP(name, tft, 0, 0) ==
+              IMAGE_ERR_FORMAT,
+          s + " draw: not rejected");
+    checkHost(s + " draw");
+    check(reader.Adafruit_ImageReader::loadBMP(name, img) ==
+              IMAGE_ERR_FORMAT,
+          s + " load: not rejected");
+    checkHost(s + " load");
+    check(reader.drawBMP((char *)name, epd, 0, 0) == IMAGE_ERR_FORMAT,
+          s + " EPD file: not rejected");
+    checkHost(s + " EPD file");
+    check(reader.drawBMP(bmp.data(), bmp.size(), epd, 0, 0) ==
+              IMAGE_ERR_FORMAT,
+          s + " EPD memory: not rejected");
+    checkHost(s + " EPD memory");
+  }
+  remove((root + "/" + name).c_str());
+}
+
+// List .bmp files in folder and subfolders, relative to folder
+static void findBMPs(const std::string &root, const std::string &sub,
+                     std::vector<std::string> &names) {
+  DIR *dir = opendir((root + "/" + sub).c_str());
+  if (!dir)
+    return;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    std::string name = entry->d_name;
+    if (name[0] == '.')
+      continue;
+    std::string path = sub.empty() ? name : sub + "/" + name;
+    if ((name.size() > 4) && (name.substr(name.size() - 4) == ".bmp"))
+      names.push_back(path);
+    else
+      findBMPs(root, path, names); // Fails harmlessly if not a folder
+  }
+  closedir(dir);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s folder\n", argv[0]);
+    return 2;
+  }
+  std::string root = argv[1];
+  std::vector<std::string> names;
+  filesys.begin(argv[1]);
+  findBMPs(root, "", names);
+  std::sort(names.begin(), names.end());
+
+  for (const std::string &name : names) {
+    std::vector<uint8_t> bmp;
+    Reference ref;
+    int failed = failures;
+    if (!readFile(root + "/" + name, bmp) || !readBMP(bmp, ref)) {
+      printf("skip  %s (not an uncompressed BMP)\n", name.c_str());
+      continue;
+    }
+    std::string base = name.substr(0, name.size() - 4);
+    std::string png = root + "/" + base + ".png";
+    check(writePNG(ref, png), "can't write " + png);
+    int tested = 0;
+    for (const Format &format : formats) {
+      std::string file = base + format.extension;
+      if (filesys.exists(file.c_str())) {
+        Adafruit_ImageReader reader(filesys);
+        testTFT(reader, format, file, ref);
+        testSetBuffer(format, file, ref, SMALL_BUFFER, 1);
+        testSetBuffer(format, file, ref, LARGE_BUFFER, 0);
+        testRunFill(format, file, ref);
+        tested++;
+      }
+    }
+    remove(png.c_str());
+    testBulkReads(name, ref, (int32_t)le(bmp, 22, 4) > 0);
+    testReverseScan(name, ref);
+    testEPD(name, bmp, ref);
+    testEPDLoad(name, ref);
+    printf("%s  %s (%d formats)\n", (failures > failed) ? "FAIL" : "ok  ",
+           name.c_str(), tested);
+  }
+
+  testFixtures(root);
+  int failed = failures;
+  testCorrupt(root);
+  printf("%s  corrupt headers\n", (failures > failed) ? "FAIL" : "ok  ");
+
+  printf("%d images, %d checks, %d failed\n", (int)names.size(), checks,
+         failures);
+  return (names.empty() || failures) ? 1 : 0;
+}
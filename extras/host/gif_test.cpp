@@ -0,0 +1,384 @@
+/*!
+ * @file gif_test.cpp
+ *
+ * Host test of the GIF decoder. GIFs are made here: an animation with a
+ * looping extension, a frame with its own palette, interlacing, frames
+ * partly off the logical screen, transparency and each disposal method;
+ * a still with a transparent, interlaced frame smaller than the screen;
+ * and a 256-color one big enough to fill the LZW string table. Each is
+ * drawn with drawGIF() and loaded with loadGIF() and drawn from there, in
+ * every alpha mode, whole and clipped; the animation is also played with
+ * openGIF() and drawGIFFrame() through two loops. Every frame's pixels
+ * must match a model of what the library documents. Every call must close
+ * its files (animations at closeGIF()), end its display transaction and
+ * stay off the SD card while the transaction is open.
+ * See CMakeLists.txt.
+ *
+ * Usage: gif_test folder (scratch space for the GIF files)
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "host_test.h"
+#include <map>
+
+#define ALPHA_COLOR 0x07E0 ///< setAlpha() background, unlike BACKGROUND
+
+// One frame (image descriptor) of a test GIF
+typedef struct {
+  uint16_t left, top, width, height; // Position & size on logical screen
+  uint8_t bits;        // Local palette size, 2^bits, or 0 for global
+  bool interlace;      // Rows in four passes
+  int16_t transparent; // Transparent color index, or -1 if none
+  uint8_t dispose;     // Disposal method (0-3)
+  uint16_t delay;      // 1/100 sec
+} GIFFrame;
+
+// One test GIF
+typedef struct {
+  const char *name;
+  uint16_t width, height; // Logical screen
+  uint8_t bits;           // Global palette size, 2^bits
+  uint8_t background;     // Background color index
+  bool loop;              // Has a NETSCAPE2.0 looping extension
+  std::vector<GIFFrame> frames;
+} GIFCase;
+
+static const GIFCase cases[] = {
+    {"anim",
+     29,
+     19,
+     3,
+     5,
+     true,
+     {{0, 0, 29, 19, 0, false, -1, 1, 10},
+      {5, 3, 13, 9, 4, true, 2, 2, 20},
+      {20, 12, 15, 11, 0, false, 0, 3, 0}}},
+    {"still", 37, 23, 1, 1, false, {{4, 2, 30, 19, 0, true, 0, 0, 0}}},
+    {"big", 100, 80, 8, 0, false, {{0, 0, 100, 80, 0, false, -1, 0, 0}}}};
+
+static int tableResets; // Times encoder's string table filled up
+
+// Color of palette entry 'i' of palette 'id' (0 = global, else frame
+// number + 1)
+static void paletteColor(int id, int i, uint8_t rgb[3]) {
+  rgb[0] = i * 73 + id * 41 + 17;
+  rgb[1] = i * 151 + id * 29 + 90;
+  rgb[2] = i * 37 + id * 97 + 200;
+}
+
+// Color index of frame 'f' at x, y (frame coordinates): runs crossed by
+// noise, or all noise for 256 colors (so the string table fills)
+static uint8_t pixelIndex(int f, int32_t x, int32_t y, int colors) {
+  if ((colors == 256) || ((x * 7 + y * 3) % 11 < 4))
+    return (x * x * 31 + y * y * 17 + x * y * 7 + x + f * 5) % colors;
+  return (x / 5 + y / 3 + f) % colors;
+}
+
+// LZW-compress indices as GIF image data: minimum code size, then data
+// sub-blocks of assorted sizes, then the block terminator
+static void putLZW(std::vector<uint8_t> &d, const std::vector<uint8_t> &px,
+                   uint8_t minSize) {
+  std::map<std::pair<int, uint8_t>, int> table;
+  std::vector<uint8_t> data;
+  uint32_t acc = 0;
+  int nBits = 0, clear = 1 << minSize, next = clear + 2;
+  int size = minSize + 1;
+  auto put = [&](int code) {
+    acc |= (uint32_t)code << nBits;
+    for (nBits += size; nBits >= 8; nBits -= 8, acc >>= 8)
+      data.push_back(acc);
+  };
+  put(clear);
+  int prefix = px[0];
+  for (size_t i = 1; i < px.size(); i++) {
+    auto found = table.find(std::make_pair(prefix, px[i]));
+    if (found != table.end()) {
+      prefix = found->second;
+      continue;
+    }
+    put(prefix);
+    // The decoder adds each entry a code later than here, so it widens
+    // codes once the entry being added now fills the current size
+    if ((next == (1 << size)) && (size < 12))
+      size++;
+    if (next < 4096) {
+      table[std::make_pair(prefix, px[i])] = next++;
+    } else { // Full: start over
+      put(clear);
+      table.clear();
+      next = clear + 2;
+      size = minSize + 1;
+      tableResets++;
+    }
+    prefix = px[i];
+  }
+  put(prefix);
+  put(clear + 1); // End of information
+  if (nBits)
+    data.push_back(acc);
+
+  d.push_back(minSize);
+  for (size_t i = 0, n; i < data.size(); i += n) {
+    n = std::min(data.size() - i, (size_t)((i & 1) ? 255 : 100));
+    d.push_back(n);
+    d.insert(d.end(), &data[i], &data[i] + n);
+  }
+  d.push_back(0);
+}
+
+static void putLE16(std::vector<uint8_t> &d, uint16_t v) {
+  d.push_back(v);
+  d.push_back(v >> 8);
+}
+
+static std::vector<uint8_t> encode(const GIFCase &gc) {
+  std::vector<uint8_t> d = {'G', 'I', 'F', '8', '9', 'a'};
+  uint8_t rgb[3];
+  putLE16(d, gc.width);
+  putLE16(d, gc.height);
+  d.push_back(0x80 | ((gc.bits - 1) << 4) | (gc.bits - 1));
+  d.push_back(gc.background);
+  d.push_back(0); // Aspect ratio
+  for (int i = 0; i < (1 << gc.bits); i++) {
+    paletteColor(0, i, rgb);
+    d.insert(d.end(), rgb, rgb + 3);
+  }
+  if (gc.loop) {
+    const char netscape[] = "\x21\xFF\x0BNETSCAPE2.0\x03\x01\x00\x00\x00";
+    d.insert(d.end(), netscape, netscape + 19);
+  }
+  const char comment[] = "\x21\xFE\x05hello\x03GIF\x00"; // Skipped
+  d.insert(d.end(), comment, comment + 13);
+
+  for (size_t f = 0; f < gc.frames.size(); f++) {
+    const GIFFrame &fr = gc.frames[f];
+    int bits = fr.bits ? fr.bits : gc.bits;
+    if ((fr.transparent >= 0) || fr.dispose || fr.delay) {
+      d.insert(d.end(), {0x21, 0xF9, 4});
+      d.push_back((fr.dispose << 2) | (fr.transparent >= 0));
+      putLE16(d, fr.delay);
+      d.push_back((fr.transparent >= 0) ? fr.transparent : 0);
+      d.push_back(0);
+    }
+    d.push_back(0x2C);
+    putLE16(d, fr.left);
+    putLE16(d, fr.top);
+    putLE16(d, fr.width);
+    putLE16(d, fr.height);
+    d.push_back((fr.bits ? 0x80 | (fr.bits - 1) : 0) |
+                (fr.interlace ? 0x40 : 0));
+    for (int i = 0; fr.bits && (i < (1 << fr.bits)); i++) {
+      paletteColor(f + 1, i, rgb);
+      d.insert(d.end(), rgb, rgb + 3);
+    }
+    std::vector<uint8_t> px;
+    static const uint8_t passStart[] = {0, 4, 2, 1}, passStep[] = {8, 8, 4, 2};
+    for (int pass = 0; pass < (fr.interlace ? 4 : 1); pass++) {
+      int start = fr.interlace ? passStart[pass] : 0;
+      int step = fr.interlace ? passStep[pass] : 1;
+      for (int32_t y = start; y < fr.height; y += step)
+        for (int32_t x = 0; x < fr.width; x++)
+          px.push_back(pixelIndex(f, x, y, 1 << bits));
+    }
+    putLZW(d, px, std::max(bits, 2));
+  }
+  d.push_back(0x3B); // Trailer
+  return d;
+}
+
+// 565 color of frame 'f' index 'i', as drawn in alpha mode 'mode'
+static uint16_t frameColor(const GIFCase &gc, int f, int i, uint8_t mode) {
+  const GIFFrame &fr = gc.frames[f];
+  uint8_t rgb[3];
+  if ((i == fr.transparent) && (mode != IMAGE_ALPHA_IGNORE))
+    return ALPHA_COLOR;
+  if (i >= (1 << (fr.bits ? fr.bits : gc.bits)))
+    return 0x0000; // Unlisted colors are black
+  paletteColor(fr.bits ? f + 1 : 0, i, rgb);
+  return ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+}
+
+// Draw frame 'f' into a model of the TFT, with the logical screen at x,y:
+// transparent pixels skipped (as drawGIFFrame() does) or in alpha 'mode'
+// (as drawGIF() does)
+static void modelFrame(std::vector<uint16_t> &screen, int32_t tw, int32_t th,
+                       const GIFCase &gc, int f, int16_t x, int16_t y,
+                       bool skip, uint8_t mode) {
+  const GIFFrame &fr = gc.frames[f];
+  int colors = 1 << (fr.bits ? fr.bits : gc.bits);
+  for (int32_t fy = 0; fy < fr.height; fy++) {
+    for (int32_t fx = 0; fx < fr.width; fx++) {
+      int32_t lx = fr.left + fx, ly = fr.top + fy; // Logical screen
+      int32_t sx = x + lx, sy = y + ly;            // TFT
+      int i = pixelIndex(f, fx, fy, colors);
+      if ((lx < gc.width) && (ly < gc.height) && (sx >= 0) && (sy >= 0) &&
+          (sx < tw) && (sy < th) && !(skip && (i == fr.transparent)))
+        screen[sy * tw + sx] = frameColor(gc, f, i, mode);
+    }
+  }
+}
+
+// Compare TFT against model
+static void checkScreen(const Adafruit_SPITFT &tft,
+                        const std::vector<uint16_t> &expect,
+                        const std::string &what) {
+  for (size_t i = 0; i < expect.size(); i++) {
+    if (tft.framebuffer[i] != expect[i]) {
+      char buf[80];
+      snprintf(buf, sizeof buf, ": pixel %d,%d is %04X, expected %04X",
+               (int)(i % tft.width()), (int)(i / tft.width()),
+               tft.framebuffer[i], expect[i]);
+      check(false, what + buf);
+      return;
+    }
+  }
+  check(true, what);
+}
+
+// First frame as a still image: drawGIF(), and loadGIF() then draw(), in
+// every alpha mode
+static void testStill(const std::string &name, const GIFCase &gc) {
+  static const uint8_t modes[] = {IMAGE_ALPHA_IGNORE, IMAGE_ALPHA_MASK,
+                                  IMAGE_ALPHA_BLEND};
+  const GIFFrame &fr = gc.frames[0];
+  bool partial = (fr.transparent >= 0) || fr.left || fr.top ||
+                 (fr.width < gc.width) || (fr.height < gc.height);
+  int16_t pos[2][2] = {{0, 0}, {(int16_t)(-gc.width / 3),
+                                (int16_t)(gc.height / 4)}};
+  int32_t w = 0, h = 0;
+  Adafruit_ImageReader reader(filesys);
+  ImageReturnCode stat = reader.gifDimensions(name.c_str(), &w, &h);
+  checkHost(name + " dimensions");
+  check((stat == IMAGE_SUCCESS) && (w == gc.width) && (h == gc.height),
+        name + " dimensions: wrong");
+
+  for (uint8_t mode : modes) {
+    reader.setAlpha((ImageAlphaMode)mode, ALPHA_COLOR);
+    for (const int16_t *p : pos) {
+      int16_t x = p[0], y = p[1];
+      char at[40];
+      snprintf(at, sizeof at, " alpha %d at %d,%d", mode, x, y);
+      Adafruit_SPITFT tft(gc.width, gc.height);
+      std::vector<uint16_t> expect(tft.framebuffer.size(), BACKGROUND);
+      tft.framebuffer = expect;
+      std::string what = name + " draw" + at;
+      stat = reader.drawGIF(name.c_str(), tft, x, y);
+      checkHost(what);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      modelFrame(expect, gc.width, gc.height, gc, 0, x, y, false, mode);
+      checkScreen(tft, expect, what);
+
+      // Loaded: the whole logical screen, background color outside the
+      // frame; with a mask, only the frame's opaque pixels
+      Adafruit_Image img;
+      std::fill(expect.begin(), expect.end(), BACKGROUND);
+      tft.framebuffer = expect;
+      what = name + " load" + at;
+      stat = reader.loadGIF(name.c_str(), img);
+      checkHost(what);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      bool masked = partial && (mode == IMAGE_ALPHA_MASK);
+      check(img.getFormat() == (masked ? IMAGE_16 : IMAGE_8),
+            what + ": wrong format");
+      if (stat != IMAGE_SUCCESS)
+        continue;
+      img.draw(tft, x, y);
+      if (!masked) {
+        for (int32_t ly = 0; ly < gc.height; ly++)
+          for (int32_t lx = 0; lx < gc.width; lx++)
+            if ((x + lx >= 0) && (y + ly >= 0) && (x + lx < gc.width) &&
+                (y + ly < gc.height))
+              expect[(y + ly) * gc.width + x + lx] =
+                  frameColor(gc, 0, gc.background, mode);
+      }
+      modelFrame(expect, gc.width, gc.height, gc, 0, x, y, masked, mode);
+      checkScreen(tft, expect, what);
+    }
+  }
+}
+
+// Play the animation through twice and a bit, checking every frame
+static void testAnimation(const std::string &name, const GIFCase &gc) {
+  int16_t pos[2][2] = {{0, 0}, {-7, 4}};
+  size_t frames = gc.frames.size();
+  for (const int16_t *p : pos) {
+    int16_t x = p[0], y = p[1];
+    Adafruit_ImageReader reader(filesys);
+    Adafruit_SPITFT tft(gc.width, gc.height);
+    std::vector<uint16_t> expect(tft.framebuffer.size(), BACKGROUND);
+    tft.framebuffer = expect;
+    GIFAnimation gif;
+    reader.setAlpha(IMAGE_ALPHA_IGNORE, ALPHA_COLOR);
+    ImageReturnCode stat = reader.openGIF(name.c_str(), gif);
+    check((stat == IMAGE_SUCCESS) && (gif.width == gc.width) &&
+              (gif.height == gc.height),
+          name + " open: failed");
+    if (stat != IMAGE_SUCCESS) {
+      checkHost(name + " open");
+      continue;
+    }
+    for (size_t n = 0; n < frames * 2 + 1; n++) {
+      size_t f = n % frames, prev = (n + frames - 1) % frames;
+      char at[40];
+      snprintf(at, sizeof at, " frame %d at %d,%d", (int)n, x, y);
+      std::string what = name + at;
+      // Restore-to-background leaves the previous frame's area (within
+      // the logical screen) in the setAlpha() color
+      const GIFFrame &last = gc.frames[prev];
+      if (n && (last.dispose == 2)) {
+        for (int32_t ly = last.top; ly < last.top + last.height; ly++) {
+          for (int32_t lx = last.left; lx < last.left + last.width; lx++) {
+            int32_t sx = x + lx, sy = y + ly;
+            if ((lx < gc.width) && (ly < gc.height) && (sx >= 0) &&
+                (sy >= 0) && (sx < gc.width) && (sy < gc.height))
+              expect[sy * gc.width + sx] = ALPHA_COLOR;
+          }
+        }
+      }
+      stat = reader.drawGIFFrame(gif, tft, x, y);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      check(!hostState.transactions, what + ": transaction left open");
+      check(!hostState.busConflicts, what + ": SD access inside transaction");
+      check((gif.frame == f + 1) && (gif.loops == n / frames) &&
+                (gif.delay == gc.frames[f].delay * 10UL),
+            what + ": wrong frame, loop count or delay");
+      modelFrame(expect, gc.width, gc.height, gc, f, x, y, true,
+                 IMAGE_ALPHA_IGNORE);
+      checkScreen(tft, expect, what);
+    }
+    reader.closeGIF(gif);
+    checkHost(name + " close");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s folder\n", argv[0]);
+    return 2;
+  }
+  std::string root = argv[1];
+  filesys.begin(argv[1]);
+
+  for (const GIFCase &gc : cases) {
+    // Name starts with '.', so decode_test skips any left behind
+    std::string name = std::string(".gif-") + gc.name + ".gif";
+    int failed = failures;
+    tableResets = 0;
+    if (!writeFile(root + "/" + name, encode(gc))) {
+      check(false, "can't write " + name);
+      continue;
+    }
+    if (gc.bits == 8)
+      check(tableResets > 0, name + ": string table never filled");
+    testStill(name, gc);
+    if (gc.frames.size() > 1)
+      testAnimation(name, gc);
+    remove((root + "/" + name).c_str());
+    printf("%s  %s\n", (failures > failed) ? "FAIL" : "ok  ", name.c_str());
+  }
+
+  printf("%d GIFs, %d checks, %d failed\n",
+         (int)(sizeof cases / sizeof cases[0]), checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+/*!
+ * @file host_test.h
+ *
+ * Helpers shared by the host tests (see CMakeLists.txt): check counting,
+ * the checks every library call must pass, and comparing a TFT against a
+ * reference image. Not part of the Arduino build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include "Adafruit_ImageReader.h"
+#include <string>
+#include <vector>
+
+#define BACKGROUND 0xF81F ///< TFT color where nothing was drawn
+
+static FatVolume filesys;
+static int checks = 0, failures = 0;
+
+// A decoded reference image, 8 bits each R, G, B
+typedef struct {
+  int32_t width, height;
+  std::vector<uint8_t> rgb;
+} Reference;
+
+static void check(bool ok, const std::string &what) {
+  checks++;
+  if (!ok) {
+    printf("FAIL: %s\n", what.c_str());
+    failures++;
+  }
+}
+
+// After each library call: files closed, display transaction ended, and
+// no SD access while it was open
+static void checkHost(const std::string &what) {
+  check(!hostState.openFiles, what + ": file left open");
+  check(!hostState.transactions, what + ": transaction left open");
+  check(!hostState.busConflicts, what + ": SD access inside transaction");
+  memset(&hostState, 0, sizeof hostState);
+}
+
+// Compare TFT against reference drawn at x,y
+static void checkTFT(const Adafruit_SPITFT &tft, const Reference &ref,
+                     int16_t x, int16_t y, const std::string &what) {
+  for (int32_t sy = 0; sy < tft.height(); sy++) {
+    for (int32_t sx = 0; sx < tft.width(); sx++) {
+      int32_t ix = sx - x, iy = sy - y;
+      uint16_t expect = BACKGROUND;
+      if ((ix >= 0) && (iy >= 0) && (ix < ref.width) && (iy < ref.height)) {
+        const uint8_t *p = &ref.rgb[(iy * ref.width + ix) * 3];
+        expect = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+      }
+      uint16_t got = tft.framebuffer[sy * tft.width() + sx];
+      if (got != expect) {
+        char buf[80];
+        snprintf(buf, sizeof buf, ": pixel %d,%d is %04X, expected %04X",
+                 sx, sy, got, expect);
+        check(false, what + buf);
+        return;
+      }
+    }
+  }
+  check(true, what);
+}
+
+// Write data to a file, false on error
+static bool writeFile(const std::string &path,
+                      const std::vector<uint8_t> &data) {
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+  return !fclose(f) && ok;
+}
+
+#endif // __HOST_TEST_H__
@@ -0,0 +1,441 @@
+/*!
+ * @file jpeg_test.cpp
+ *
+ * Host test of the JPEG decoder. Small baseline JPEGs are made here from a
+ * synthetic image (flat area, fine detail, smooth color), grayscale and
+ * YCbCr with 4:4:4, 4:2:2 and 4:2:0 sampling, with and without restart
+ * markers. Each is drawn to a TFT and loaded to RAM and drawn from there,
+ * at every scale, whole and clipped on all four edges; pixels must be
+ * within a tolerance of the image (box-averaged when scaled), as lossy
+ * coding and integer transforms don't give exact results. A progressive
+ * JPEG must be rejected. Every call must close its files, end its display
+ * transaction and stay off the SD card while the transaction is open.
+ * See CMakeLists.txt.
+ *
+ * Usage: jpeg_test folder (scratch space for the JPEG files)
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "host_test.h"
+#include <cmath>
+
+// One test JPEG
+typedef struct {
+  const char *name;
+  int32_t width, height;
+  bool gray;        // Grayscale (else YCbCr)
+  uint8_t h, v;     // Luma sampling factors (chroma is 1x1)
+  uint16_t restart; // Restart interval in MCUs, or 0
+  uint8_t sof;      // Frame marker: 0xC0 baseline, 0xC2 progressive
+  int tolerance;    // Max. error of any R, G, B value, full size
+} JPEGCase;
+
+static const JPEGCase cases[] = {
+    {"gray", 45, 29, true, 1, 1, 0, 0xC0, 3},
+    {"444", 83, 61, false, 1, 1, 0, 0xC0, 4},
+    {"422", 83, 61, false, 2, 1, 0, 0xC0, 6},
+    {"420", 83, 61, false, 2, 2, 0, 0xC0, 6},
+    {"420-restart", 83, 61, false, 2, 2, 5, 0xC0, 6},
+    {"444-restart", 83, 61, false, 1, 1, 7, 0xC0, 4},
+    {"progressive", 45, 29, false, 1, 1, 0, 0xC2, 0}};
+
+// Extra error allowed per scale step: reduced transforms drop the high
+// frequencies of the fine detail, and subsampled chroma is averaged over
+// a larger area
+#define SCALE_TOLERANCE 3
+
+// Synthetic image, Y, Cb or Cr (c = 0-2) at x, y: a flat area on the
+// left, one MCU wide (blocks with only a DC coefficient), fine detail in
+// luma elsewhere, and chroma that changes smoothly (so subsampling loses
+// little)
+static double source(int32_t x, int32_t y, int c) {
+  if (x < 16)
+    return (c == 0) ? 100 : (c == 1) ? 140 : 118;
+  if (c == 1)
+    return 128 + 20 * sin(x / 13.0 + y / 17.0);
+  if (c == 2)
+    return 128 + 20 * cos(x / 11.0 - y / 19.0);
+  return 125 + 35 * sin(x * 0.7) * cos(y * 0.45) +
+         ((((x / 6) + (y / 5)) & 1) ? 10 : -10);
+}
+
+// The image as 8-bit RGB (JFIF YCbCr conversion)
+static Reference reference(const JPEGCase &jc) {
+  Reference ref = {jc.width, jc.height, {}};
+  for (int32_t y = 0; y < jc.height; y++) {
+    for (int32_t x = 0; x < jc.width; x++) {
+      double l = source(x, y, 0), cb = 0, cr = 0;
+      if (!jc.gray) {
+        cb = source(x, y, 1) - 128;
+        cr = source(x, y, 2) - 128;
+      }
+      double rgb[] = {l + 1.402 * cr, l - 0.344136 * cb - 0.714136 * cr,
+                      l + 1.772 * cb};
+      for (double v : rgb)
+        ref.rgb.push_back((uint8_t)lround(std::min(std::max(v, 0.0), 255.0)));
+    }
+  }
+  return ref;
+}
+
+// Reduce reference by 1 << scale, averaging each block of pixels (edge
+// pixels repeat past the right and bottom, as the encoder pads MCUs)
+static Reference reduce(const Reference &ref, uint8_t scale) {
+  int32_t k = 1 << scale;
+  Reference out = {(ref.width + k - 1) >> scale, (ref.height + k - 1) >> scale,
+                   {}};
+  for (int32_t y = 0; y < out.height; y++) {
+    for (int32_t x = 0; x < out.width; x++) {
+      for (int c = 0; c < 3; c++) {
+        int32_t sum = 0;
+        for (int32_t dy = 0; dy < k; dy++) {
+          for (int32_t dx = 0; dx < k; dx++) {
+            int32_t sx = std::min(x * k + dx, ref.width - 1);
+            int32_t sy = std::min(y * k + dy, ref.height - 1);
+            sum += ref.rgb[(sy * ref.width + sx) * 3 + c];
+          }
+        }
+        out.rgb.push_back((sum + k * k / 2) / (k * k));
+      }
+    }
+  }
+  return out;
+}
+
+// Huffman table for the encoder: code & length per symbol, and the DHT
+// form (count per length, symbols in code order)
+typedef struct {
+  uint8_t count[16];
+  std::vector<uint8_t> symbols;
+  uint16_t code[256];
+  uint8_t len[256];
+} Huffman;
+
+// Canonical Huffman table giving the first symbols short codes and the
+// rest longer ones (2 of 2 bits, 4 of 4, 8 of 6, 16 of 8, the rest 12),
+// so several code lengths are in use
+static Huffman makeHuffman(const std::vector<uint8_t> &symbols) {
+  static const uint8_t group[][2] = {{2, 2}, {4, 4}, {8, 6}, {16, 8}};
+  Huffman h = {{0}, symbols, {0}, {0}};
+  size_t i = 0;
+  for (const uint8_t *g : group)
+    for (int n = 0; (n < g[0]) && (i < symbols.size()); n++)
+      h.len[symbols[i++]] = g[1];
+  for (; i < symbols.size(); i++)
+    h.len[symbols[i]] = 12;
+  uint16_t code = 0;
+  for (int len = 1; len <= 16; len++, code <<= 1) {
+    for (uint8_t s : symbols) {
+      if (h.len[s] == len) {
+        h.code[s] = code++;
+        h.count[len - 1]++;
+      }
+    }
+  }
+  return h;
+}
+
+// Entropy-coded data writer, with 0xFF bytes stuffed
+typedef struct {
+  std::vector<uint8_t> *out;
+  uint32_t acc; // Pending bits, first in MSB
+  int n;        // Number of pending bits
+} BitWriter;
+
+static void putBits(BitWriter &w, uint32_t bits, int len) {
+  for (int i = len - 1; i >= 0; i--) {
+    w.acc = (w.acc << 1) | ((bits >> i) & 1);
+    if (++w.n == 8) {
+      w.out->push_back(w.acc);
+      if ((w.acc & 0xFF) == 0xFF)
+        w.out->push_back(0);
+      w.acc = w.n = 0;
+    }
+  }
+}
+
+static void flushBits(BitWriter &w) { // Pad last byte with 1 bits
+  while (w.n)
+    putBits(w, 1, 1);
+}
+
+// Magnitude category and value bits of a coefficient (T.81 F.1.2.1)
+static void putValue(BitWriter &w, const Huffman &h, uint8_t run, int v) {
+  int size = 0;
+  for (int a = abs(v); a; a >>= 1)
+    size++;
+  uint8_t s = (run << 4) | size;
+  putBits(w, h.code[s], h.len[s]);
+  putBits(w, (v < 0) ? v + (1 << size) - 1 : v, size);
+}
+
+static void putWord(std::vector<uint8_t> &d, uint16_t v) {
+  d.push_back(v >> 8);
+  d.push_back(v);
+}
+
+static void putSegment(std::vector<uint8_t> &d, uint8_t marker,
+                       const std::vector<uint8_t> &body) {
+  d.push_back(0xFF);
+  d.push_back(marker);
+  putWord(d, body.size() + 2);
+  d.insert(d.end(), body.begin(), body.end());
+}
+
+// Baseline JPEG of the synthetic image (or the same with a progressive
+// frame marker, which is otherwise not a valid progressive file)
+static std::vector<uint8_t> encode(const JPEGCase &jc) {
+  uint8_t zigzag[64], quant[2][64];
+  int nComp = jc.gray ? 1 : 3, k = 0;
+  for (int s = 0; s < 15; s++) { // Zigzag position -> natural order
+    for (int i = 0; i < 8; i++) {
+      int row = (s & 1) ? i : 7 - i, col = s - row;
+      if ((col >= 0) && (col < 8))
+        zigzag[k++] = row * 8 + col;
+    }
+  }
+  for (k = 0; k < 64; k++) { // Fine, so tolerances can be tight
+    quant[0][k] = 1 + k / 21;
+    quant[1][k] = 2;
+  }
+  std::vector<uint8_t> dc, ac;
+  for (int s = 0; s < 12; s++)
+    dc.push_back(s);
+  ac.push_back(0x00); // EOB
+  ac.push_back(0xF0); // 16 zeros
+  for (int size = 1; size <= 10; size++)
+    for (int run = 0; run < 16; run++)
+      ac.push_back((run << 4) | size);
+  Huffman huff[4] = {makeHuffman(dc), makeHuffman(ac), {}, {}};
+  std::reverse(dc.begin(), dc.end()); // Chroma tables differ
+  std::reverse(ac.begin(), ac.end());
+  huff[2] = makeHuffman(dc);
+  huff[3] = makeHuffman(ac);
+
+  std::vector<uint8_t> d = {0xFF, 0xD8}, body;
+  const char jfif[] = "JFIF\0\1\1\0\0\1\0\1\0\0";
+  putSegment(d, 0xE0, std::vector<uint8_t>(jfif, jfif + 14));
+  putSegment(d, 0xFE, std::vector<uint8_t>(300, 'x')); // Skipped comment
+  for (int t = 0; t < 2; t++) {
+    body.push_back(t);
+    body.insert(body.end(), quant[t], quant[t] + 64);
+  }
+  putSegment(d, 0xDB, body);
+  body = {8};
+  putWord(body, jc.height);
+  putWord(body, jc.width);
+  body.push_back(nComp);
+  for (int c = 0; c < nComp; c++) {
+    uint8_t comp[] = {(uint8_t)(c + 1),
+                      (uint8_t)(c ? 0x11 : (jc.h << 4) | jc.v),
+                      (uint8_t)(c ? 1 : 0)};
+    body.insert(body.end(), comp, comp + 3);
+  }
+  putSegment(d, jc.sof, body);
+  body.clear();
+  for (int t = 0; t < 4; t++) {
+    body.push_back(((t & 1) << 4) | (t >> 1)); // Class, index
+    body.insert(body.end(), huff[t].count, huff[t].count + 16);
+    body.insert(body.end(), huff[t].symbols.begin(), huff[t].symbols.end());
+  }
+  putSegment(d, 0xC4, body);
+  if (jc.restart) {
+    body.clear();
+    putWord(body, jc.restart);
+    putSegment(d, 0xDD, body);
+  }
+  body = {(uint8_t)nComp};
+  for (int c = 0; c < nComp; c++) {
+    body.push_back(c + 1);
+    body.push_back(c ? 0x11 : 0x00);
+  }
+  body.insert(body.end(), {0, 63, 0});
+  putSegment(d, 0xDA, body);
+
+  BitWriter w = {&d, 0, 0};
+  int pred[3] = {0, 0, 0}, mcuW = jc.h * 8, mcuH = jc.v * 8, mcus = 0;
+  for (int my = 0; my * mcuH < jc.height; my++) {
+    for (int mx = 0; mx * mcuW < jc.width; mx++, mcus++) {
+      if (jc.restart && mcus && !(mcus % jc.restart)) {
+        flushBits(w);
+        d.push_back(0xFF);
+        d.push_back(0xD0 + (mcus / jc.restart - 1) % 8); // RST0-7
+        pred[0] = pred[1] = pred[2] = 0;
+      }
+      for (int c = 0; c < nComp; c++) {
+        int bh = c ? 1 : jc.h, bv = c ? 1 : jc.v; // Blocks in MCU
+        int sx = jc.h / bh, sy = jc.v / bv;       // Pixels per sample
+        const Huffman &hdc = huff[c ? 2 : 0], &hac = huff[c ? 3 : 1];
+        for (int by = 0; by < bv; by++) {
+          for (int bx = 0; bx < bh; bx++) {
+            double f[64], coef[64];
+            for (int i = 0; i < 64; i++) { // Samples, averaged if sub-
+              double sum = 0;              // sampled, edges repeated
+              for (int dy = 0; dy < sy; dy++) {
+                for (int dx = 0; dx < sx; dx++) {
+                  int32_t x = ((mx * bh + bx) * 8 + i % 8) * sx + dx;
+                  int32_t y = ((my * bv + by) * 8 + i / 8) * sy + dy;
+                  sum += source(std::min(x, jc.width - 1),
+                                std::min(y, jc.height - 1), c);
+                }
+              }
+              f[i] = sum / (sx * sy) - 128;
+            }
+            for (int u = 0; u < 64; u++) { // Forward DCT
+              double sum = 0;
+              for (int i = 0; i < 64; i++)
+                sum += f[i] * cos((2 * (i % 8) + 1) * (u % 8) * M_PI / 16) *
+                       cos((2 * (i / 8) + 1) * (u / 8) * M_PI / 16);
+              coef[u] = sum * ((u % 8) ? 0.5 : M_SQRT1_2 / 2) *
+                        ((u / 8) ? 0.5 : M_SQRT1_2 / 2);
+            }
+            const uint8_t *qt = quant[c ? 1 : 0];
+            int run = 0, v = lround(coef[0] / qt[0]);
+            putValue(w, hdc, 0, v - pred[c]);
+            pred[c] = v;
+            for (k = 1; k < 64; k++) {
+              v = lround(coef[zigzag[k]] / qt[k]);
+              if (!v) {
+                run++;
+                continue;
+              }
+              for (; run > 15; run -= 16)
+                putBits(w, hac.code[0xF0], hac.len[0xF0]);
+              putValue(w, hac, run, v);
+              run = 0;
+            }
+            if (run)
+              putBits(w, hac.code[0x00], hac.len[0x00]);
+          }
+        }
+      }
+    }
+  }
+  flushBits(w);
+  d.push_back(0xFF);
+  d.push_back(0xD9); // EOI
+  return d;
+}
+
+// Compare TFT against reference drawn at x,y: within 'tolerance' of each
+// R, G, B value (allowing for 565 truncation), background elsewhere
+static void checkNear(const Adafruit_SPITFT &tft, const Reference &ref,
+                      int16_t x, int16_t y, int tolerance,
+                      const std::string &what) {
+  static const int bits[] = {5, 6, 5}, shift[] = {11, 5, 0};
+  for (int32_t sy = 0; sy < tft.height(); sy++) {
+    for (int32_t sx = 0; sx < tft.width(); sx++) {
+      int32_t ix = sx - x, iy = sy - y;
+      uint16_t got = tft.framebuffer[sy * tft.width() + sx];
+      bool ok = true;
+      if ((ix >= 0) && (iy >= 0) && (ix < ref.width) && (iy < ref.height)) {
+        for (int c = 0; c < 3; c++) {
+          int step = 1 << (8 - bits[c]); // Got is low end of a 565 step
+          int v = ((got >> shift[c]) & ((1 << bits[c]) - 1)) * step;
+          int e = ref.rgb[(iy * ref.width + ix) * 3 + c];
+          ok = ok && (e >= v - tolerance) && (e < v + step + tolerance);
+        }
+      } else {
+        ok = (got == BACKGROUND);
+      }
+      if (!ok) {
+        char buf[80];
+        snprintf(buf, sizeof buf, ": pixel %d,%d is %04X, too far off",
+                 sx, sy, got);
+        check(false, what + buf);
+        return;
+      }
+    }
+  }
+  check(true, what);
+}
+
+// Draw and load one JPEG at every scale, whole and clipped
+static void testJPEG(const std::string &name, const JPEGCase &jc) {
+  Adafruit_ImageReader reader(filesys);
+  Reference full = reference(jc);
+  int32_t w = 0, h = 0;
+  ImageReturnCode stat = reader.jpegDimensions(name.c_str(), &w, &h);
+  checkHost(name + " dimensions");
+  check((stat == IMAGE_SUCCESS) && (w == jc.width) && (h == jc.height),
+        name + " dimensions: wrong");
+  for (uint8_t scale = 0; scale <= 3; scale++) {
+    Reference ref = reduce(full, scale);
+    int tolerance = jc.tolerance + scale * SCALE_TOLERANCE;
+    int16_t pos[][2] = {{0, 0},
+                        {(int16_t)(-ref.width / 3), (int16_t)(ref.height / 4)},
+                        {(int16_t)(ref.width / 2), (int16_t)(-ref.height / 3)}};
+    for (const int16_t *p : pos) {
+      int16_t x = p[0], y = p[1];
+      char at[40];
+      snprintf(at, sizeof at, " scale %d at %d,%d", scale, x, y);
+      Adafruit_SPITFT tft(ref.width, ref.height);
+      std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+      std::string what = name + " draw" + at;
+      stat = reader.drawJPEG(name.c_str(), tft, x, y, scale);
+      checkHost(what);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      if (stat == IMAGE_SUCCESS)
+        checkNear(tft, ref, x, y, tolerance, what);
+
+      Adafruit_Image img;
+      std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+      what = name + " load" + at;
+      stat = reader.loadJPEG(name.c_str(), img, scale);
+      checkHost(what);
+      check(stat == IMAGE_SUCCESS, what + ": failed");
+      if (stat == IMAGE_SUCCESS) {
+        img.draw(tft, x, y);
+        checkNear(tft, ref, x, y, tolerance, what);
+      }
+    }
+  }
+}
+
+// Progressive JPEGs aren't supported, and must be refused untouched
+static void testRejected(const std::string &name, const JPEGCase &jc) {
+  Adafruit_ImageReader reader(filesys);
+  Adafruit_SPITFT tft(jc.width, jc.height);
+  Adafruit_Image img;
+  std::fill(tft.framebuffer.begin(), tft.framebuffer.end(), BACKGROUND);
+  ImageReturnCode stat = reader.drawJPEG(name.c_str(), tft, 0, 0);
+  checkHost(name + " draw");
+  check(stat == IMAGE_ERR_FORMAT, name + " draw: not rejected");
+  check(std::count(tft.framebuffer.begin(), tft.framebuffer.end(),
+                   BACKGROUND) == (long)tft.framebuffer.size(),
+        name + " draw: pixels drawn");
+  stat = reader.loadJPEG(name.c_str(), img);
+  checkHost(name + " load");
+  check(stat == IMAGE_ERR_FORMAT, name + " load: not rejected");
+  check(!img.getCanvas(), name + " load: canvas left allocated");
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s folder\n", argv[0]);
+    return 2;
+  }
+  std::string root = argv[1];
+  filesys.begin(argv[1]);
+
+  for (const JPEGCase &jc : cases) {
+    // Name starts with '.', so decode_test skips any left behind
+    std::string name = std::string(".jpeg-") + jc.name + ".jpg";
+    int failed = failures;
+    if (!writeFile(root + "/" + name, encode(jc))) {
+      check(false, "can't write " + name);
+      continue;
+    }
+    if (jc.sof == 0xC0)
+      testJPEG(name, jc);
+    else
+      testRejected(name, jc);
+    remove((root + "/" + name).c_str());
+    printf("%s  %s\n", (failures > failed) ? "FAIL" : "ok  ", name.c_str());
+  }
+
+  printf("%d JPEGs, %d checks, %d failed\n",
+         (int)(sizeof cases / sizeof cases[0]), checks, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+/*!
+ * @file Adafruit_EPD.h
+ *
+ * Host (desktop) stand-in for Adafruit_EPD. Like the real class it only
+ * overrides drawPixel(), so everything drawn to it arrives one pixel at a
+ * time; pixels land in a framebuffer of EPD color values that tests can
+ * inspect. Not part of the Arduino build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_ADAFRUIT_EPD_H__
+#define __HOST_ADAFRUIT_EPD_H__
+
+#include "Adafruit_GFX.h"
+#include <vector>
+
+/** EPD colors */
+enum {
+  EPD_WHITE,
+  EPD_BLACK,
+  EPD_RED,
+  EPD_GRAY,
+  EPD_DARK,
+  EPD_LIGHT,
+  EPD_YELLOW,
+  EPD_NUM_COLORS
+};
+
+/** Display modes */
+typedef enum {
+  THINKINK_MONO,
+  THINKINK_TRICOLOR,
+  THINKINK_GRAYSCALE4,
+  THINKINK_QUADCOLOR,
+  THINKINK_MONO_PARTIAL
+} thinkinkmode_t;
+
+/*!
+   @brief  E-paper display with a framebuffer in host memory.
+*/
+class Adafruit_EPD : public Adafruit_GFX {
+public:
+  Adafruit_EPD(int width, int height, thinkinkmode_t mode = THINKINK_MONO);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  /*!
+      @brief   Get display mode.
+      @return  Mode passed to constructor.
+  */
+  thinkinkmode_t getMode(void) { return inkmode; }
+
+  std::vector<uint8_t> framebuffer; ///< Row-major EPD colors
+  uint32_t pixelWrites;             ///< drawPixel() calls
+
+protected:
+  thinkinkmode_t inkmode; ///< Display mode
+};
+
+#endif // __HOST_ADAFRUIT_EPD_H__
@@ -0,0 +1,129 @@
+/*!
+ * @file Adafruit_GFX.h
+ *
+ * Host (desktop) stand-in for the parts of Adafruit_GFX used by
+ * Adafruit_ImageReader. Drawing functions go through writePixel() one
+ * pixel at a time, as the library's defaults do for any display that only
+ * overrides drawPixel(). Rotation is not supported. Not part of the
+ * Arduino build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_ADAFRUIT_GFX_H__
+#define __HOST_ADAFRUIT_GFX_H__
+
+#include "Arduino.h"
+
+/*!
+   @brief  Base class for displays and canvases.
+*/
+class Adafruit_GFX {
+public:
+  Adafruit_GFX(int16_t w, int16_t h);
+  virtual ~Adafruit_GFX(void) {}
+  /*!
+      @brief  Draw one pixel, clipped to the display.
+      @param  x      Column.
+      @param  y      Row.
+      @param  color  Color.
+  */
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  virtual void startWrite(void);
+  virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+  virtual void writeFastHLine(int16_t x, int16_t y, int16_t w,
+                              uint16_t color);
+  virtual void endWrite(void);
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color);
+  virtual void fillScreen(uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+                  int16_t h, uint16_t color, uint16_t bg);
+  void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h,
+                  uint16_t color, uint16_t bg);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w,
+                     int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w,
+                     int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+                     const uint8_t mask[], int16_t w, int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, uint8_t *mask,
+                     int16_t w, int16_t h);
+  /*!
+      @brief   Get display width.
+      @return  Width in pixels.
+  */
+  int16_t width(void) const { return _width; }
+  /*!
+      @brief   Get display height.
+      @return  Height in pixels.
+  */
+  int16_t height(void) const { return _height; }
+  /*!
+      @brief   Get rotation setting.
+      @return  Always 0 on the host.
+  */
+  uint8_t getRotation(void) const { return 0; }
+
+protected:
+  int16_t WIDTH;   ///< Raw display width, never changes
+  int16_t HEIGHT;  ///< Raw display height, never changes
+  int16_t _width;  ///< Display width as modified by current rotation
+  int16_t _height; ///< Display height as modified by current rotation
+};
+
+/*!
+   @brief  1-bit canvas, rows padded to whole bytes, MSB first.
+*/
+class GFXcanvas1 : public Adafruit_GFX {
+public:
+  GFXcanvas1(uint16_t w, uint16_t h);
+  ~GFXcanvas1(void);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  /*!
+      @brief   Get canvas memory.
+      @return  Pointer to buffer, or NULL if allocation failed.
+  */
+  uint8_t *getBuffer(void) const { return buffer; }
+
+private:
+  uint8_t *buffer; ///< Canvas memory
+};
+
+/*!
+   @brief  8-bit canvas.
+*/
+class GFXcanvas8 : public Adafruit_GFX {
+public:
+  GFXcanvas8(uint16_t w, uint16_t h);
+  ~GFXcanvas8(void);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  /*!
+      @brief   Get canvas memory.
+      @return  Pointer to buffer, or NULL if allocation failed.
+  */
+  uint8_t *getBuffer(void) const { return buffer; }
+
+private:
+  uint8_t *buffer; ///< Canvas memory
+};
+
+/*!
+   @brief  16-bit canvas.
+*/
+class GFXcanvas16 : public Adafruit_GFX {
+public:
+  GFXcanvas16(uint16_t w, uint16_t h);
+  ~GFXcanvas16(void);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  /*!
+      @brief   Get canvas memory.
+      @return  Pointer to buffer, or NULL if allocation failed.
+  */
+  uint16_t *getBuffer(void) const { return buffer; }
+
+private:
+  uint16_t *buffer; ///< Canvas memory
+};
+
+#endif // __HOST_ADAFRUIT_GFX_H__
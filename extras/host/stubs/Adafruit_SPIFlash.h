@@ -0,0 +1,58 @@
+/*!
+ * @file Adafruit_SPIFlash.h
+ *
+ * Host (desktop) stand-in for the SdFat FatVolume and File32 classes used
+ * by Adafruit_ImageReader, backed by POSIX files. Not part of the Arduino
+ * build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_ADAFRUIT_SPIFLASH_H__
+#define __HOST_ADAFRUIT_SPIFLASH_H__
+
+#include "Arduino.h"
+#include <string>
+
+#define FILE_READ 0 ///< Open for reading (O_RDONLY in SdFat)
+
+/*!
+   @brief  An open file, as returned by FatVolume::open(). Copies refer to
+           the same open file, as with SdFat.
+*/
+class File32 {
+public:
+  File32(void) : fp(NULL) {}
+  /*!
+      @brief   Test whether file is open.
+      @return  true if open.
+  */
+  operator bool(void) const { return fp != NULL; }
+  int read(void);
+  int read(void *buf, size_t count);
+  bool seek(uint32_t pos);
+  uint32_t position(void);
+  uint32_t size(void);
+  int available(void);
+  bool close(void);
+
+private:
+  FILE *fp; ///< stdio file, or NULL if not open
+  friend class FatVolume;
+};
+
+/*!
+   @brief  Filesystem volume: a folder on the host standing in for the
+           root of an SD card or flash filesystem.
+*/
+class FatVolume {
+public:
+  bool begin(const char *path);
+  File32 open(const char *path, int oflag = FILE_READ);
+  bool exists(const char *path);
+
+private:
+  std::string root; ///< Host folder that "/" refers to
+  std::string hostPath(const char *path);
+};
+
+#endif // __HOST_ADAFRUIT_SPIFLASH_H__
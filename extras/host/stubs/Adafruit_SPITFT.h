@@ -0,0 +1,61 @@
+/*!
+ * @file Adafruit_SPITFT.h
+ *
+ * Host (desktop) stand-in for Adafruit_SPITFT. Pixels sent through
+ * setAddrWindow() and writePixels() / writeColor() land in a framebuffer
+ * that tests can inspect. Non-blocking writePixels() is treated as a DMA
+ * transfer that completes at the next dmaWait(), and misuse the hardware
+ * wouldn't survive (pixels outside a transaction or window, writes or a
+ * new window while DMA is in flight, the DMA buffer changing before it's
+ * sent, commands inside a transaction) aborts the program. The panel can
+ * sit at an offset in a taller controller RAM, as on ST77xx displays, so
+ * flipping MADCTL's row order mirrors across the RAM. Not part of the
+ * Arduino build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_ADAFRUIT_SPITFT_H__
+#define __HOST_ADAFRUIT_SPITFT_H__
+
+#include "Adafruit_GFX.h"
+#include <vector>
+
+/*!
+   @brief  SPI TFT display with a framebuffer in host memory.
+*/
+class Adafruit_SPITFT : public Adafruit_GFX {
+public:
+  Adafruit_SPITFT(uint16_t w, uint16_t h);
+  void startWrite(void);
+  void endWrite(void);
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void writePixels(uint16_t *colors, uint32_t len, bool block = true,
+                   bool bigEndian = false);
+  void writeColor(uint16_t color, uint32_t len);
+  void dmaWait(void);
+  void sendCommand(uint8_t commandByte, const uint8_t *dataBytes = NULL,
+                   uint8_t numDataBytes = 0);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b);
+
+  std::vector<uint16_t> framebuffer; ///< Row-major 565 pixels
+  uint8_t madctl;                    ///< MADCTL register, 0x48 at start
+  uint16_t ramHeight;                ///< Controller RAM rows, height at start
+  uint16_t rowStart;                 ///< RAM row of panel's top row, 0 at start
+  uint32_t windows;                  ///< setAddrWindow() calls
+  uint32_t pixelWrites;              ///< writePixels() calls
+  uint32_t colorWrites;              ///< writeColor() calls
+  uint32_t pixelsPushed;             ///< Pixels sent by either
+
+private:
+  void push(uint16_t color);
+  bool inTransaction;        ///< Between startWrite() and endWrite()
+  uint16_t winX, winY;       ///< Address window position
+  uint16_t winW, winH;       ///< Address window size
+  uint32_t winPos;           ///< Next pixel in address window
+  uint16_t *dmaColors;       ///< Non-blocking writePixels() source
+  std::vector<uint16_t> dma; ///< Copy of it, to check it's left alone
+  bool dmaBigEndian;         ///< Byte order of the DMA transfer
+};
+
+#endif // __HOST_ADAFRUIT_SPITFT_H__
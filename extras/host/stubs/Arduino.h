@@ -0,0 +1,62 @@
+/*!
+ * @file Arduino.h
+ *
+ * Host (desktop) stand-in for the parts of the Arduino core used by
+ * Adafruit_ImageReader, so the library can be built and tested without a
+ * board. See extras/host/CMakeLists.txt. Not part of the Arduino build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean; ///< Arduino's name for bool
+typedef uint8_t byte; ///< Arduino's name for uint8_t
+
+// Type-checked templates, as on the 32-bit cores (AVR uses macros)
+using std::max;
+using std::min;
+
+#define F(s) (s) ///< No separate flash address space on the host
+#define PROGMEM  ///< "
+
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(unsigned long ms);
+void yield(void);
+
+/*!
+   @brief  Minimal Print/Stream, writes to stdout.
+*/
+class Stream {
+public:
+  size_t print(const char *s);
+  size_t print(long n);
+  size_t println(const char *s);
+  size_t println(long n);
+};
+
+extern Stream Serial; ///< Standard output
+
+/*!
+   @brief  Host-only bookkeeping shared by the stand-ins, so tests can
+           check that the library closes its files and never touches the
+           SD card while it holds the display's SPI transaction open (on
+           hardware the two often share one SPI bus).
+*/
+typedef struct {
+  int openFiles;         ///< Files opened through FatVolume, not closed
+  int transactions;      ///< Display SPI transactions currently open
+  uint32_t busConflicts; ///< File reads & seeks during a transaction
+} HostState;
+
+extern HostState hostState; ///< Shared by all stand-in objects
+
+#endif // __HOST_ARDUINO_H__
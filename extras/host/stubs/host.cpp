@@ -0,0 +1,379 @@
+/*!
+ * @file host.cpp
+ *
+ * Host (desktop) implementations of the Arduino core, SdFat, Adafruit_GFX,
+ * Adafruit_SPITFT and Adafruit_EPD stand-ins. Not part of the Arduino
+ * build.
+ *
+ * BSD license, all text here must be included in any redistribution.
+ */
+
+#include "Adafruit_EPD.h"
+#include "Adafruit_SPIFlash.h"
+#include "Adafruit_SPITFT.h"
+#include <chrono>
+#include <sys/stat.h>
+
+Stream Serial;
+HostState hostState;
+
+// ARDUINO CORE ***************************************************************
+
+static std::chrono::steady_clock::time_point startTime =
+    std::chrono::steady_clock::now();
+
+unsigned long micros(void) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - startTime)
+      .count();
+}
+
+unsigned long millis(void) { return micros() / 1000; }
+
+void delay(unsigned long ms) { (void)ms; } // Host runs flat out
+
+void yield(void) {}
+
+size_t Stream::print(const char *s) { return printf("%s", s); }
+
+size_t Stream::print(long n) { return printf("%ld", n); }
+
+size_t Stream::println(const char *s) { return printf("%s\n", s); }
+
+size_t Stream::println(long n) { return printf("%ld\n", n); }
+
+// SDFAT **********************************************************************
+
+// The SD card is on the same SPI bus as the display, and must not be
+// accessed while the display's chip select is asserted.
+static void busCheck(void) {
+  if (hostState.transactions)
+    hostState.busConflicts++;
+}
+
+int File32::read(void) {
+  busCheck();
+  return fgetc(fp);
+}
+
+int File32::read(void *buf, size_t count) {
+  busCheck();
+  return (int)fread(buf, 1, count, fp);
+}
+
+bool File32::seek(uint32_t pos) {
+  busCheck();
+  return !fseek(fp, pos, SEEK_SET);
+}
+
+uint32_t File32::position(void) { return (uint32_t)ftell(fp); }
+
+uint32_t File32::size(void) {
+  struct stat st;
+  return fstat(fileno(fp), &st) ? 0 : (uint32_t)st.st_size;
+}
+
+int File32::available(void) { return (int)(size() - position()); }
+
+bool File32::close(void) {
+  if (!fp)
+    return false;
+  fclose(fp);
+  fp = NULL;
+  hostState.openFiles--;
+  return true;
+}
+
+bool FatVolume::begin(const char *path) {
+  root = path;
+  return true;
+}
+
+std::string FatVolume::hostPath(const char *path) {
+  while (*path == '/')
+    path++;
+  return root + "/" + path;
+}
+
+File32 FatVolume::open(const char *path, int oflag) {
+  File32 file;
+  (void)oflag; // Read-only
+  if ((file.fp = fopen(hostPath(path).c_str(), "rb")))
+    hostState.openFiles++;
+  return file;
+}
+
+bool FatVolume::exists(const char *path) {
+  struct stat st;
+  return !stat(hostPath(path).c_str(), &st);
+}
+
+// ADAFRUIT_GFX ***************************************************************
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+    : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+void Adafruit_GFX::startWrite(void) {}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+  drawPixel(x, y, color);
+}
+
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                  uint16_t color) {
+  drawFastHLine(x, y, w, color);
+}
+
+void Adafruit_GFX::endWrite(void) {}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+  startWrite();
+  for (int16_t i = 0; i < w; i++)
+    writePixel(x + i, y, color);
+  endWrite();
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  startWrite();
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++)
+      writePixel(x + i, y + j, color);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                              int16_t w, int16_t h, uint16_t color,
+                              uint16_t bg) {
+  int16_t byteWidth = (w + 7) / 8;
+  startWrite();
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      uint8_t b = bitmap[j * byteWidth + i / 8] << (i & 7);
+      writePixel(x + i, y + j, (b & 0x80) ? color : bg);
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap,
+                              int16_t w, int16_t h, uint16_t color,
+                              uint16_t bg) {
+  drawBitmap(x, y, (const uint8_t *)bitmap, w, h, color, bg);
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+                                 int16_t w, int16_t h) {
+  startWrite();
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++)
+      writePixel(x + i, y + j, bitmap[j * w + i]);
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap,
+                                 int16_t w, int16_t h) {
+  drawRGBBitmap(x, y, (const uint16_t *)bitmap, w, h);
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+                                 const uint8_t mask[], int16_t w, int16_t h) {
+  int16_t byteWidth = (w + 7) / 8;
+  startWrite();
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      if ((mask[j * byteWidth + i / 8] << (i & 7)) & 0x80)
+        writePixel(x + i, y + j, bitmap[j * w + i]);
+    }
+  }
+  endWrite();
+}
+
+void Adafruit_GFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap,
+                                 uint8_t *mask, int16_t w, int16_t h) {
+  drawRGBBitmap(x, y, (const uint16_t *)bitmap, (const uint8_t *)mask, w, h);
+}
+
+// Canvases: same sizes and layout as Adafruit_GFX's, including the
+// uint16_t dimensions.
+
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = (uint8_t *)calloc(((w + 7) / 8) * (uint32_t)h, 1);
+}
+
+GFXcanvas1::~GFXcanvas1(void) { free(buffer); }
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (buffer && (x >= 0) && (y >= 0) && (x < _width) && (y < _height)) {
+    uint8_t *ptr = &buffer[(x / 8) + y * ((WIDTH + 7) / 8)];
+    if (color)
+      *ptr |= 0x80 >> (x & 7);
+    else
+      *ptr &= ~(0x80 >> (x & 7));
+  }
+}
+
+GFXcanvas8::GFXcanvas8(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = (uint8_t *)calloc(w * (uint32_t)h, 1);
+}
+
+GFXcanvas8::~GFXcanvas8(void) { free(buffer); }
+
+void GFXcanvas8::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (buffer && (x >= 0) && (y >= 0) && (x < _width) && (y < _height))
+    buffer[x + y * WIDTH] = color;
+}
+
+GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
+  buffer = (uint16_t *)calloc(w * (uint32_t)h, 2);
+}
+
+GFXcanvas16::~GFXcanvas16(void) { free(buffer); }
+
+void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (buffer && (x >= 0) && (y >= 0) && (x < _width) && (y < _height))
+    buffer[x + y * WIDTH] = color;
+}
+
+// ADAFRUIT_SPITFT ************************************************************
+
+static void fail(const char *what) {
+  fprintf(stderr, "Adafruit_SPITFT: %s\n", what);
+  abort();
+}
+
+Adafruit_SPITFT::Adafruit_SPITFT(uint16_t w, uint16_t h)
+    : Adafruit_GFX(w, h), framebuffer(w * h), madctl(0x48), ramHeight(h),
+      rowStart(0), windows(0),
+      pixelWrites(0), colorWrites(0), pixelsPushed(0), inTransaction(false),
+      winX(0), winY(0), winW(0), winH(0), winPos(0), dmaColors(NULL),
+      dmaBigEndian(false) {}
+
+void Adafruit_SPITFT::startWrite(void) {
+  if (inTransaction)
+    fail("startWrite() with transaction already open");
+  inTransaction = true;
+  hostState.transactions++;
+}
+
+void Adafruit_SPITFT::endWrite(void) {
+  if (!inTransaction)
+    fail("endWrite() with no transaction open");
+  if (dmaColors)
+    fail("endWrite() with DMA in flight");
+  inTransaction = false;
+  hostState.transactions--;
+}
+
+void Adafruit_SPITFT::setAddrWindow(uint16_t x, uint16_t y, uint16_t w,
+                                    uint16_t h) {
+  if (!inTransaction)
+    fail("setAddrWindow() outside transaction");
+  if (dmaColors)
+    fail("setAddrWindow() with DMA in flight");
+  // Rows are offset into controller RAM in 16 bits, as display libraries
+  // do, so a window mirrored above the panel can wrap around to it
+  y += rowStart;
+  if (!w || !h || (x + w > _width) || (y + h > ramHeight))
+    fail("setAddrWindow() off screen");
+  winX = x;
+  winY = y;
+  winW = w;
+  winH = h;
+  winPos = 0;
+  windows++;
+}
+
+// Pixels fill the address window left to right, then top to bottom, or
+// bottom to top (mirrored across RAM) if MADCTL's row order bit has been
+// flipped.
+void Adafruit_SPITFT::push(uint16_t color) {
+  if (winPos >= (uint32_t)winW * winH)
+    fail("pixels past end of address window");
+  int32_t x = winX + winPos % winW, y = winY + winPos / winW;
+  if ((madctl ^ 0x48) & 0x80)
+    y = ramHeight - 1 - y;
+  y -= rowStart;
+  if ((y < 0) || (y >= _height))
+    fail("pixels outside panel");
+  framebuffer[y * _width + x] = color;
+  winPos++;
+}
+
+void Adafruit_SPITFT::writePixels(uint16_t *colors, uint32_t len, bool block,
+                                  bool bigEndian) {
+  if (!inTransaction)
+    fail("writePixels() outside transaction");
+  if (dmaColors)
+    fail("writePixels() with DMA in flight");
+  pixelWrites++;
+  pixelsPushed += len;
+  if (!block) { // "DMA" happens at dmaWait()
+    dmaColors = colors;
+    dma.assign(colors, colors + len);
+    dmaBigEndian = bigEndian;
+    return;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    uint16_t c = colors[i];
+    push(bigEndian ? (uint16_t)((c >> 8) | (c << 8)) : c);
+  }
+}
+
+void Adafruit_SPITFT::writeColor(uint16_t color, uint32_t len) {
+  if (!inTransaction)
+    fail("writeColor() outside transaction");
+  if (dmaColors)
+    fail("writeColor() with DMA in flight");
+  colorWrites++;
+  pixelsPushed += len;
+  while (len--)
+    push(color);
+}
+
+void Adafruit_SPITFT::dmaWait(void) {
+  if (!dmaColors)
+    return;
+  if (memcmp(dmaColors, dma.data(), dma.size() * 2))
+    fail("DMA buffer changed before transfer finished");
+  dmaColors = NULL;
+  for (uint16_t c : dma)
+    push(dmaBigEndian ? (uint16_t)((c >> 8) | (c << 8)) : c);
+}
+
+void Adafruit_SPITFT::sendCommand(uint8_t commandByte,
+                                  const uint8_t *dataBytes,
+                                  uint8_t numDataBytes) {
+  if (inTransaction)
+    fail("sendCommand() inside transaction");
+  if ((commandByte == 0x36) && numDataBytes)
+    madctl = dataBytes[0];
+}
+
+void Adafruit_SPITFT::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if ((x >= 0) && (y >= 0) && (x < _width) && (y < _height))
+    framebuffer[y * _width + x] = color;
+}
+
+uint16_t Adafruit_SPITFT::color565(uint8_t r, uint8_t g, uint8_t b) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// ADAFRUIT_EPD ***************************************************************
+
+Adafruit_EPD::Adafruit_EPD(int width, int height, thinkinkmode_t mode)
+    : Adafruit_GFX(width, height), framebuffer(width * height, EPD_WHITE),
+      pixelWrites(0), inkmode(mode) {}
+
+void Adafruit_EPD::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  pixelWrites++;
+  if ((x >= 0) && (y >= 0) && (x < _width) && (y < _height))
+    framebuffer[y * _width + x] = color;
+}